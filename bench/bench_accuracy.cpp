@@ -0,0 +1,438 @@
+/**
+ * Compares the accuracy and cost of every fusion engine on the same datasets.
+ *
+ * Each engine starts at the identity orientation and is run over every
+ * dataset. The report is CSV with one row per engine and dataset:
+ *
+ * * rms_rad and max_rad: attitude error after the warm-up period
+ * * tilt_rms_rad: error of the direction of gravity alone, which does not
+ *   include yaw drift
+ * * converge_s: time until the tilt error first drops below 0.05 rad, or -1
+ *   if it never does
+ * * ns_update: time per update
+ * * state_bytes: size of the engine
+ *
+ * The same source is built as bench_accuracy, with double precision, and
+ * bench_accuracy_embed, with IMUNANO33_EMBED and float precision.
+ *
+ * Usage: bench_accuracy [--data NAME=FILE]... [--baseline FILE]
+ *                       [--tolerance F] [--speed-tolerance F]
+ *
+ * --data adds a recorded dataset from a CSV file whose rows are
+ * dt,gx,gy,gz,ax,ay,az,qw,qx,qy,qz, with the gyro in rad/s, the accelerometer
+ * in m/s^2 with the same conventions as imunano33::Filter, and a reference
+ * orientation. Lines starting with # are skipped.
+ *
+ * --baseline compares against a previous report. Rows of the same engine,
+ * precision, and dataset whose errors got worse by more than the relative
+ * tolerance (0.1 by default) are reported, and the exit code is 1. Speed is
+ * only compared if a speed tolerance is given, since it depends on the
+ * machine.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <imunano33/filter.hpp>
+#include <imunano33/imunano33.hpp>
+#include <imunano33/simulate.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+#ifdef IMUNANO33_EMBED
+const char *const PRECISION = "float";
+#else
+const char *const PRECISION = "double";
+#endif
+
+const double WARMUP = 5;       // s
+const double CONVERGED = 0.05; // rad
+const double ABS_SLACK = 1e-4; // rad, so tiny errors do not fail on rounding
+
+struct Row {
+  num_t deltaT;
+  Vector3D gyro;
+  Vector3D accel;
+  Quaternion truth;
+};
+
+struct Dataset {
+  std::string name;
+  std::vector<Row> rows;
+};
+
+struct Result {
+  std::string engine;
+  std::string precision;
+  std::string dataset;
+  double rms;
+  double max;
+  double tiltRms;
+  double converge;
+  double ns;
+  double bytes;
+};
+
+double attitudeError(const Quaternion &a, const Quaternion &b) {
+  const double d = std::fabs(a.w() * b.w() + dot(a.vec(), b.vec()));
+  return 2 * std::acos(d < 1 ? d : 1);
+}
+
+double tiltError(const Quaternion &a, const Quaternion &b) {
+  const Vector3D up{0, 0, 1};
+  const double d = dot(a.conj().rotate(up), b.conj().rotate(up));
+  return std::acos(d < -1 ? -1 : d > 1 ? 1 : d);
+}
+
+Dataset simulate(const std::string &name, const ImuSimulator::Motion &motion,
+                 const ImuSimulator::SensorModel &sensor,
+                 const uint64_t seed) {
+  const num_t rate = 200;
+  const unsigned long count = 60 * 200;
+
+  Dataset data{name, {}};
+  data.rows.reserve(count);
+  ImuSimulator sim{motion, sensor, rate, seed};
+  for (unsigned long i = 0; i < count; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    data.rows.push_back(
+        Row{sample.deltaT, sample.gyro, sample.accel, sample.orientation});
+  }
+  return data;
+}
+
+std::vector<Dataset> syntheticDatasets() {
+  // roughly the LSM9DS1 on the Arduino Nano 33 BLE
+  ImuSimulator::SensorModel sensor;
+  sensor.gyroBias = Vector3D{0.01, -0.005, 0.002};
+  sensor.gyroNoise = 0.005;
+  sensor.accelNoise = 0.02;
+
+  std::vector<Dataset> datasets;
+
+  ImuSimulator::Motion still;
+  still.initialAngles = Vector3D{0.5, -0.3, 0};
+  datasets.push_back(simulate("still", still, sensor, 1));
+
+  ImuSimulator::Motion handheld;
+  handheld.initialAngles = Vector3D{0.2, 0.2, 0};
+  handheld.angleRate = Vector3D{0, 0, 0.5};
+  handheld.shakeAmplitude = Vector3D{0.2, 0.2, 0.1};
+  handheld.shakeFreq = 1;
+  handheld.accelAmplitude = Vector3D{1, 1, 0.5};
+  handheld.accelFreq = 1;
+  datasets.push_back(simulate("handheld", handheld, sensor, 2));
+
+  ImuSimulator::Motion tumble;
+  tumble.angleRate = Vector3D{2, 0.5, -1.5};
+  tumble.shakeAmplitude = Vector3D{0.5, 0.3, 0.5};
+  tumble.shakeFreq = 2;
+  datasets.push_back(simulate("tumble", tumble, sensor, 3));
+
+  ImuSimulator::Motion vibration;
+  vibration.initialAngles = Vector3D{-0.3, 0.4, 0};
+  vibration.shakeAmplitude = Vector3D{0.01, 0.01, 0.01};
+  vibration.shakeFreq = 20;
+  vibration.accelAmplitude = Vector3D{3, 3, 3};
+  vibration.accelFreq = 5;
+  datasets.push_back(simulate("vibration", vibration, sensor, 4));
+
+  ImuSimulator::SensorModel lossy = sensor;
+  lossy.dropout = 0.05;
+  datasets.push_back(simulate("dropout", handheld, lossy, 5));
+
+  return datasets;
+}
+
+bool loadDataset(const std::string &name, const std::string &path,
+                 Dataset &data) {
+  std::ifstream file{path};
+  if (!file) {
+    std::fprintf(stderr, "cannot open %s\n", path.c_str());
+    return false;
+  }
+
+  data.name = name;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    double values[11];
+    const char *cur = line.c_str();
+    for (double &value : values) {
+      char *end = nullptr;
+      value = std::strtod(cur, &end);
+      if (end == cur) {
+        std::fprintf(stderr, "bad row in %s: %s\n", path.c_str(),
+                     line.c_str());
+        return false;
+      }
+      cur = *end == ',' ? end + 1 : end;
+    }
+
+    const Vector3D gyro{static_cast<num_t>(values[1]),
+                        static_cast<num_t>(values[2]),
+                        static_cast<num_t>(values[3])};
+    const Vector3D accel{static_cast<num_t>(values[4]),
+                         static_cast<num_t>(values[5]),
+                         static_cast<num_t>(values[6])};
+    const Quaternion truth{static_cast<num_t>(values[7]),
+                           Vector3D{static_cast<num_t>(values[8]),
+                                    static_cast<num_t>(values[9]),
+                                    static_cast<num_t>(values[10])}};
+    data.rows.push_back(
+        Row{static_cast<num_t>(values[0]), gyro, accel, truth.unit()});
+  }
+
+  return true;
+}
+
+// engines only need update() and orientation(), so adding an engine is adding
+// an adapter and a line in main()
+
+template <GyroIntegrator I> struct FilterEngine {
+  Filter filter;
+
+  FilterEngine() { filter.setIntegrator(I); }
+
+  void update(const Row &row) {
+    filter.update(row.accel, row.gyro, row.deltaT);
+  }
+
+  Quaternion orientation() const { return filter.getRotQ(); }
+};
+
+struct AutoCalibrateEngine {
+  Filter filter;
+
+  AutoCalibrateEngine() { filter.setAutoCalibrate(true); }
+
+  void update(const Row &row) {
+    filter.update(row.accel, row.gyro, row.deltaT);
+  }
+
+  Quaternion orientation() const { return filter.getRotQ(); }
+};
+
+struct ProcessorEngine {
+  IMUNano33 proc;
+
+  void update(const Row &row) {
+    proc.updateIMU(row.accel, row.gyro, row.deltaT);
+  }
+
+  Quaternion orientation() const { return proc.getRotQ(); }
+};
+
+template <typename Engine>
+Result evaluate(const char *name, const Dataset &data) {
+  Result res{name, PRECISION, data.name, 0, 0, 0, -1, 0,
+             static_cast<double>(sizeof(Engine))};
+
+  Engine engine;
+  double time = 0;
+  double sumSq = 0;
+  double tiltSumSq = 0;
+  unsigned long counted = 0;
+  for (const Row &row : data.rows) {
+    engine.update(row);
+    time += row.deltaT;
+
+    const double tilt = tiltError(engine.orientation(), row.truth);
+    if (res.converge < 0 && tilt < CONVERGED) {
+      res.converge = time;
+    }
+
+    if (time < WARMUP) {
+      continue;
+    }
+
+    const double err = attitudeError(engine.orientation(), row.truth);
+    res.max = err > res.max ? err : res.max;
+    sumSq += err * err;
+    tiltSumSq += tilt * tilt;
+    ++counted;
+  }
+
+  if (counted > 0) {
+    res.rms = std::sqrt(sumSq / counted);
+    res.tiltRms = std::sqrt(tiltSumSq / counted);
+  }
+
+  // time the updates alone on the same readings
+  Engine timed;
+  std::size_t idx = 0;
+  res.ns = nsPerCall(
+      [&]() {
+        timed.update(data.rows[idx]);
+        idx = idx + 1 == data.rows.size() ? 0 : idx + 1;
+        doNotOptimize(timed);
+      },
+      200000);
+
+  return res;
+}
+
+void printHeader() {
+  std::printf("engine,precision,dataset,rms_rad,max_rad,tilt_rms_rad,"
+              "converge_s,ns_update,state_bytes\n");
+}
+
+void printResult(const Result &res) {
+  std::printf("%s,%s,%s,%.6f,%.6f,%.6f,%.3f,%.1f,%.0f\n", res.engine.c_str(),
+              res.precision.c_str(), res.dataset.c_str(), res.rms, res.max,
+              res.tiltRms, res.converge, res.ns, res.bytes);
+}
+
+bool loadReport(const std::string &path, std::vector<Result> &results) {
+  std::ifstream file{path};
+  if (!file) {
+    std::fprintf(stderr, "cannot open %s\n", path.c_str());
+    return false;
+  }
+
+  std::string line;
+  std::getline(file, line); // header
+  while (std::getline(file, line)) {
+    std::istringstream fields{line};
+    Result res;
+    std::string field;
+    std::getline(fields, res.engine, ',');
+    std::getline(fields, res.precision, ',');
+    std::getline(fields, res.dataset, ',');
+    double *const numbers[] = {&res.rms,      &res.max, &res.tiltRms,
+                               &res.converge, &res.ns,  &res.bytes};
+    for (double *number : numbers) {
+      std::getline(fields, field, ',');
+      *number = std::atof(field.c_str());
+    }
+    if (!res.engine.empty()) {
+      results.push_back(res);
+    }
+  }
+
+  return true;
+}
+
+bool worse(const double value, const double baseline, const double tolerance) {
+  return value > baseline * (1 + tolerance) + ABS_SLACK;
+}
+
+// returns the number of regressions
+int compare(const std::vector<Result> &results,
+            const std::vector<Result> &baseline, const double tolerance,
+            const double speedTolerance) {
+  std::map<std::string, const Result *> byKey;
+  for (const Result &res : baseline) {
+    byKey[res.engine + "," + res.precision + "," + res.dataset] = &res;
+  }
+
+  int regressions = 0;
+  for (const Result &res : results) {
+    const auto found =
+        byKey.find(res.engine + "," + res.precision + "," + res.dataset);
+    if (found == byKey.end()) {
+      continue;
+    }
+
+    const Result &base = *found->second;
+    const bool slower = base.converge >= 0 &&
+                        (res.converge < 0 ||
+                         worse(res.converge, base.converge, tolerance));
+    const struct {
+      const char *metric;
+      bool regressed;
+      double value;
+      double baseline;
+    } checks[] = {
+        {"rms_rad", worse(res.rms, base.rms, tolerance), res.rms, base.rms},
+        {"max_rad", worse(res.max, base.max, tolerance), res.max, base.max},
+        {"converge_s", slower, res.converge, base.converge},
+        {"ns_update",
+         speedTolerance > 0 && worse(res.ns, base.ns, speedTolerance), res.ns,
+         base.ns},
+    };
+
+    for (const auto &check : checks) {
+      if (check.regressed) {
+        std::fprintf(stderr, "regression: %s %s %s %s %.6f (baseline %.6f)\n",
+                     res.engine.c_str(), res.precision.c_str(),
+                     res.dataset.c_str(), check.metric, check.value,
+                     check.baseline);
+        ++regressions;
+      }
+    }
+  }
+
+  return regressions;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::vector<Dataset> datasets = syntheticDatasets();
+  std::string baselinePath;
+  double tolerance = 0.1;
+  double speedTolerance = 0;
+
+  for (int i = 1; i < argc; i++) {
+    const bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--data") == 0 && hasValue) {
+      const std::string arg = argv[++i];
+      const std::size_t eq = arg.find('=');
+      Dataset data;
+      if (eq == std::string::npos ||
+          !loadDataset(arg.substr(0, eq), arg.substr(eq + 1), data)) {
+        return 2;
+      }
+      datasets.push_back(data);
+    } else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue) {
+      baselinePath = argv[++i];
+    } else if (std::strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+      tolerance = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--speed-tolerance") == 0 && hasValue) {
+      speedTolerance = std::atof(argv[++i]);
+    } else {
+      std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  std::vector<Result> results;
+  printHeader();
+  for (const Dataset &data : datasets) {
+    const Result engines[] = {
+        evaluate<FilterEngine<FIRST_ORDER>>("filter_first_order", data),
+        evaluate<FilterEngine<MIDPOINT>>("filter_midpoint", data),
+        evaluate<FilterEngine<RK4>>("filter_rk4", data),
+        evaluate<FilterEngine<CONING>>("filter_coning", data),
+        evaluate<AutoCalibrateEngine>("filter_autocal", data),
+        evaluate<ProcessorEngine>("imunano33", data),
+    };
+    for (const Result &res : engines) {
+      printResult(res);
+      results.push_back(res);
+    }
+  }
+
+  if (baselinePath.empty()) {
+    return 0;
+  }
+
+  std::vector<Result> baseline;
+  if (!loadReport(baselinePath, baseline)) {
+    return 2;
+  }
+  return compare(results, baseline, tolerance, speedTolerance) > 0 ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * Measures Filter::update with the vector type the library was built with, so
+ * the vector backends can be compared. The same source is built once per
+ * backend:
+ *
+ * * bench_backend: svector::Vector3D, in double
+ * * bench_backend_pod: PodVec3D, in double (IMUNANO33_POD_VECTORS)
+ * * bench_backend_pod_float: PodVec3D, in float (IMUNANO33_FLOAT)
+ *
+ * Each prints the backend, the size of a vector, and the average time of an
+ * update with each integrator and of IMUNano33::updateIMU(). The readings are
+ * precomputed, so only the update is timed.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <type_traits>
+#include <vector>
+
+#include <imunano33/filter.hpp>
+#include <imunano33/imunano33.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+const std::size_t READINGS = 1024;
+const std::size_t ITERATIONS = 200000;
+const num_t DELTA_T = 0.01F;
+
+#ifdef IMUNANO33_POD_VECTORS
+const char *const BACKEND = "PodVec3D";
+#elif defined(IMUNANO33_EMBED)
+const char *const BACKEND = "svector::EmbVec3D";
+#else
+const char *const BACKEND = "svector::Vector3D";
+#endif
+
+#ifdef IMUNANO33_FLOAT
+const char *const PRECISION = "float";
+#else
+const char *const PRECISION = "double";
+#endif
+
+struct Readings {
+  std::vector<Vector3D> accel;
+  std::vector<Vector3D> gyro;
+};
+
+// a slow wobble with some jitter, so no update takes a shortcut
+Readings makeReadings() {
+  Readings res;
+  for (std::size_t i = 0; i < READINGS; i++) {
+    const double t = static_cast<double>(i) * DELTA_T;
+    const double jitter = static_cast<double>((i * 7919) % 101) / 1000;
+    res.accel.push_back(Vector3D{static_cast<num_t>(std::sin(t) + jitter),
+                                 static_cast<num_t>(0.5 * std::cos(t)),
+                                 static_cast<num_t>(-9.8 + jitter)});
+    res.gyro.push_back(Vector3D{static_cast<num_t>(0.3 * std::cos(t)),
+                                static_cast<num_t>(-0.2 + jitter),
+                                static_cast<num_t>(0.1 * std::sin(2 * t))});
+  }
+  return res;
+}
+} // namespace
+
+int main() {
+  const Readings readings = makeReadings();
+
+  std::printf("backend: %s, %s, %u bytes per vector, %s\n", BACKEND,
+              PRECISION, static_cast<unsigned int>(sizeof(Vector3D)),
+              std::is_trivially_copyable<Vector3D>::value
+                  ? "trivially copyable"
+                  : "not trivially copyable");
+  std::printf("%-28s %10s\n", "update", "ns/update");
+
+  const struct {
+    const char *name;
+    GyroIntegrator integrator;
+  } integrators[] = {{"Filter::update first order", FIRST_ORDER},
+                     {"Filter::update midpoint", MIDPOINT},
+                     {"Filter::update rk4", RK4},
+                     {"Filter::update coning", CONING}};
+  for (const auto &entry : integrators) {
+    Filter filter;
+    filter.setIntegrator(entry.integrator);
+    std::size_t i = 0;
+    const double ns = nsPerCall(
+        [&]() {
+          filter.update(readings.accel[i], readings.gyro[i], DELTA_T);
+          i = (i + 1) % READINGS;
+          doNotOptimize(filter);
+        },
+        ITERATIONS);
+    std::printf("%-28s %10.1f\n", entry.name, ns);
+  }
+
+  IMUNano33 proc;
+  std::size_t i = 0;
+  const double ns = nsPerCall(
+      [&]() {
+        proc.updateIMU(readings.accel[i], readings.gyro[i], DELTA_T);
+        i = (i + 1) % READINGS;
+        doNotOptimize(proc);
+      },
+      ITERATIONS);
+  std::printf("%-28s %10.1f\n", "IMUNano33::updateIMU", ns);
+
+  return 0;
+}
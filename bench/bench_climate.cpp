@@ -0,0 +1,102 @@
+/**
+ * Compares the throughput and accuracy of the derived climate metrics against
+ * the same formulas with std::log() and std::exp().
+ *
+ * Readings cover -40 C to 60 C and 1% to 100% relative humidity, and are run
+ * through the batch functions.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <imunano33/climate.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+const unsigned int COUNT = 1 << 16;
+
+void refDewPoint(const double *temp, const double *humid, double *out,
+                 const unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    const double gamma =
+        std::log(humid[i] / 100) + 17.62 * temp[i] / (243.12 + temp[i]);
+    out[i] = 243.12 * gamma / (17.62 - gamma);
+  }
+}
+
+void refAbsHumidity(const double *temp, const double *humid, double *out,
+                    const unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    out[i] = 6.112 * std::exp(17.62 * temp[i] / (243.12 + temp[i])) *
+             humid[i] * 2.1668 / (temp[i] + 273.15);
+  }
+}
+
+template <typename F>
+double nsPerReading(F &&func, const std::vector<double> &temp,
+                    const std::vector<double> &humid,
+                    std::vector<double> &out) {
+  return nsPerCall(
+             [&]() {
+               func(temp.data(), humid.data(), out.data(), COUNT);
+               doNotOptimize(out);
+             },
+             200) /
+         COUNT;
+}
+
+void report(const char *name, const std::vector<double> &fast,
+            const std::vector<double> &ref, const bool relative,
+            const double nsFast, const double nsRef) {
+  double maxErr = 0;
+  for (unsigned int i = 0; i < COUNT; i++) {
+    const double err = relative ? std::fabs(fast[i] / ref[i] - 1)
+                                : std::fabs(fast[i] - ref[i]);
+    maxErr = std::max(maxErr, err);
+  }
+
+  std::printf("%-14s %12.3e %10.2f %10.2f %8.2fx\n", name, maxErr, nsFast,
+              nsRef, nsRef / nsFast);
+}
+} // namespace
+
+int main() {
+  std::vector<double> temp(COUNT);
+  std::vector<double> humid(COUNT);
+  for (unsigned int i = 0; i < COUNT; i++) {
+    // interleave the two ranges so neighbouring readings differ
+    temp[i] = -40 + 100.0 * ((i * 7919) % COUNT) / COUNT;
+    humid[i] = 1 + 99.0 * ((i * 104729) % COUNT) / COUNT;
+  }
+
+  std::vector<double> fast(COUNT);
+  std::vector<double> ref(COUNT);
+
+  std::printf("%u readings per batch\n\n", COUNT);
+  std::printf("%-14s %12s %10s %10s %9s\n", "metric", "max_err", "ns_fast",
+              "ns_std", "speedup");
+
+  void (*dewPoint)(const num_t *, const num_t *, num_t *, unsigned int) =
+      Climate::dewPoint;
+  const double nsDew = nsPerReading(dewPoint, temp, humid, fast);
+  const double nsDewRef = nsPerReading(refDewPoint, temp, humid, ref);
+  report("dew_point_c", fast, ref, false, nsDew, nsDewRef);
+
+  void (*absHumidity)(const num_t *, const num_t *, num_t *, unsigned int) =
+      Climate::absHumidity;
+  const double nsAbs = nsPerReading(absHumidity, temp, humid, fast);
+  const double nsAbsRef = nsPerReading(refAbsHumidity, temp, humid, ref);
+  report("abs_humid_rel", fast, ref, true, nsAbs, nsAbsRef);
+
+  void (*heatIndex)(const num_t *, const num_t *, num_t *, unsigned int) =
+      Climate::heatIndex;
+  const double nsHeat = nsPerReading(heatIndex, temp, humid, fast);
+  std::printf("%-14s %12s %10.2f\n", "heat_index_c", "exact", nsHeat);
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * Compares batch unit conversion against converting one reading at a time
+ * through the Climate getters, which is how readings had to be converted
+ * before. The Climate is updated before the getters are timed, as an update
+ * also keeps the climate history and would take most of the time.
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include <imunano33/climate.hpp>
+#include <imunano33/convert.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+const unsigned int COUNT = 1 << 20;
+} // namespace
+
+int main() {
+  std::vector<num_t> temps(COUNT);
+  std::vector<num_t> pressures(COUNT);
+  for (unsigned int i = 0; i < COUNT; i++) {
+    temps[i] = -40 + 100.0 * (i % 1000) / 1000;
+    pressures[i] = 90 + 20.0 * (i % 777) / 777;
+  }
+
+  std::vector<num_t> out(COUNT);
+  Climate climate;
+
+  // the climate is only read in the loop, so it is marked as changed before
+  // each read, or the conversion would be hoisted out of the loop. This goes
+  // through a pointer, as the whole climate would be copied for the barrier
+  climate.update(temps[0], 0, pressures[0]);
+  const Climate *const reading = &climate;
+  const double nsGetterTemp =
+      nsPerCall(
+          [&]() {
+            for (unsigned int i = 0; i < COUNT; i++) {
+              doNotOptimize(reading);
+              out[i] = reading->getTemp<FAHRENHEIT>();
+            }
+            doNotOptimize(out);
+          },
+          20) /
+      COUNT;
+
+  const double nsScalarTemp =
+      nsPerCall(
+          [&]() {
+            for (unsigned int i = 0; i < COUNT; i++) {
+              out[i] = UnitConvert::temp<CELSIUS, FAHRENHEIT>(temps[i]);
+            }
+            doNotOptimize(out);
+          },
+          20) /
+      COUNT;
+
+  // converting back and forth keeps the values bounded over the iterations
+  const double nsBatchTemp =
+      nsPerCall(
+          [&]() {
+            UnitConvert::temp<CELSIUS, FAHRENHEIT>(temps.data(), COUNT);
+            UnitConvert::temp<FAHRENHEIT, CELSIUS>(temps.data(), COUNT);
+            doNotOptimize(temps);
+          },
+          20) /
+      (2.0 * COUNT);
+
+  const double nsGetterPressure =
+      nsPerCall(
+          [&]() {
+            for (unsigned int i = 0; i < COUNT; i++) {
+              doNotOptimize(reading);
+              out[i] = reading->getPressure<MMHG>();
+            }
+            doNotOptimize(out);
+          },
+          20) /
+      COUNT;
+
+  const double nsBatchPressure =
+      nsPerCall(
+          [&]() {
+            UnitConvert::pressure<KPA, MMHG>(pressures.data(), COUNT);
+            UnitConvert::pressure<MMHG, KPA>(pressures.data(), COUNT);
+            doNotOptimize(pressures);
+          },
+          20) /
+      (2.0 * COUNT);
+
+  std::printf("%u readings\n\n", COUNT);
+  std::printf("%-28s %10s\n", "method", "ns_reading");
+  std::printf("%-28s %10.3f\n", "temp getter loop", nsGetterTemp);
+  std::printf("%-28s %10.3f\n", "temp scalar convert loop", nsScalarTemp);
+  std::printf("%-28s %10.3f\n", "temp batch convert", nsBatchTemp);
+  std::printf("%-28s %10.3f\n", "pressure getter loop", nsGetterPressure);
+  std::printf("%-28s %10.3f\n", "pressure batch convert", nsBatchPressure);
+
+  return 0;
+}
@@ -0,0 +1,343 @@
+/**
+ * Counts retired instructions, branches, and branch misses per call of the
+ * hot paths with hardware counters. Unlike wall-clock time, instruction and
+ * branch counts do not depend on the load of the machine, so they can be
+ * compared against a baseline on shared CI machines.
+ *
+ * The report is CSV with one row per path, preceded by a comment naming the
+ * compiler, since the counts depend on the generated code:
+ *
+ * * instructions: retired instructions per call
+ * * branches: retired branches per call
+ * * branch_misses: mispredicted branches per call
+ *
+ * The cost of the measurement loop itself is subtracted.
+ *
+ * Usage: bench_instructions [--baseline FILE] [--tolerance F]
+ *                           [--miss-tolerance F] [--allow-new]
+ *
+ * --baseline compares against a previous report. Paths that are missing from
+ * the baseline, or whose instructions or branches grew by more than the
+ * relative tolerance (0.05 by default), are reported, and the exit code is 1.
+ * Branch misses depend on the predictor, so they are only compared if a miss
+ * tolerance, in misses per call, is given. --allow-new only reports paths
+ * missing from the baseline, for baselines recorded from an older version
+ * that may lack new paths.
+ *
+ * The exit code is 77, which CTest counts as skipped, if the hardware
+ * counters are unavailable, or the baseline is for another compiler or has no
+ * rows. To record a new baseline, run without arguments and save the output.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <imunano33/imunano33.hpp>
+
+#include "benchutil.hpp"
+#include "perfcount.hpp"
+
+using namespace imunano33;
+
+namespace {
+const std::size_t ITERATIONS = 10000;
+const int REPEATS = 7;
+const int SKIPPED = 77;
+
+// instruction counts only match for the same compiler and optimization
+const char *const COMPILER = __VERSION__
+#ifdef __OPTIMIZE__
+    " optimized";
+#else
+    " unoptimized";
+#endif
+
+struct Result {
+  std::string name;
+  double instructions;
+  double branches;
+  double misses;
+};
+
+// counts of ITERATIONS calls, taking the smallest count of several runs to
+// drop interrupts and page faults
+template <typename F>
+bool measureLoop(PerfCounters &counters, F &&func,
+                 double counts[PerfCounters::NUM_COUNTERS]) {
+  for (std::size_t i = 0; i < ITERATIONS / 10; i++) {
+    func();
+  }
+
+  for (int i = 0; i < PerfCounters::NUM_COUNTERS; i++) {
+    counts[i] = HUGE_VAL;
+  }
+  for (int rep = 0; rep < REPEATS; rep++) {
+    uint64_t values[PerfCounters::NUM_COUNTERS];
+    counters.start();
+    for (std::size_t i = 0; i < ITERATIONS; i++) {
+      func();
+    }
+    if (!counters.stop(values)) {
+      return false;
+    }
+
+    for (int i = 0; i < PerfCounters::NUM_COUNTERS; i++) {
+      const double count = static_cast<double>(values[i]);
+      counts[i] = count < counts[i] ? count : counts[i];
+    }
+  }
+  return true;
+}
+
+class Measurer {
+public:
+  explicit Measurer(PerfCounters &counters) : m_counters{counters} {
+    int empty = 0;
+    m_ok = measureLoop(
+        m_counters, [&]() { doNotOptimize(empty); }, m_overhead);
+  }
+
+  template <typename F> void measure(const char *name, F &&func) {
+    double counts[PerfCounters::NUM_COUNTERS];
+    if (!m_ok || !measureLoop(m_counters, func, counts)) {
+      m_ok = false;
+      return;
+    }
+
+    double perCall[PerfCounters::NUM_COUNTERS];
+    for (int i = 0; i < PerfCounters::NUM_COUNTERS; i++) {
+      const double net = counts[i] - m_overhead[i];
+      perCall[i] = (net > 0 ? net : 0) / static_cast<double>(ITERATIONS);
+    }
+    m_results.push_back(Result{name, perCall[PerfCounters::INSTRUCTIONS],
+                               perCall[PerfCounters::BRANCHES],
+                               perCall[PerfCounters::BRANCH_MISSES]});
+  }
+
+  bool ok() const { return m_ok; }
+
+  const std::vector<Result> &results() const { return m_results; }
+
+private:
+  PerfCounters &m_counters;
+  double m_overhead[PerfCounters::NUM_COUNTERS];
+  bool m_ok;
+  std::vector<Result> m_results;
+};
+
+void measureAll(Measurer &measurer) {
+  Quaternion a{Vector3D{1, 2, 3}, 0.7};
+  const Quaternion b{Vector3D{-2, 1, 0.5}, 0.01};
+  Vector3D v{0.3, -9.7, 1.1};
+  const Vector3D accel{0.2, -0.1, -9.8};
+  const Vector3D gyro{0.1, -0.2, 0.05};
+
+  // results are fed back in so each call depends on the previous one
+  measurer.measure("quat_product", [&]() {
+    a = a * b;
+    doNotOptimize(a);
+  });
+  a = a.unit();
+  measurer.measure("quat_rotate", [&]() {
+    v = a.rotate(v);
+    doNotOptimize(v);
+  });
+  measurer.measure("quat_unit", [&]() {
+    a = a.unit();
+    doNotOptimize(a);
+  });
+
+  const struct {
+    const char *name;
+    GyroIntegrator integrator;
+  } integrators[] = {{"filter_update_first_order", FIRST_ORDER},
+                     {"filter_update_midpoint", MIDPOINT},
+                     {"filter_update_rk4", RK4},
+                     {"filter_update_coning", CONING}};
+  for (const auto &entry : integrators) {
+    Filter filter;
+    filter.setIntegrator(entry.integrator);
+    measurer.measure(entry.name, [&]() {
+      filter.update(accel, gyro, 0.01);
+      doNotOptimize(filter);
+    });
+  }
+
+  Filter filter;
+  measurer.measure("filter_update_gyro", [&]() {
+    filter.updateGyro(gyro, 0.01);
+    doNotOptimize(filter);
+  });
+  measurer.measure("filter_update_accel", [&]() {
+    filter.updateAccel(accel, 0.01);
+    doNotOptimize(filter);
+  });
+
+  IMUNano33 proc;
+  measurer.measure("imunano33_update", [&]() {
+    proc.updateIMU(accel, gyro, 0.01);
+    doNotOptimize(proc);
+  });
+}
+
+void printReport(const std::vector<Result> &results) {
+  std::printf("# compiler: %s\n", COMPILER);
+  std::printf("name,instructions,branches,branch_misses\n");
+  for (const Result &res : results) {
+    std::printf("%s,%.1f,%.1f,%.3f\n", res.name.c_str(), res.instructions,
+                res.branches, res.misses);
+  }
+}
+
+bool loadReport(const std::string &path, std::string &compiler,
+                std::vector<Result> &results) {
+  std::ifstream file{path};
+  if (!file) {
+    std::fprintf(stderr, "cannot open %s\n", path.c_str());
+    return false;
+  }
+
+  const std::string prefix = "# compiler: ";
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.compare(0, prefix.size(), prefix) == 0) {
+      compiler = line.substr(prefix.size());
+      continue;
+    }
+    if (line.empty() || line[0] == '#' || line.compare(0, 5, "name,") == 0) {
+      continue;
+    }
+
+    std::istringstream fields{line};
+    Result res;
+    std::string field;
+    std::getline(fields, res.name, ',');
+    double *const numbers[] = {&res.instructions, &res.branches, &res.misses};
+    for (double *number : numbers) {
+      std::getline(fields, field, ',');
+      *number = std::atof(field.c_str());
+    }
+    results.push_back(res);
+  }
+
+  return true;
+}
+
+// returns the number of regressions, counting paths missing from the baseline
+// unless allowNew is set
+int compare(const std::vector<Result> &results,
+            const std::vector<Result> &baseline, const double tolerance,
+            const double missTolerance, const bool allowNew) {
+  std::map<std::string, const Result *> byName;
+  for (const Result &res : baseline) {
+    byName[res.name] = &res;
+  }
+
+  int regressions = 0;
+  for (const Result &res : results) {
+    const auto found = byName.find(res.name);
+    if (found == byName.end()) {
+      std::fprintf(stderr, "not in baseline: %s\n", res.name.c_str());
+      if (!allowNew) {
+        ++regressions;
+      }
+      continue;
+    }
+
+    const Result &base = *found->second;
+    const struct {
+      const char *metric;
+      bool regressed;
+      double value;
+      double baseline;
+    } checks[] = {
+        {"instructions",
+         res.instructions > base.instructions * (1 + tolerance),
+         res.instructions, base.instructions},
+        {"branches", res.branches > base.branches * (1 + tolerance),
+         res.branches, base.branches},
+        {"branch_misses",
+         missTolerance > 0 && res.misses > base.misses + missTolerance,
+         res.misses, base.misses},
+    };
+
+    for (const auto &check : checks) {
+      if (check.regressed) {
+        std::fprintf(stderr, "regression: %s %s %.3f (baseline %.3f)\n",
+                     res.name.c_str(), check.metric, check.value,
+                     check.baseline);
+        ++regressions;
+      }
+    }
+  }
+
+  return regressions;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string baselinePath;
+  double tolerance = 0.05;
+  double missTolerance = 0;
+  bool allowNew = false;
+
+  for (int i = 1; i < argc; i++) {
+    const bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--baseline") == 0 && hasValue) {
+      baselinePath = argv[++i];
+    } else if (std::strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+      tolerance = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--miss-tolerance") == 0 && hasValue) {
+      missTolerance = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--allow-new") == 0) {
+      allowNew = true;
+    } else {
+      std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  PerfCounters counters;
+  if (!counters.available()) {
+    std::fprintf(stderr, "hardware counters are unavailable, skipping\n");
+    return SKIPPED;
+  }
+
+  Measurer measurer{counters};
+  measureAll(measurer);
+  if (!measurer.ok()) {
+    std::fprintf(stderr, "counters were multiplexed, skipping\n");
+    return SKIPPED;
+  }
+  printReport(measurer.results());
+
+  if (baselinePath.empty()) {
+    return 0;
+  }
+
+  std::string compiler;
+  std::vector<Result> baseline;
+  if (!loadReport(baselinePath, compiler, baseline)) {
+    return 2;
+  }
+  if (compiler != COMPILER) {
+    std::fprintf(stderr, "baseline is for compiler \"%s\", skipping\n",
+                 compiler.c_str());
+    return SKIPPED;
+  }
+  if (baseline.empty()) {
+    std::fprintf(stderr, "baseline has no rows, skipping\n");
+    return SKIPPED;
+  }
+  return compare(measurer.results(), baseline, tolerance, missTolerance,
+                 allowNew) > 0
+             ? 1
+             : 0;
+}
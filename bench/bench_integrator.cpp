@@ -0,0 +1,125 @@
+/**
+ * Compares the accuracy and cost of the gyro integrators at different sample
+ * rates.
+ *
+ * The IMU follows a coning motion, where the rotation axis is tilted from the
+ * z axis and spins around it. This is the classic worst case for gyro
+ * integration because the angular velocity keeps changing direction, and it
+ * has an exact orientation to compare against at every sample.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <imunano33/filter.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+const double CONE_ANGLE = 0.3;          // rad
+const double CONE_RATE = 2 * M_PI * 2;  // rad/s
+const double DURATION = 10;             // s
+
+Quaternion truthAt(const double t) {
+  return Quaternion{
+      std::cos(CONE_ANGLE / 2),
+      Vector3D{std::sin(CONE_ANGLE / 2) * std::cos(CONE_RATE * t),
+               std::sin(CONE_ANGLE / 2) * std::sin(CONE_RATE * t), 0}};
+}
+
+Vector3D rateAt(const double t) {
+  const double s = std::sin(CONE_ANGLE / 2) * CONE_RATE;
+  const Quaternion qDot{
+      0, Vector3D{-s * std::sin(CONE_RATE * t), s * std::cos(CONE_RATE * t), 0}};
+  return (truthAt(t).conj() * qDot).vec() * 2;
+}
+
+double angleBetween(const Quaternion &a, const Quaternion &b) {
+  const double d = std::fabs(a.w() * b.w() + dot(a.vec(), b.vec()));
+  return 2 * std::acos(std::min(d, 1.0));
+}
+
+struct Result {
+  double maxErr;
+  double rmsErr;
+  double ns;
+};
+
+Result run(const GyroIntegrator integrator, const double rate) {
+  const double dt = 1 / rate;
+  const int steps = static_cast<int>(rate * DURATION);
+
+  std::vector<Vector3D> gyro;
+  gyro.reserve(steps + 1);
+  for (int i = 0; i <= steps; i++) {
+    gyro.push_back(rateAt(i * dt));
+  }
+
+  Filter f{1, truthAt(0)};
+  f.setIntegrator(integrator);
+  f.updateGyro(gyro[0], 0);
+
+  Result res{0, 0, 0};
+  for (int i = 1; i <= steps; i++) {
+    f.updateGyro(gyro[i], dt);
+    const double err = angleBetween(f.getRotQ(), truthAt(i * dt));
+    res.maxErr = std::max(res.maxErr, err);
+    res.rmsErr += err * err;
+  }
+  res.rmsErr = std::sqrt(res.rmsErr / steps);
+
+  // time the update alone on the same readings
+  Filter timed{1, truthAt(0)};
+  timed.setIntegrator(integrator);
+  std::size_t idx = 0;
+  res.ns = nsPerCall(
+      [&]() {
+        timed.updateGyro(gyro[idx], dt);
+        idx = idx == static_cast<std::size_t>(steps) ? 0 : idx + 1;
+        doNotOptimize(timed);
+      },
+      1000000);
+
+  return res;
+}
+} // namespace
+
+int main() {
+  const GyroIntegrator integrators[] = {FIRST_ORDER, MIDPOINT, RK4, CONING};
+  const char *names[] = {"first_order", "midpoint", "rk4", "coning"};
+  const double rates[] = {25, 50, 100, 200, 400, 800};
+
+  std::printf("coning motion: half angle %.2f rad, %.1f Hz, %.0f s\n\n",
+              CONE_ANGLE, CONE_RATE / (2 * M_PI), DURATION);
+  std::printf("%-12s %8s %14s %14s %10s\n", "integrator", "rate_hz",
+              "max_err_deg", "rms_err_deg", "ns_update");
+
+  double reference = 0;
+  double bestRate[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; i++) {
+    for (const double rate : rates) {
+      const Result res = run(integrators[i], rate);
+      std::printf("%-12s %8.0f %14.6f %14.6f %10.1f\n", names[i], rate,
+                  res.maxErr * 180 / M_PI, res.rmsErr * 180 / M_PI, res.ns);
+
+      if (integrators[i] == FIRST_ORDER && rate == 100) {
+        reference = res.maxErr;
+      }
+      if (bestRate[i] == 0 && res.maxErr <= reference) {
+        bestRate[i] = rate;
+      }
+    }
+  }
+
+  std::printf("\nlowest rate matching first_order at 100 Hz (%.4f deg):\n",
+              reference * 180 / M_PI);
+  for (int i = 0; i < 4; i++) {
+    std::printf("%-12s %8.0f Hz\n", names[i], bestRate[i]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * Compares the cost and accuracy of the quaternion interpolators.
+ *
+ * nlerp skips the trigonometry of slerp but does not move at a constant
+ * angular velocity, so its error against slerp grows with the angle between
+ * the two rotations. slerpFrames produces evenly spaced slerp frames with a
+ * recurrence instead of per-frame trigonometry.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <imunano33/quaternion.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+const unsigned int FRAMES = 64;
+
+double angleBetween(const Quaternion &a, const Quaternion &b) {
+  const double d = std::fabs(dot(a, b));
+  return 2 * std::acos(std::min(d, 1.0));
+}
+
+/**
+ * @brief Largest angle between nlerp and slerp over a dense sweep of t
+ */
+double nlerpError(const Quaternion &from, const Quaternion &to) {
+  double maxErr = 0;
+  for (int i = 0; i <= 1000; i++) {
+    const double t = i / 1000.0;
+    maxErr = std::max(maxErr,
+                      angleBetween(nlerp(from, to, t), slerp(from, to, t)));
+  }
+  return maxErr;
+}
+
+/**
+ * @brief Largest angle between slerpFrames and slerp over FRAMES frames
+ */
+double framesError(const Quaternion &from, const Quaternion &to) {
+  std::vector<Quaternion> frames(FRAMES);
+  const double step = 1.0 / (FRAMES - 1);
+  slerpFrames(from, to, 0, step, frames.data(), FRAMES);
+
+  double maxErr = 0;
+  for (unsigned int i = 0; i < FRAMES; i++) {
+    maxErr = std::max(maxErr,
+                      angleBetween(frames[i], slerp(from, to, i * step)));
+  }
+  return maxErr;
+}
+} // namespace
+
+int main() {
+  const Vector3D axis = Vector3D{1, -2, 0.5}.normalize();
+  const Quaternion from = Quaternion::fromEuler(0.2, 0.1, -0.3);
+  const double step = 1.0 / (FRAMES - 1);
+
+  std::printf("%-10s %14s %14s %10s %10s %10s\n", "angle_deg",
+              "nlerp_err_deg", "frames_err_deg", "ns_nlerp", "ns_slerp",
+              "ns_frames");
+
+  const double angles[] = {1, 5, 10, 30, 60, 90, 135, 180};
+  for (const double deg : angles) {
+    const Quaternion to = from * Quaternion{axis, deg * M_PI / 180};
+
+    std::vector<Quaternion> frames(FRAMES);
+    const double nsNlerp = nsPerCall(
+                               [&]() {
+                                 for (unsigned int i = 0; i < FRAMES; i++) {
+                                   frames[i] = nlerp(from, to, i * step);
+                                 }
+                                 doNotOptimize(frames);
+                               },
+                               20000) /
+                           FRAMES;
+    const double nsSlerp = nsPerCall(
+                               [&]() {
+                                 for (unsigned int i = 0; i < FRAMES; i++) {
+                                   frames[i] = slerp(from, to, i * step);
+                                 }
+                                 doNotOptimize(frames);
+                               },
+                               20000) /
+                           FRAMES;
+    const double nsFrames = nsPerCall(
+                                [&]() {
+                                  slerpFrames(from, to, 0, step, frames.data(),
+                                              FRAMES);
+                                  doNotOptimize(frames);
+                                },
+                                20000) /
+                            FRAMES;
+
+    std::printf("%-10.0f %14.6f %14.2e %10.2f %10.2f %10.2f\n", deg,
+                nlerpError(from, to) * 180 / M_PI,
+                framesError(from, to) * 180 / M_PI, nsNlerp, nsSlerp,
+                nsFrames);
+  }
+
+  std::printf("\nns columns are per frame, over %u frames per call\n", FRAMES);
+
+  return 0;
+}
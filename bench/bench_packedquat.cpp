@@ -0,0 +1,77 @@
+/**
+ * Compares Quaternion against PackedQuaternion as storage for a large array of
+ * orientations: composing every element with a delta, normalizing, and
+ * conjugating, plus the memory each array takes.
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include <imunano33/packedquat.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+const std::size_t COUNT = 4096;
+const std::size_t PASSES = 500;
+
+// average nanoseconds to apply op to one element of quats
+template <typename Q, typename F>
+double nsPerElement(std::vector<Q> &quats, F &&op) {
+  return nsPerCall(
+             [&]() {
+               for (Q &q : quats) {
+                 q = op(q);
+               }
+               doNotOptimize(quats.front());
+             },
+             PASSES) /
+         static_cast<double>(quats.size());
+}
+
+void report(const char *name, const double before, const double after) {
+  std::printf("%-18s %12.2f %12.2f %9.2fx\n", name, before, after,
+              before / after);
+}
+} // namespace
+
+int main() {
+  std::vector<Quaternion> quats;
+  std::vector<PackedQuaternion> packed;
+  for (std::size_t i = 0; i < COUNT; i++) {
+    const Quaternion q{Vector3D{1, static_cast<num_t>(i % 7), -2},
+                       0.001 * static_cast<num_t>(i)};
+    quats.push_back(q);
+    packed.push_back(PackedQuaternion{q});
+  }
+  const Quaternion delta{Vector3D{0.3, -0.2, 1}, 0.01};
+  const PackedQuaternion packedDelta{delta};
+
+  std::printf("%-18s %12s %12s %10s\n", "operation", "quat_ns", "packed_ns",
+              "speedup");
+
+  const double composeBefore =
+      nsPerElement(quats, [&](const Quaternion &q) { return q * delta; });
+  const double composeAfter = nsPerElement(
+      packed, [&](const PackedQuaternion &q) { return q * packedDelta; });
+  report("compose", composeBefore, composeAfter);
+
+  const double unitBefore =
+      nsPerElement(quats, [](const Quaternion &q) { return q.unit(); });
+  const double unitAfter =
+      nsPerElement(packed, [](const PackedQuaternion &q) { return q.unit(); });
+  report("unit", unitBefore, unitAfter);
+
+  const double conjBefore =
+      nsPerElement(quats, [](const Quaternion &q) { return q.conj(); });
+  const double conjAfter =
+      nsPerElement(packed, [](const PackedQuaternion &q) { return q.conj(); });
+  report("conj", conjBefore, conjAfter);
+
+  std::printf("\nbytes per element: %zu quaternion, %zu packed\n",
+              sizeof(Quaternion), sizeof(PackedQuaternion));
+
+  return 0;
+}
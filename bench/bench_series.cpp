@@ -0,0 +1,126 @@
+/**
+ * Measures the compression ratio, accuracy, and decode speed of
+ * OrientationSeries on filter output from synthetic IMU traces.
+ *
+ * Each trace is 10 minutes at 200 Hz. The ratio is against a PackedQuaternion
+ * per orientation, the smallest uncompressed storage, and the decode speed is
+ * in bytes of PackedQuaternion written per second.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <imunano33/filter.hpp>
+#include <imunano33/series.hpp>
+#include <imunano33/simulate.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+const num_t RATE = 200;
+const std::size_t COUNT = 10 * 60 * 200;
+
+struct Trace {
+  std::string name;
+  std::vector<PackedQuaternion> quats;
+};
+
+Trace simulate(const std::string &name, const ImuSimulator::Motion &motion,
+               const uint64_t seed) {
+  ImuSimulator::SensorModel sensor;
+  sensor.gyroNoise = 0.005;
+  sensor.accelNoise = 0.02;
+
+  Trace trace{name, {}};
+  trace.quats.reserve(COUNT);
+  ImuSimulator sim{motion, sensor, RATE, seed};
+  Filter filter;
+  for (std::size_t i = 0; i < COUNT; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    filter.update(sample.accel, sample.gyro, sample.deltaT);
+    trace.quats.push_back(PackedQuaternion{filter.getRotQ()});
+  }
+  return trace;
+}
+
+std::vector<Trace> traces() {
+  std::vector<Trace> result;
+
+  ImuSimulator::Motion still;
+  still.initialAngles = Vector3D{0.5, -0.3, 0};
+  result.push_back(simulate("still", still, 1));
+
+  ImuSimulator::Motion handheld;
+  handheld.initialAngles = Vector3D{0.2, 0.2, 0};
+  handheld.angleRate = Vector3D{0, 0, 0.5};
+  handheld.shakeAmplitude = Vector3D{0.2, 0.2, 0.1};
+  handheld.shakeFreq = 1;
+  result.push_back(simulate("handheld", handheld, 2));
+
+  ImuSimulator::Motion tumble;
+  tumble.angleRate = Vector3D{2, 0.5, -1.5};
+  tumble.shakeAmplitude = Vector3D{0.5, 0.3, 0.5};
+  tumble.shakeFreq = 2;
+  result.push_back(simulate("tumble", tumble, 3));
+
+  return result;
+}
+
+double angleBetween(const PackedQuaternion &a, const PackedQuaternion &b) {
+  const double cosHalf = std::fabs(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] +
+                                   a[3] * b[3]);
+  return 2 * std::acos(std::min(1.0, cosHalf));
+}
+} // namespace
+
+int main() {
+  std::printf("%-10s %5s %10s %7s %11s %11s %10s\n", "trace", "bits",
+              "bytes/quat", "ratio", "max_err_rad", "decode_GB/s", "at_ns");
+
+  for (const Trace &trace : traces()) {
+    for (const unsigned int bits : {12U, 16U, 20U}) {
+      OrientationSeries series{bits};
+      for (const PackedQuaternion &q : trace.quats) {
+        series.append(q.toQuaternion());
+      }
+      series.shrinkToFit();
+
+      std::vector<PackedQuaternion> decoded(series.size());
+      const double decodeNs = nsPerCall(
+          [&]() {
+            series.decode(0, series.size(), decoded.data());
+            doNotOptimize(decoded.back());
+          },
+          20);
+
+      double maxErr = 0;
+      for (std::size_t i = 0; i < decoded.size(); i++) {
+        maxErr = std::max(maxErr, angleBetween(decoded[i], trace.quats[i]));
+      }
+
+      std::size_t index = 0;
+      const double atNs = nsPerCall(
+          [&]() {
+            index = (index + 7919) % series.size();
+            doNotOptimize(series.at(index));
+          },
+          100000);
+
+      const double bytesPerQuat = static_cast<double>(series.byteSize()) /
+                                  static_cast<double>(series.size());
+      const double decodedBytes =
+          static_cast<double>(series.size() * sizeof(PackedQuaternion));
+      std::printf("%-10s %5u %10.2f %6.1fx %11.2e %11.2f %10.0f\n",
+                  trace.name.c_str(), bits, bytesPerQuat,
+                  sizeof(PackedQuaternion) / bytesPerQuat, maxErr,
+                  decodedBytes / decodeNs, atNs);
+    }
+  }
+
+  return 0;
+}
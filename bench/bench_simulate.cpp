@@ -0,0 +1,94 @@
+/**
+ * Measures how fast the synthetic IMU generates samples, and how fast the
+ * filter runs on realistic motion from it.
+ *
+ * Pass the number of samples as the first argument for stress runs, such as
+ * 100000000.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <imunano33/filter.hpp>
+#include <imunano33/simulate.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+// yaw drifts without a magnetometer, so only compare the direction of gravity
+double tiltError(const Quaternion &a, const Quaternion &b) {
+  const Vector3D up{0, 0, 1};
+  const double d = dot(a.conj().rotate(up), b.conj().rotate(up));
+  return std::acos(d < 1 ? d : 1);
+}
+
+ImuSimulator::Motion handheld() {
+  ImuSimulator::Motion motion;
+  motion.angleRate = Vector3D{0, 0, 0.5};
+  motion.shakeAmplitude = Vector3D{0.2, 0.2, 0.1};
+  motion.shakeFreq = 3;
+  motion.accelAmplitude = Vector3D{1, 1, 0.5};
+  motion.accelFreq = 1;
+  return motion;
+}
+
+ImuSimulator::SensorModel noisy() {
+  // roughly the LSM9DS1 on the Arduino Nano 33 BLE
+  ImuSimulator::SensorModel sensor;
+  sensor.gyroBias = Vector3D{0.01, -0.005, 0.002};
+  sensor.gyroNoise = 0.005;
+  sensor.accelNoise = 0.02;
+  sensor.dropout = 0.001;
+  return sensor;
+}
+
+double seconds(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const unsigned long count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000UL;
+  const double rate = 200;
+
+  std::printf("%lu samples at %.0f Hz (%.0f s of motion)\n\n", count, rate,
+              count / rate);
+
+  // generation alone
+  ImuSimulator sim{handheld(), noisy(), rate, 1};
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < count; i++) {
+    doNotOptimize(sim.next());
+  }
+  const double genNs = seconds(start) * 1e9 / count;
+
+  // generation and filter
+  sim.reset();
+  Filter filter{0.98, sim.current().orientation};
+  double maxErr = 0;
+  double sumSqErr = 0;
+  start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < count; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    filter.update(sample.accel, sample.gyro, sample.deltaT);
+    const double err = tiltError(filter.getRotQ(), sample.orientation);
+    maxErr = err > maxErr ? err : maxErr;
+    sumSqErr += err * err;
+  }
+  const double totalNs = seconds(start) * 1e9 / count;
+
+  std::printf("%-24s %10s\n", "", "ns/sample");
+  std::printf("%-24s %10.1f\n", "generate", genNs);
+  std::printf("%-24s %10.1f\n", "generate + filter", totalNs);
+  std::printf("\ntilt error: rms %.4f rad, max %.4f rad\n",
+              std::sqrt(sumSqErr / count), maxErr);
+
+  return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * Compares compound vector expressions written with the vector operators,
+ * which build a temporary vector for every operator, against the fused
+ * versions the library uses.
+ *
+ * The "operators" columns are the expressions as they were written before the
+ * fused functions in vecops.hpp.
+ */
+
+#include <cstdio>
+
+#include <imunano33/filter.hpp>
+#include <imunano33/vecops.hpp>
+
+#include "benchutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+const std::size_t ITERATIONS = 2000000;
+
+Quaternion productOperators(const Quaternion &lhs, const Quaternion &rhs) {
+  const num_t wl = lhs.w();
+  const num_t wr = rhs.w();
+  const Vector3D vl = lhs.vec();
+  const Vector3D vr = rhs.vec();
+
+  return Quaternion{wl * wr - dot(vl, vr), vr * wl + vl * wr + cross(vl, vr)};
+}
+
+Vector3D rotateOperators(const Quaternion &q, const Vector3D &vec) {
+  const Quaternion vecQ{0, vec};
+  return productOperators(productOperators(q, vecQ), q.inv()).vec();
+}
+
+Vector3D coningOperators(const Vector3D &prev2, const Vector3D &prev,
+                         const Vector3D &cur, const num_t time) {
+  return (prev * 8 + cur * 5 - prev2) * (time / 12) +
+         cross(prev, cur) * (time * time / 12);
+}
+
+Vector3D coningFused(const Vector3D &prev2, const Vector3D &prev,
+                     const Vector3D &cur, const num_t time) {
+  return crossAdd(linComb(prev, time * 8 / 12, cur, time * 5 / 12, prev2,
+                          -time / 12),
+                  prev, cur, time * time / 12);
+}
+
+void report(const char *name, const double before, const double after) {
+  std::printf("%-22s %12.1f %12.1f %9.2fx\n", name, before, after,
+              before / after);
+}
+} // namespace
+
+int main() {
+  Quaternion a{Vector3D{1, 2, 3}, 0.7};
+  const Quaternion b{Vector3D{-2, 1, 0.5}, 0.01};
+  Vector3D v{0.3, -9.7, 1.1};
+  const Vector3D w0{0.1, 0.2, 0.3};
+  const Vector3D w1{0.12, 0.19, 0.31};
+  const Vector3D w2{0.14, 0.18, 0.33};
+
+  std::printf("%-22s %12s %12s %10s\n", "expression", "operators_ns",
+              "fused_ns", "speedup");
+
+  // the results are fed back in so each call depends on the previous one
+  const double productBefore = nsPerCall(
+      [&]() {
+        a = productOperators(a, b);
+        doNotOptimize(a);
+      },
+      ITERATIONS);
+  const double productAfter = nsPerCall(
+      [&]() {
+        a = a * b;
+        doNotOptimize(a);
+      },
+      ITERATIONS);
+  report("quaternion product", productBefore, productAfter);
+
+  a = a.unit();
+  const double rotateBefore = nsPerCall(
+      [&]() {
+        v = rotateOperators(a, v);
+        doNotOptimize(v);
+      },
+      ITERATIONS);
+  const double rotateAfter = nsPerCall(
+      [&]() {
+        v = a.rotate(v);
+        doNotOptimize(v);
+      },
+      ITERATIONS);
+  report("rotate vector", rotateBefore, rotateAfter);
+
+  Vector3D rotVec;
+  const double coningBefore = nsPerCall(
+      [&]() {
+        rotVec = coningOperators(w2, w1, w0 + rotVec * 1e-9, 0.01);
+        doNotOptimize(rotVec);
+      },
+      ITERATIONS);
+  rotVec = Vector3D{};
+  const double coningAfter = nsPerCall(
+      [&]() {
+        rotVec = coningFused(w2, w1, linComb(w0, 1, rotVec, 1e-9), 0.01);
+        doNotOptimize(rotVec);
+      },
+      ITERATIONS);
+  report("coning rotation vector", coningBefore, coningAfter);
+
+  // the whole update, for scale
+  Filter filter;
+  const Vector3D accel{0.2, -0.1, -9.8};
+  const Vector3D gyro{0.1, -0.2, 0.05};
+  const double update = nsPerCall(
+      [&]() {
+        filter.update(accel, gyro, 0.01);
+        doNotOptimize(filter);
+      },
+      ITERATIONS);
+  std::printf("\nFilter::update %.1f ns\n", update);
+
+  return 0;
+}
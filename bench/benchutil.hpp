@@ -0,0 +1,48 @@
+#ifndef INCLUDE_IMUNANO33BENCH_BENCHUTIL_HPP_
+#define INCLUDE_IMUNANO33BENCH_BENCHUTIL_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433
+#endif
+
+/**
+ * @brief Keeps the compiler from optimizing away a computed value
+ */
+template <typename T> inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void *sink;
+  sink = &value;
+#endif
+}
+
+/**
+ * @brief Runs a function repeatedly and measures the average time per call
+ *
+ * @param func Function to run
+ * @param iterations Number of calls to time
+ *
+ * @returns Average nanoseconds per call
+ */
+template <typename F>
+inline double nsPerCall(F &&func, const std::size_t iterations) {
+  // warm up caches and branch predictors
+  for (std::size_t i = 0; i < iterations / 10 + 1; i++) {
+    func();
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; i++) {
+    func();
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         static_cast<double>(iterations);
+}
+
+#endif
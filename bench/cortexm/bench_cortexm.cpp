@@ -0,0 +1,158 @@
+/**
+ * Measures the update paths of the embedded build on a bare-metal Cortex-M4F.
+ * The program times a loop of each path with SysTick, which counts processor
+ * clock cycles, and prints one CSV row per path over semihosting:
+ *
+ * * name: the path
+ * * iterations: calls in the timed loop
+ * * ticks: SysTick ticks for the whole loop, less the cost of an empty loop
+ *
+ * On hardware, ticks are cycles. Under QEMU with -icount shift=0, each
+ * instruction takes 1 ns of virtual time and SysTick runs at the board's 25
+ * MHz, so each tick is 40 instructions. run.cmake does that conversion.
+ *
+ * It is linked for the QEMU mps2-an386 board with mps2_an386.ld and newlib's
+ * rdimon.specs, whose crt0 sets up the C runtime and semihosting.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <imunano33/imunano33.hpp>
+
+using namespace imunano33;
+
+extern "C" {
+void _start();
+extern uint32_t __stack;
+}
+
+namespace {
+const uint32_t ITERATIONS = 256;
+
+// SysTick and coprocessor access registers of the System Control Space
+volatile uint32_t &SYST_CSR = *reinterpret_cast<uint32_t *>(0xE000E010);
+volatile uint32_t &SYST_RVR = *reinterpret_cast<uint32_t *>(0xE000E014);
+volatile uint32_t &SYST_CVR = *reinterpret_cast<uint32_t *>(0xE000E018);
+volatile uint32_t &SCB_CPACR = *reinterpret_cast<uint32_t *>(0xE000ED88);
+
+const uint32_t SYST_MASK = 0xFFFFFF;
+
+template <typename T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+void startSysTick() {
+  // enabled, counting the processor clock, without interrupts
+  SYST_RVR = SYST_MASK;
+  SYST_CVR = 0;
+  SYST_CSR = 0x5;
+}
+
+// ticks of ITERATIONS calls
+template <typename F> uint32_t measureLoop(F &&func) {
+  for (uint32_t i = 0; i < ITERATIONS / 8; i++) {
+    func();
+  }
+
+  // SysTick counts down and wraps at 24 bits, far above a loop's ticks
+  const uint32_t start = SYST_CVR;
+  for (uint32_t i = 0; i < ITERATIONS; i++) {
+    func();
+  }
+  const uint32_t end = SYST_CVR;
+  return (start - end) & SYST_MASK;
+}
+
+uint32_t overhead = 0;
+
+template <typename F> void measure(const char *name, F &&func) {
+  const uint32_t ticks = measureLoop(func);
+  printf("%s,%lu,%lu\n", name, static_cast<unsigned long>(ITERATIONS),
+         static_cast<unsigned long>(ticks > overhead ? ticks - overhead : 0));
+}
+
+void measureAll() {
+  int empty = 0;
+  overhead = measureLoop([&]() { doNotOptimize(empty); });
+
+  Quaternion a{Vector3D{1, 2, 3}, 0.7F};
+  const Quaternion b{Vector3D{-2, 1, 0.5F}, 0.01F};
+  Vector3D v{0.3F, -9.7F, 1.1F};
+  const Vector3D accel{0.2F, -0.1F, -9.8F};
+  const Vector3D gyro{0.1F, -0.2F, 0.05F};
+
+  // results are fed back in so each call depends on the previous one
+  measure("quat_product", [&]() {
+    a = a * b;
+    doNotOptimize(a);
+  });
+  a = a.unit();
+  measure("quat_rotate", [&]() {
+    v = a.rotate(v);
+    doNotOptimize(v);
+  });
+
+  const struct {
+    const char *name;
+    GyroIntegrator integrator;
+  } integrators[] = {{"filter_update_first_order", FIRST_ORDER},
+                     {"filter_update_midpoint", MIDPOINT},
+                     {"filter_update_rk4", RK4},
+                     {"filter_update_coning", CONING}};
+  for (const auto &entry : integrators) {
+    Filter filter;
+    filter.setIntegrator(entry.integrator);
+    measure(entry.name, [&]() {
+      filter.update(accel, gyro, 0.01F);
+      doNotOptimize(filter);
+    });
+  }
+
+  Filter filter;
+  measure("filter_update_gyro", [&]() {
+    filter.updateGyro(gyro, 0.01F);
+    doNotOptimize(filter);
+  });
+  measure("filter_update_accel", [&]() {
+    filter.updateAccel(accel, 0.01F);
+    doNotOptimize(filter);
+  });
+
+  IMUNano33 proc;
+  measure("imunano33_update", [&]() {
+    proc.updateIMU(accel, gyro, 0.01F);
+    doNotOptimize(proc);
+  });
+}
+
+void hang() {
+  for (;;) {
+  }
+}
+} // namespace
+
+extern "C" void resetHandler() {
+  // the float code faults unless the FPU is enabled first
+  SCB_CPACR |= 0xFU << 20;
+  asm volatile("dsb\n\tisb" : : : "memory");
+  _start();
+  hang();
+}
+
+// initial stack pointer, then reset, NMI, and fault handlers
+extern "C" __attribute__((section(".vectors"), used)) const uintptr_t
+    vectors[] = {reinterpret_cast<uintptr_t>(&__stack),
+                 reinterpret_cast<uintptr_t>(&resetHandler),
+                 reinterpret_cast<uintptr_t>(&hang),
+                 reinterpret_cast<uintptr_t>(&hang),
+                 reinterpret_cast<uintptr_t>(&hang),
+                 reinterpret_cast<uintptr_t>(&hang),
+                 reinterpret_cast<uintptr_t>(&hang)};
+
+int main() {
+  startSysTick();
+  printf("name,iterations,ticks\n");
+  measureAll();
+  return 0;
+}
@@ -0,0 +1,72 @@
+# Runs bench_cortexm under QEMU and reports instructions and estimated cycles
+# per call of each update path.
+#
+# Usage: cmake -DQEMU=qemu-system-arm -DELF=bench_cortexm.elf -P run.cmake
+#
+# QEMU runs with -icount shift=0, which retires one instruction per ns of
+# virtual time, so SysTick, clocked at SYSCLK_HZ, counts instructions exactly.
+# QEMU does not model the pipeline, so cycles are estimated as instructions
+# times CPI, the average cycles per instruction of the Cortex-M4F on float code
+# run from flash with the nRF52840's cache (loads, taken branches, and
+# VDIV/VSQRT take more than one cycle). CPI may have one decimal. CLOCK_HZ is
+# the clock of the Nano 33 BLE, to turn cycles into time per call.
+
+if(NOT QEMU OR NOT ELF)
+  message(FATAL_ERROR "QEMU and ELF must be given")
+endif()
+if(NOT SYSCLK_HZ)
+  set(SYSCLK_HZ 25000000)
+endif()
+if(NOT CPI)
+  set(CPI 1.3)
+endif()
+if(NOT CLOCK_HZ)
+  set(CLOCK_HZ 64000000)
+endif()
+
+execute_process(
+  COMMAND ${QEMU} -M mps2-an386 -nographic -monitor none -serial none
+          -semihosting-config enable=on,target=native -icount shift=0
+          -kernel ${ELF}
+  # semihosting writes to stderr when there is no console chardev
+  OUTPUT_VARIABLE output
+  ERROR_VARIABLE output
+  RESULT_VARIABLE result
+  TIMEOUT 300
+)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "QEMU failed (${result}):\n${output}")
+endif()
+
+# cmake math is integer only, so fractions are kept in tenths
+math(EXPR insnsPerTick "1000000000 / ${SYSCLK_HZ}")
+string(REPLACE "." "" cpiTenths "${CPI}")
+if(NOT CPI MATCHES "\\.")
+  set(cpiTenths "${CPI}0")
+endif()
+
+message("# cortex-m4f, ${CLOCK_HZ} Hz, CPI ${CPI}")
+message("name,instructions,est_cycles,est_us")
+string(REPLACE "\n" ";" lines "${output}")
+set(rows 0)
+foreach(line IN LISTS lines)
+  if(NOT line MATCHES "^([a-z0-9_]+),([0-9]+),([0-9]+)$")
+    continue()
+  endif()
+  set(name ${CMAKE_MATCH_1})
+  set(iterations ${CMAKE_MATCH_2})
+  set(ticks ${CMAKE_MATCH_3})
+
+  math(EXPR insns "${ticks} * ${insnsPerTick} / ${iterations}")
+  math(EXPR cycles "${insns} * ${cpiTenths} / 10")
+  math(EXPR usTenths "${cycles} * 10000000 / ${CLOCK_HZ}")
+  math(EXPR usWhole "${usTenths} / 10")
+  math(EXPR usFrac "${usTenths} % 10")
+  message("${name},${insns},${cycles},${usWhole}.${usFrac}")
+  math(EXPR rows "${rows} + 1")
+endforeach()
+
+# a run that printed nothing is a broken build, not a fast one
+if(rows EQUAL 0)
+  message(FATAL_ERROR "no results in the output:\n${output}")
+endif()
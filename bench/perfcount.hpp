@@ -0,0 +1,128 @@
+#ifndef INCLUDE_IMUNANO33BENCH_PERFCOUNT_HPP_
+#define INCLUDE_IMUNANO33BENCH_PERFCOUNT_HPP_
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Hardware counters of retired instructions, branches, and branch
+ * misses for this thread, in user space only
+ *
+ * Uses perf_event_open on Linux. The counters are unavailable on other systems,
+ * in most virtual machines, and where perf_event_paranoid forbids them.
+ */
+class PerfCounters {
+public:
+  /**
+   * @brief Index of each counter
+   */
+  enum Counter { INSTRUCTIONS, BRANCHES, BRANCH_MISSES, NUM_COUNTERS };
+
+  /**
+   * @brief Opens the counters, disabled
+   */
+  PerfCounters() {
+#ifdef __linux__
+    const uint64_t configs[NUM_COUNTERS] = {PERF_COUNT_HW_INSTRUCTIONS,
+                                            PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+                                            PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = configs[i];
+      attr.disabled = i == 0 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      // the first counter leads the group, so all three count together
+      m_fds[i] = static_cast<int>(
+          syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : m_fds[0],
+                  0));
+      if (m_fds[i] < 0) {
+        close();
+        return;
+      }
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  ~PerfCounters() { close(); }
+
+  /**
+   * @brief Determines if the counters could be opened
+   *
+   * @returns If counting works
+   */
+  bool available() const { return m_fds[0] >= 0; }
+
+  /**
+   * @brief Resets and starts the counters
+   */
+  void start() {
+#ifdef __linux__
+    ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  /**
+   * @brief Stops the counters and reads them
+   *
+   * @param values Count of each counter since start()
+   *
+   * @returns If the counts are complete. They are not if the kernel
+   * multiplexed the counters with other events.
+   */
+  bool stop(uint64_t values[NUM_COUNTERS]) {
+#ifdef __linux__
+    ioctl(m_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // number of counters, time enabled, time running, then the counts
+    uint64_t data[3 + NUM_COUNTERS];
+    if (read(m_fds[0], data, sizeof(data)) !=
+            static_cast<ssize_t>(sizeof(data)) ||
+        data[0] != NUM_COUNTERS || data[1] != data[2]) {
+      return false;
+    }
+
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+      values[i] = data[3 + i];
+    }
+    return true;
+#else
+    static_cast<void>(values);
+    return false;
+#endif
+  }
+
+private:
+  int m_fds[NUM_COUNTERS] = {-1, -1, -1};
+
+  void close() {
+#ifdef __linux__
+    for (int &fd : m_fds) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+      fd = -1;
+    }
+#endif
+  }
+};
+
+#endif
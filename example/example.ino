@@ -12,6 +12,8 @@
  * "<temperature in C>,<humidity in %>,<pressure in kPa>".
  * It is important to note that these values are integers which are
  * 10 times their actual value, so there is one digit of precision.
+ * Climate data is only sent when it changes by more than the deadbands set in
+ * setup(), or at least once a minute.
  *
  * Quaternion/orientation data is sent in the following form on the serial monitor:
  * "Q:<w>,<x>,<y>,<z>"
@@ -24,6 +26,7 @@
  */
 
 #include <math.h>
+#include <stdio.h>
 
 #ifndef M_PI
 #define M_PI 3.1415926535897932384626433
@@ -57,6 +60,11 @@ enum ColorState {
 // IMU control
 float prevTimeIMU;
 
+// the LSM9DS1 reads acceleration in g with y and z inverted, and angular
+// velocity in degrees per second with x inverted, relative to the axes on docs
+using AccelInput = imunano33::SensorInput<imunano33::POS_X, imunano33::NEG_Y, imunano33::NEG_Z>;
+using GyroInput = imunano33::SensorInput<imunano33::NEG_X, imunano33::POS_Y, imunano33::POS_Z, imunano33::DegToRad>;
+
 // climate control
 float prevTimeClimate;
 
@@ -102,6 +110,14 @@ void setup() {
 #endif
 
   prevTimeIMU = millis() / 1000.0;
+  proc.setGravity(1);  // LSM9DS1 accelerometer readings are in g
+
+  // only send climate data when it changes by more than the precision it is
+  // sent with (0.1 C, 0.5 %, 0.1 kPa), smoothed to filter out sensor noise, and
+  // at least once a minute so the receiver knows the board is alive
+  proc.climatePublisher().setDeadband(0.1, 0.5, 0.1);
+  proc.climatePublisher().setSmoothing(0.5);
+  proc.climatePublisher().setInterval(0, 60);
   proc.zeroIMU();
 }
 
@@ -120,10 +136,14 @@ void loop() {
     float humidity = HTS.readHumidity();
     float pressure = BARO.readPressure();
 
-    proc.updateClimate(temperature, humidity, pressure);
+    proc.updateClimate(temperature, humidity, pressure,
+                       curTime - prevTimeClimate);
 
 #ifndef USE_BLUETOOTH
-    updateSerialClimate(temperature, humidity, pressure);
+    if (proc.climateChanged()) {
+      imunano33::ClimatePublisher &pub = proc.climatePublisher();
+      updateSerialClimate(pub.getTemp(), pub.getHumidity(), pub.getPressure());
+    }
 #endif
 
     prevTimeClimate = curTime;
@@ -148,8 +168,12 @@ void loop() {
         float humidity = HTS.readHumidity();
         float pressure = BARO.readPressure();
 
-        proc.updateClimate(temperature, humidity, pressure);
-        updateBLEClimate(temperature, humidity, pressure);
+        proc.updateClimate(temperature, humidity, pressure,
+                           curTime - prevTimeClimate);
+        if (proc.climateChanged()) {
+          imunano33::ClimatePublisher &pub = proc.climatePublisher();
+          updateBLEClimate(pub.getTemp(), pub.getHumidity(), pub.getPressure());
+        }
 
         prevTimeClimate = curTime;
       }
@@ -173,26 +197,12 @@ void readIMU(float curTime) {
 
   if (IMU.accelerationAvailable()) {
     IMU.readAcceleration(aX, aY, aZ);
-
-    // need to invert to be consistent with axes on docs
-    aY = -aY;
-    aZ = -aZ;
-
-    proc.updateIMUAccel({ aX, aY, aZ });
+    proc.updateIMUAccelRaw<AccelInput>(aX, aY, aZ);
   }
 
   if (IMU.gyroscopeAvailable()) {
     IMU.readGyroscope(gX, gY, gZ);
-
-    // need to invert to be consistent with axes on docs
-    gX = -gX;
-
-    // converts degrees to radians
-    gX *= (M_PI / 180);
-    gY *= (M_PI / 180);
-    gZ *= (M_PI / 180);
-
-    proc.updateIMUGyro({ gX, gY, gZ }, curTime - prevTimeIMU);
+    proc.updateIMUGyroRaw<GyroInput>(gX, gY, gZ, curTime - prevTimeIMU);
     prevTimeIMU = curTime;
   }
 }
@@ -224,17 +234,20 @@ void updateSerialClimate(const float &temperature, const float &humidity, const
 
 void updateBLEIMU(const imunano33::Quaternion &qRot) {
   imunano33::Vector3D sendVec = qRot.vec() * 1000;
-  String send = String{ lroundf(qRot.w() * 1000) } + "," + String{ lroundf(sendVec.x) } + "," + String{ lroundf(sendVec.y) } + "," + String{ lroundf(sendVec.z) };
+  // formatted on the stack, as building a String would allocate every sample
+  char send[32];
+  int length = snprintf(send, sizeof(send), "%ld,%ld,%ld,%ld", lroundf(qRot.w() * 1000), lroundf(sendVec.x), lroundf(sendVec.y), lroundf(sendVec.z));
 
   // +1 for null character at the end
-  imuChr.writeValue(send.c_str(), send.length() + 1);
+  imuChr.writeValue(send, length + 1);
 }
 
 void updateBLEClimate(const float &temperature, const float &humidity, const float &pressure) {
-  String send = String{ lroundf(temperature * 10) } + "," + String{ lroundf(humidity * 10) } + "," + String{ lroundf(pressure * 10) };
+  char send[32];
+  int length = snprintf(send, sizeof(send), "%ld,%ld,%ld", lroundf(temperature * 10), lroundf(humidity * 10), lroundf(pressure * 10));
 
   // +1 for null character at the end
-  climateChr.writeValue(send.c_str(), send.length() + 1);
+  climateChr.writeValue(send, length + 1);
 }
 
 void color() {
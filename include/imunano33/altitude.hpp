@@ -0,0 +1,247 @@
+/**
+ * @file
+ * @brief File containing the imunano33::AltitudeEstimator class
+ */
+
+#ifndef INCLUDE_IMUNANO33_ALTITUDE_HPP_
+#define INCLUDE_IMUNANO33_ALTITUDE_HPP_
+
+#ifdef IMUNANO33_EMBED
+#include <math.h>
+#else
+#include <cmath>
+#endif
+
+#include "imunano33/unit.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Estimates altitude and vertical speed from a barometer and vertical
+ * acceleration
+ *
+ * Barometric altitude is accurate over the long term but noisy and slow, and
+ * integrated acceleration is smooth and fast but drifts, so the two are blended
+ * with a third-order complementary filter. Each acceleration update integrates
+ * the vertical acceleration, corrected by the difference between the latest
+ * barometric altitude and the estimated altitude. The filter also estimates the
+ * vertical accelerometer bias, so a small bias does not show up as a vertical
+ * speed.
+ *
+ * The filter only starts once the first pressure reading arrives, which sets
+ * the altitude to the barometric altitude and the vertical speed to 0.
+ */
+class AltitudeEstimator {
+public:
+  /**
+   * @brief Default constructor
+   *
+   * Sets the time constant to 1 s and the sea level pressure to 101.325 kPa.
+   */
+  AltitudeEstimator() = default;
+
+  /**
+   * @brief Constructor
+   *
+   * @param timeConstant See setTimeConstant().
+   * @param seaLevel Sea level pressure, in kPa
+   */
+  AltitudeEstimator(const num_t timeConstant, const num_t seaLevel)
+      : m_seaLevel{seaLevel} {
+    setTimeConstant(timeConstant);
+  }
+
+  /**
+   * @brief Converts pressure to altitude with the standard atmosphere
+   *
+   * Uses a polynomial instead of pow(). For pressures between 0.3 and 1.1
+   * times the sea level pressure (about -800 m to 9000 m), the result is within
+   * 0.06 m of the exact formula 44330.77 * (1 - (p / p0)^0.190263). Outside
+   * that range, the exact formula is used.
+   *
+   * @param pressure Pressure, in kPa
+   * @param seaLevel Sea level pressure, in kPa
+   *
+   * @returns Altitude above sea level, in m
+   */
+  static num_t pressureToAltitude(const num_t pressure,
+                                  const num_t seaLevel = STANDARD_PRESSURE) {
+#ifndef IMUNANO33_EMBED
+    using std::pow;
+#endif
+
+    // polynomial fit in (ratio - 1) on [0.3, 1.1], evaluated with Horner's
+    // method
+    const num_t ratio = pressure / seaLevel;
+#ifdef IMUNANO33_FLOAT
+    if (ratio < 0.3F || ratio > 1.1F) {
+      return 44330.77F * (1 - static_cast<num_t>(pow(ratio, 0.190263F)));
+    }
+
+    const num_t x = ratio - 1;
+    return 1.7474273583e-02F +
+           x * (-8.4343875451e+03F +
+                x * (3.4049339721e+03F +
+                     x * (-2.1184601059e+03F +
+                          x * (2.0391029217e+03F +
+                               x * (5.0592091671e+03F +
+                                    x * (2.1669951885e+04F +
+                                         x * (3.0562617242e+04F +
+                                              x * 1.9164614230e+04F)))))));
+#else
+    if (ratio < 0.3 || ratio > 1.1) {
+      return 44330.77 * (1 - pow(ratio, 0.190263));
+    }
+
+    const num_t x = ratio - 1;
+    return 1.7474273583e-02 +
+           x * (-8.4343875451e+03 +
+                x * (3.4049339721e+03 +
+                     x * (-2.1184601059e+03 +
+                          x * (2.0391029217e+03 +
+                               x * (5.0592091671e+03 +
+                                    x * (2.1669951885e+04 +
+                                         x * (3.0562617242e+04 +
+                                              x * 1.9164614230e+04)))))));
+#endif
+  }
+
+  /**
+   * @brief Updates barometric altitude
+   *
+   * @param pressure Pressure, in kPa
+   */
+  void updatePressure(const num_t pressure) {
+    m_baroAltitude = pressureToAltitude(pressure, m_seaLevel);
+
+    if (!m_dataExists) {
+      m_dataExists = true;
+      m_altitude = m_baroAltitude;
+      m_speed = 0;
+      m_accelBias = 0;
+    }
+  }
+
+  /**
+   * @brief Updates estimate with vertical acceleration
+   *
+   * Does nothing until the first pressure reading.
+   *
+   * @param accel Vertical acceleration in the world frame, without gravity, in
+   * m/s^2, where positive is up
+   * @param deltaT Time since the previous acceleration update, in s
+   */
+  void updateAccel(const num_t accel, const num_t deltaT) {
+    if (!m_dataExists) {
+      return;
+    }
+
+    const num_t err = m_baroAltitude - m_altitude;
+    const num_t accelCorr = accel - m_accelBias + m_gain[1] * err;
+
+    m_altitude += (m_speed + m_gain[0] * err) * deltaT +
+                  accelCorr * deltaT * deltaT / 2;
+    m_speed += accelCorr * deltaT;
+    m_accelBias -= m_gain[2] * err * deltaT;
+  }
+
+  /**
+   * @brief Sets how quickly the estimate follows the barometer
+   *
+   * Shorter time constants trust the barometer more, and longer time constants
+   * trust the accelerometer more.
+   *
+   * @param timeConstant Time constant of the filter, in s
+   */
+  void setTimeConstant(const num_t timeConstant) {
+    const num_t omega = 1 / timeConstant;
+    m_gain[0] = 3 * omega;
+    m_gain[1] = 3 * omega * omega;
+    m_gain[2] = omega * omega * omega;
+  }
+
+  /**
+   * @brief Sets sea level pressure
+   *
+   * Setting this to the pressure at a reference point makes the altitude
+   * relative to that point.
+   *
+   * @param seaLevel Sea level pressure, in kPa
+   */
+  void setSeaLevelPressure(const num_t seaLevel) { m_seaLevel = seaLevel; }
+
+  /**
+   * @brief Gets sea level pressure
+   *
+   * @returns Sea level pressure, in kPa
+   */
+  num_t getSeaLevelPressure() const { return m_seaLevel; }
+
+  /**
+   * @brief Determines if there is an altitude estimate
+   *
+   * @returns If a pressure reading has been given since construction or
+   * reset().
+   */
+  bool dataExists() const { return m_dataExists; }
+
+  /**
+   * @brief Gets estimated altitude
+   *
+   * @returns Altitude above sea level, in m
+   */
+  num_t getAltitude() const { return m_altitude; }
+
+  /**
+   * @brief Gets estimated vertical speed
+   *
+   * @returns Vertical speed, in m/s, where positive is up
+   */
+  num_t getVerticalSpeed() const { return m_speed; }
+
+  /**
+   * @brief Gets altitude from the latest pressure reading alone
+   *
+   * @returns Barometric altitude, in m
+   */
+  num_t getBaroAltitude() const { return m_baroAltitude; }
+
+  /**
+   * @brief Clears the estimate
+   *
+   * The filter restarts at the next pressure reading.
+   */
+  void reset() {
+    m_dataExists = false;
+    m_altitude = 0;
+    m_speed = 0;
+    m_accelBias = 0;
+    m_baroAltitude = 0;
+  }
+
+  /**
+   * @brief Standard sea level pressure, in kPa
+   */
+#ifdef IMUNANO33_FLOAT
+  static constexpr num_t STANDARD_PRESSURE = 101.325F;
+#else
+  static constexpr num_t STANDARD_PRESSURE = 101.325;
+#endif
+
+private:
+  bool m_dataExists{false};
+
+#ifdef IMUNANO33_FLOAT
+  num_t m_seaLevel = 101.325F;
+#else
+  num_t m_seaLevel = 101.325;
+#endif
+  num_t m_gain[3] = {3, 3, 1}; // time constant of 1 s
+
+  num_t m_altitude = 0;
+  num_t m_speed = 0;
+  num_t m_accelBias = 0;
+  num_t m_baroAltitude = 0;
+};
+} // namespace imunano33
+
+#endif
@@ -6,9 +6,133 @@
 #ifndef INCLUDE_IMUNANO33_CLIMATE_HPP_
 #define INCLUDE_IMUNANO33_CLIMATE_HPP_
 
+#include "imunano33/convert.hpp"
+#include "imunano33/mathutil.hpp"
+#include "imunano33/rolling.hpp"
 #include "imunano33/unit.hpp"
 
+#ifndef IMUNANO33_CLIMATE_HISTORY
+/**
+ * @brief Number of climate samples kept by imunano33::Climate
+ *
+ * Define this before including the library to change the size of the history.
+ */
+#define IMUNANO33_CLIMATE_HISTORY 32
+#endif
+
 namespace imunano33 {
+/**
+ * @brief Fixed history of timestamped climate samples with rolling statistics
+ *
+ * Keeps the last N samples of each channel in a RollingWindow, so the mean,
+ * variance, minimum, and maximum over the history are O(1) to query. The
+ * timestamps are kept in a plain ring alongside. Nothing is allocated after
+ * construction.
+ *
+ * Temperature is in C, humidity in percent, and pressure in kPa.
+ *
+ * @tparam N Number of samples kept.
+ */
+template <unsigned int N> class ClimateHistory {
+public:
+  /**
+   * @brief Adds a sample to the history
+   *
+   * If the history is full, the oldest sample is dropped.
+   *
+   * @param time Timestamp of the sample, in s
+   * @param temp Temperature, in C
+   * @param humid Relative humidity, in percent
+   * @param pressure Pressure, in kPa
+   */
+  void push(const num_t time, const num_t temp, const num_t humid,
+            const num_t pressure) {
+    m_times[m_head] = time;
+    m_head = (m_head + 1) % N;
+    m_temp.push(temp);
+    m_humid.push(humid);
+    m_pressure.push(pressure);
+  }
+
+  /**
+   * @brief Gets number of samples in the history
+   *
+   * @returns Number of samples, at most N
+   */
+  unsigned int size() const { return m_temp.size(); }
+
+  /**
+   * @brief Determines if the history is empty
+   *
+   * @returns If there are no samples.
+   */
+  bool empty() const { return m_temp.empty(); }
+
+  /**
+   * @brief Gets timestamp of a sample
+   *
+   * @param i Index of the sample, where 0 is the oldest sample.
+   *
+   * @note i must be less than size().
+   *
+   * @returns Timestamp, in s
+   */
+  num_t getTime(const unsigned int i) const { return m_times[slot(i)]; }
+
+  /**
+   * @brief Gets time spanned by the history
+   *
+   * @returns Time between the oldest and newest samples, in s
+   */
+  num_t getDuration() const {
+    return empty() ? 0 : getTime(size() - 1) - getTime(0);
+  }
+
+  /**
+   * @brief Gets temperature history
+   *
+   * @returns Window of temperatures, in C
+   */
+  const RollingWindow<N> &getTemp() const { return m_temp; }
+
+  /**
+   * @brief Gets humidity history
+   *
+   * @returns Window of relative humidities, in percent
+   */
+  const RollingWindow<N> &getHumidity() const { return m_humid; }
+
+  /**
+   * @brief Gets pressure history
+   *
+   * @returns Window of pressures, in kPa
+   */
+  const RollingWindow<N> &getPressure() const { return m_pressure; }
+
+  /**
+   * @brief Removes all samples
+   */
+  void reset() {
+    m_head = 0;
+    m_temp.reset();
+    m_humid.reset();
+    m_pressure.reset();
+  }
+
+private:
+  // ring index of the i-th oldest sample, which is at the head once the
+  // history is full
+  unsigned int slot(const unsigned int i) const {
+    return size() < N ? i : (m_head + i) % N;
+  }
+
+  num_t m_times[N] = {};
+  unsigned int m_head = 0;
+  RollingWindow<N> m_temp;
+  RollingWindow<N> m_humid;
+  RollingWindow<N> m_pressure;
+};
+
 /**
  * @brief Handles climate data from Nano 33 (or other) sensors
  *
@@ -24,6 +148,11 @@ namespace imunano33 {
  */
 class Climate {
 public:
+  /**
+   * @brief Type of the climate history
+   */
+  using History = ClimateHistory<IMUNANO33_CLIMATE_HISTORY>;
+
   /**
    * @brief Default constructor
    *
@@ -76,31 +205,7 @@ public:
    * @returns Temperature in given unit.
    */
   template <TempUnit U> num_t getTemp() const {
-    num_t res = 0;
-
-    switch (U) {
-    case FAHRENHEIT:
-#ifdef IMUNANO33_EMBED
-      res = m_temp * (9.0F / 5.0F) + 32.0F;
-#else
-      res = m_temp * (9.0 / 5.0) + 32.0;
-#endif
-      break;
-    case CELSIUS:
-      res = m_temp;
-      break;
-    case KELVIN:
-#ifdef IMUNANO33_EMBED
-      res = m_temp + 273.15F;
-#else
-      res = m_temp + 273.15;
-#endif
-      break;
-    default:
-      res = m_temp;
-    }
-
-    return res;
+    return UnitConvert::temp<CELSIUS, U>(m_temp);
   }
 
   /**
@@ -113,48 +218,214 @@ public:
    * @returns Pressure in given unit.
    */
   template <PressureUnit U> num_t getPressure() const {
-    num_t res = 0;
-
-    switch (U) {
-    case KPA:
-      res = m_pressure;
-      break;
-    case ATM:
-#ifdef IMUNANO33_EMBED
-      res = m_pressure * 0.00986923266716F;
-#else
-      res = m_pressure * 0.00986923266716;
+    return UnitConvert::pressure<KPA, U>(m_pressure);
+  }
+
+  /**
+   * @brief Gets relative humidity
+   *
+   * Check that this humidity measurement is valid with dataExists() first.
+   *
+   * Unit is percent humidity.
+   *
+   * @returns Relative humidity
+   */
+  num_t getHumidity() const { return m_humid; }
+
+  /**
+   * @brief Gets dew point
+   *
+   * See dewPoint(). Check that the data is valid with dataExists() first.
+   *
+   * @tparam U Temperature unit.
+   *
+   * @returns Dew point in given unit.
+   */
+  template <TempUnit U> num_t getDewPoint() const {
+    return UnitConvert::temp<CELSIUS, U>(dewPoint(m_temp, m_humid));
+  }
+
+  /**
+   * @brief Gets heat index
+   *
+   * See heatIndex(). Check that the data is valid with dataExists() first.
+   *
+   * @tparam U Temperature unit.
+   *
+   * @returns Heat index in given unit.
+   */
+  template <TempUnit U> num_t getHeatIndex() const {
+    return UnitConvert::temp<CELSIUS, U>(heatIndex(m_temp, m_humid));
+  }
+
+  /**
+   * @brief Gets absolute humidity
+   *
+   * See absHumidity(). Check that the data is valid with dataExists() first.
+   *
+   * @returns Absolute humidity, in g/m^3
+   */
+  num_t getAbsHumidity() const { return absHumidity(m_temp, m_humid); }
+
+  /**
+   * @brief Calculates dew point
+   *
+   * Uses the Magnus formula with the Sonntag (1990) constants, which is
+   * accurate to about 0.35 C from -45 C to 60 C. The logarithm is
+   * approximated with MathUtil::fastLog(), which adds less than 0.0001 C of
+   * error.
+   *
+   * @param temp Temperature, in C
+   * @param humid Relative humidity, in percent
+   *
+   * @note humid must be positive.
+   *
+   * @returns Dew point, in C
+   */
+  static num_t dewPoint(const num_t temp, const num_t humid) {
+    const num_t gamma =
+        MathUtil::fastLog(humid * static_cast<num_t>(0.01)) +
+        MAGNUS_B * temp / (MAGNUS_C + temp);
+    return MAGNUS_C * gamma / (MAGNUS_B - gamma);
+  }
+
+  /**
+   * @brief Calculates dew point for arrays of readings
+   *
+   * @param temp Temperatures, in C
+   * @param humid Relative humidities, in percent
+   * @param out Array to write the dew points to, in C
+   * @param count Number of readings
+   */
+  static void dewPoint(const num_t *temp, const num_t *humid, num_t *out,
+                       const unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+      out[i] = dewPoint(temp[i], humid[i]);
+    }
+  }
+
+  /**
+   * @brief Calculates heat index
+   *
+   * Uses the US National Weather Service algorithm: Steadman's simple formula
+   * when it gives less than 80 F, and the Rothfusz regression with its low and
+   * high humidity adjustments otherwise. This is already a polynomial, so no
+   * approximation is needed.
+   *
+   * @param temp Temperature, in C
+   * @param humid Relative humidity, in percent
+   *
+   * @returns Heat index, in C
+   */
+  static num_t heatIndex(const num_t temp, const num_t humid) {
+#ifndef IMUNANO33_EMBED
+    using std::sqrt;
 #endif
-      break;
-    case MMHG:
-#ifdef IMUNANO33_EMBED
-      res = m_pressure * 7.500617F;
+
+#ifdef IMUNANO33_FLOAT
+    const num_t t = temp * 1.8F + 32;
+    num_t res = 0.5F * (t + 61 + (t - 68) * 1.2F + humid * 0.094F);
+    if ((res + t) / 2 >= 80) {
+      res = -42.379F + 2.04901523F * t + 10.14333127F * humid -
+            0.22475541F * t * humid - 0.00683783F * t * t -
+            0.05481717F * humid * humid + 0.00122874F * t * t * humid +
+            0.00085282F * t * humid * humid -
+            0.00000199F * t * t * humid * humid;
 #else
-      res = m_pressure * 7.500617;
+    const num_t t = temp * 1.8 + 32;
+    num_t res = 0.5 * (t + 61 + (t - 68) * 1.2 + humid * 0.094);
+    if ((res + t) / 2 >= 80) {
+      res = -42.379 + 2.04901523 * t + 10.14333127 * humid -
+            0.22475541 * t * humid - 0.00683783 * t * t -
+            0.05481717 * humid * humid + 0.00122874 * t * t * humid +
+            0.00085282 * t * humid * humid - 0.00000199 * t * t * humid * humid;
 #endif
-      break;
-    case PSI:
-#ifdef IMUNANO33_EMBED
-      res = m_pressure * 0.1450377377F;
+
+      if (humid < 13 && t >= 80 && t <= 112) {
+        const num_t dist = t < 95 ? 95 - t : t - 95;
+        res -= (13 - humid) / 4 * sqrt((17 - dist) / 17);
+      } else if (humid > 85 && t >= 80 && t <= 87) {
+        res += (humid - 85) / 10 * ((87 - t) / 5);
+      }
+    }
+
+    return (res - 32) / static_cast<num_t>(1.8);
+  }
+
+  /**
+   * @brief Calculates heat index for arrays of readings
+   *
+   * @param temp Temperatures, in C
+   * @param humid Relative humidities, in percent
+   * @param out Array to write the heat indices to, in C
+   * @param count Number of readings
+   */
+  static void heatIndex(const num_t *temp, const num_t *humid, num_t *out,
+                        const unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+      out[i] = heatIndex(temp[i], humid[i]);
+    }
+  }
+
+  /**
+   * @brief Calculates absolute humidity
+   *
+   * Finds the vapor pressure from the saturation vapor pressure given by the
+   * Magnus formula, then converts it to a density with the ideal gas law. The
+   * exponential is approximated with MathUtil::fastExp(), which adds a relative
+   * error of less than 1e-6.
+   *
+   * @param temp Temperature, in C
+   * @param humid Relative humidity, in percent
+   *
+   * @returns Absolute humidity, in g/m^3
+   */
+  static num_t absHumidity(const num_t temp, const num_t humid) {
+#ifdef IMUNANO33_FLOAT
+    const num_t kelvin = temp + 273.15F;
 #else
-      res = m_pressure * 0.1450377377;
+    const num_t kelvin = temp + 273.15;
 #endif
-      break;
-    }
 
-    return res;
+    // both fractions below share this division, which costs more than the
+    // rest of the function
+    const num_t inv = 1 / ((MAGNUS_C + temp) * kelvin);
+
+    // saturation vapor pressure, in hPa
+    const num_t satPressure =
+        MAGNUS_A * MathUtil::fastExp(MAGNUS_B * temp * kelvin * inv);
+
+    // e / (R_v T), with e in Pa and the result in g/m^3
+#ifdef IMUNANO33_FLOAT
+    return satPressure * humid * 2.1668F * (MAGNUS_C + temp) * inv;
+#else
+    return satPressure * humid * 2.1668 * (MAGNUS_C + temp) * inv;
+#endif
   }
 
   /**
-   * @brief Gets relative humidity
+   * @brief Calculates absolute humidity for arrays of readings
    *
-   * Check that this humidity measurement is valid with dataExists() first.
+   * @param temp Temperatures, in C
+   * @param humid Relative humidities, in percent
+   * @param out Array to write the absolute humidities to, in g/m^3
+   * @param count Number of readings
+   */
+  static void absHumidity(const num_t *temp, const num_t *humid, num_t *out,
+                          const unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+      out[i] = absHumidity(temp[i], humid[i]);
+    }
+  }
+
+  /**
+   * @brief Gets history of climate data
    *
-   * Unit is percent humidity.
+   * The history holds the last IMUNANO33_CLIMATE_HISTORY updates.
    *
-   * @returns Relative humidity
+   * @returns Climate history
    */
-  num_t getHumidity() const { return m_humid; }
+  const History &getHistory() const { return m_history; }
 
   /**
    * @brief Updates climate data
@@ -162,20 +433,55 @@ public:
    * @param temp Temperature, in C
    * @param humid Relative humidity, in percent
    * @param pressure Pressure, in kPa
+   * @param time Timestamp of the data, in s. This is only used for the
+   * history (see getHistory()).
    */
-  void update(const num_t temp, const num_t humid, const num_t pressure) {
+  void update(const num_t temp, const num_t humid, const num_t pressure,
+              const num_t time = 0) {
     m_dataExists = true;
     m_temp = temp;
     m_humid = humid;
     m_pressure = pressure;
+    m_history.push(time, temp, humid, pressure);
   }
 
   /**
    * @brief Resets climate data
    *
-   * dataExists() will be false after this is called.
+   * dataExists() will be false and the history will be empty after this is
+   * called.
+   */
+  void reset() {
+    m_dataExists = false;
+    m_history.reset();
+  }
+
+  /**
+   * @brief Magnus formula coefficient, in hPa
+   */
+#ifdef IMUNANO33_FLOAT
+  static constexpr num_t MAGNUS_A = 6.112F;
+#else
+  static constexpr num_t MAGNUS_A = 6.112;
+#endif
+
+  /**
+   * @brief Magnus formula coefficient
    */
-  void reset() { m_dataExists = false; }
+#ifdef IMUNANO33_FLOAT
+  static constexpr num_t MAGNUS_B = 17.62F;
+#else
+  static constexpr num_t MAGNUS_B = 17.62;
+#endif
+
+  /**
+   * @brief Magnus formula coefficient, in C
+   */
+#ifdef IMUNANO33_FLOAT
+  static constexpr num_t MAGNUS_C = 243.12F;
+#else
+  static constexpr num_t MAGNUS_C = 243.12;
+#endif
 
 private:
   bool m_dataExists{false};
@@ -183,6 +489,8 @@ private:
   num_t m_temp = 0.0;
   num_t m_humid = 0.0;
   num_t m_pressure = 0.0;
+
+  History m_history;
 };
 } // namespace imunano33
 
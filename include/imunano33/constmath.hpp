@@ -0,0 +1,338 @@
+/**
+ * @file
+ * @brief File containing the imunano33::ConstMath class
+ *
+ * The svector vector backends have virtual destructors, so they and the
+ * Quaternion that holds one are not literal types. PodVec3D, used with
+ * IMUNANO33_POD_VECTORS, is literal, but Quaternion has no constexpr
+ * operations with any backend. ConstVector3D and PackedQuaternion are literal
+ * types whatever the backend, and ConstMath provides the vector and
+ * quaternion operations on them as constexpr functions. Mounting rotations,
+ * lookup tables, and reference vectors can then be computed entirely at
+ * compile time and converted to the runtime types where they are used.
+ */
+
+#ifndef INCLUDE_IMUNANO33_CONSTMATH_HPP_
+#define INCLUDE_IMUNANO33_CONSTMATH_HPP_
+
+#ifdef IMUNANO33_EMBED
+#include <float.h>
+#else
+#include <cfloat>
+#endif
+
+#include "imunano33/packedquat.hpp"
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Three dimensional vector usable in constant expressions
+ */
+struct ConstVector3D {
+  num_t x; //!< x component
+  num_t y; //!< y component
+  num_t z; //!< z component
+
+  /**
+   * @brief Converts to the runtime vector type
+   *
+   * @returns Vector with the same components
+   */
+  Vector3D toVector() const { return Vector3D{x, y, z}; }
+};
+
+/**
+ * @brief Adds two vectors
+ *
+ * @param lhs Left hand argument
+ * @param rhs Right hand argument
+ *
+ * @returns Sum
+ */
+constexpr ConstVector3D operator+(const ConstVector3D &lhs,
+                                  const ConstVector3D &rhs) {
+  return ConstVector3D{lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+}
+
+/**
+ * @brief Subtracts two vectors
+ *
+ * @param lhs Left hand argument
+ * @param rhs Right hand argument
+ *
+ * @returns Difference
+ */
+constexpr ConstVector3D operator-(const ConstVector3D &lhs,
+                                  const ConstVector3D &rhs) {
+  return ConstVector3D{lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+}
+
+/**
+ * @brief Scales a vector
+ *
+ * @param vec Vector to scale
+ * @param k Scale
+ *
+ * @returns Scaled vector
+ */
+constexpr ConstVector3D operator*(const ConstVector3D &vec, const num_t k) {
+  return ConstVector3D{vec.x * k, vec.y * k, vec.z * k};
+}
+
+/**
+ * @brief Math functions that can be evaluated at compile time
+ *
+ * Everything is written to the C++11 rules for constexpr functions, so loops
+ * are recursion. The functions are meant for constants; at runtime, the
+ * regular math library and vector types are faster.
+ */
+class ConstMath {
+public:
+  /**
+   * @brief Square root
+   *
+   * @param num Number to take the square root of
+   *
+   * @returns Square root, 0 if num is not positive, or num if it is NaN or
+   * positive infinity
+   */
+  static constexpr num_t sqrt(const num_t num) {
+    // scale into [2^-64, 2^64] so Newton's method converges in a few dozen
+    // steps from its starting guess. NaN and infinity, which fail the first
+    // comparison, would never converge
+    return !(num <= MAX)   ? num
+           : num <= 0      ? 0
+           : num > BIG     ? sqrt(num / BIG) * SQRT_BIG
+           : num < 1 / BIG ? sqrt(num * BIG) / SQRT_BIG
+                           : sqrtNewton(num, num > 1 ? num : 1);
+  }
+
+  /**
+   * @brief Sine
+   *
+   * @param ang Angle in radians
+   *
+   * @returns Sine of ang
+   */
+  static constexpr num_t sin(const num_t ang) {
+    return sinSeries(wrap(ang) * wrap(ang), wrap(ang), 0, 1);
+  }
+
+  /**
+   * @brief Cosine
+   *
+   * @param ang Angle in radians
+   *
+   * @returns Cosine of ang
+   */
+  static constexpr num_t cos(const num_t ang) {
+    return cosSeries(wrap(ang) * wrap(ang), 1, 0, 1);
+  }
+
+  /**
+   * @brief Dot product
+   *
+   * @param lhs Left hand argument
+   * @param rhs Right hand argument
+   *
+   * @returns Dot product
+   */
+  static constexpr num_t dot(const ConstVector3D &lhs,
+                             const ConstVector3D &rhs) {
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+  }
+
+  /**
+   * @brief Cross product
+   *
+   * @param lhs Left hand argument
+   * @param rhs Right hand argument
+   *
+   * @returns Cross product
+   */
+  static constexpr ConstVector3D cross(const ConstVector3D &lhs,
+                                       const ConstVector3D &rhs) {
+    return ConstVector3D{lhs.y * rhs.z - lhs.z * rhs.y,
+                         lhs.z * rhs.x - lhs.x * rhs.z,
+                         lhs.x * rhs.y - lhs.y * rhs.x};
+  }
+
+  /**
+   * @brief Magnitude of a vector
+   *
+   * @param vec Vector
+   *
+   * @returns Magnitude
+   */
+  static constexpr num_t magn(const ConstVector3D &vec) {
+    return sqrt(dot(vec, vec));
+  }
+
+  /**
+   * @brief Normalizes a vector
+   *
+   * @note If the vector is zero, then results in undefined behavior.
+   *
+   * @param vec Vector
+   *
+   * @returns Unit vector in the same direction
+   */
+  static constexpr ConstVector3D normalize(const ConstVector3D &vec) {
+    return vec * (1 / magn(vec));
+  }
+
+  /**
+   * @brief Quaternion from a rotation around an axis
+   *
+   * Same as the rotation constructor of Quaternion.
+   *
+   * @param axis Axis to rotate around, which does not need to be normalized
+   * @param ang Angle to rotate by in radians
+   *
+   * @returns Rotation quaternion
+   */
+  static constexpr PackedQuaternion rotation(const ConstVector3D &axis,
+                                             const num_t ang) {
+    return fromParts(cos(ang / 2), axis * (sin(ang / 2) / magn(axis)));
+  }
+
+  /**
+   * @brief Hamilton product of two quaternions
+   *
+   * @param lhs Left hand argument
+   * @param rhs Right hand argument
+   *
+   * @returns Product
+   */
+  static constexpr PackedQuaternion product(const PackedQuaternion &lhs,
+                                            const PackedQuaternion &rhs) {
+    return PackedQuaternion{
+        lhs[0] * rhs[0] - lhs[1] * rhs[1] - lhs[2] * rhs[2] - lhs[3] * rhs[3],
+        lhs[0] * rhs[1] + lhs[1] * rhs[0] + lhs[2] * rhs[3] - lhs[3] * rhs[2],
+        lhs[0] * rhs[2] - lhs[1] * rhs[3] + lhs[2] * rhs[0] + lhs[3] * rhs[1],
+        lhs[0] * rhs[3] + lhs[1] * rhs[2] - lhs[2] * rhs[1] + lhs[3] * rhs[0]};
+  }
+
+  /**
+   * @brief Quaternion conjugate
+   *
+   * @param q Quaternion
+   *
+   * @returns Conjugate
+   */
+  static constexpr PackedQuaternion conj(const PackedQuaternion &q) {
+    return PackedQuaternion{q[0], -q[1], -q[2], -q[3]};
+  }
+
+  /**
+   * @brief Quaternion norm
+   *
+   * @param q Quaternion
+   *
+   * @returns Norm
+   */
+  static constexpr num_t norm(const PackedQuaternion &q) {
+    return sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+  }
+
+  /**
+   * @brief Equivalent unit quaternion
+   *
+   * @note If the quaternion is zero, then results in undefined behavior.
+   *
+   * @param q Quaternion
+   *
+   * @returns Unit quaternion
+   */
+  static constexpr PackedQuaternion unit(const PackedQuaternion &q) {
+    return scale(q, 1 / norm(q));
+  }
+
+  /**
+   * @brief Rotates a vector by a quaternion
+   *
+   * Same as Quaternion::rotate().
+   *
+   * @param q Rotation quaternion, which does not need to be normalized
+   * @param vec Vector to rotate
+   *
+   * @returns Rotated vector
+   */
+  static constexpr ConstVector3D rotate(const PackedQuaternion &q,
+                                        const ConstVector3D &vec) {
+    // ((w^2 - u.u) v + 2 (u.v) u + 2 w (u x v)) / |q|^2
+    return (vec * (q[0] * q[0] - dot(axisOf(q), axisOf(q))) +
+            axisOf(q) * (2 * dot(axisOf(q), vec)) +
+            cross(axisOf(q), vec) * (2 * q[0])) *
+           (1 / dot4(q, q));
+  }
+
+private:
+#ifdef IMUNANO33_FLOAT
+  static constexpr num_t PI = 3.14159265358979F;
+  static constexpr num_t MAX = FLT_MAX;
+#else
+  static constexpr num_t PI = 3.14159265358979323846;
+  static constexpr num_t MAX = DBL_MAX;
+#endif
+  static constexpr num_t BIG = 18446744073709551616.0; // 2^64
+  static constexpr num_t SQRT_BIG = 4294967296.0;      // 2^32
+
+  // starting at or above the root, Newton's method decreases until rounding
+  // stops it
+  static constexpr num_t sqrtNewton(const num_t num, const num_t guess) {
+    return sqrtNext(num, guess, (guess + num / guess) / 2);
+  }
+
+  static constexpr num_t sqrtNext(const num_t num, const num_t guess,
+                                  const num_t next) {
+    return next >= guess ? guess : sqrtNewton(num, next);
+  }
+
+  // angle in [-pi, pi]
+  static constexpr num_t wrap(const num_t ang) {
+    return ang - 2 * PI * static_cast<num_t>(static_cast<long long>(
+                              ang / (2 * PI) + (ang < 0 ? -0.5F : 0.5F)));
+  }
+
+  // Taylor series, adding terms until they no longer change the sum
+  static constexpr num_t sinSeries(const num_t angSq, const num_t term,
+                                   const num_t sum, const int n) {
+    return sum + term == sum
+               ? sum
+               : sinSeries(angSq, -term * angSq / ((2 * n) * (2 * n + 1)),
+                           sum + term, n + 1);
+  }
+
+  static constexpr num_t cosSeries(const num_t angSq, const num_t term,
+                                   const num_t sum, const int n) {
+    return sum + term == sum
+               ? sum
+               : cosSeries(angSq, -term * angSq / ((2 * n - 1) * (2 * n)),
+                           sum + term, n + 1);
+  }
+
+  static constexpr PackedQuaternion fromParts(const num_t w,
+                                              const ConstVector3D &vec) {
+    return PackedQuaternion{w, vec.x, vec.y, vec.z};
+  }
+
+  static constexpr ConstVector3D axisOf(const PackedQuaternion &q) {
+    return ConstVector3D{q[1], q[2], q[3]};
+  }
+
+  static constexpr num_t dot4(const PackedQuaternion &lhs,
+                              const PackedQuaternion &rhs) {
+    return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2] +
+           lhs[3] * rhs[3];
+  }
+
+  static constexpr PackedQuaternion scale(const PackedQuaternion &q,
+                                          const num_t k) {
+    return PackedQuaternion{q[0] * k, q[1] * k, q[2] * k, q[3] * k};
+  }
+};
+} // namespace imunano33
+
+#endif
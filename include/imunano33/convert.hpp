@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief File containing the imunano33::UnitConvert class
+ */
+
+#ifndef INCLUDE_IMUNANO33_CONVERT_HPP_
+#define INCLUDE_IMUNANO33_CONVERT_HPP_
+
+#include "imunano33/unit.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Static methods for converting between temperature and pressure units
+ *
+ * Every conversion is linear, so converting from one unit to another is a
+ * single multiply and add. The two constants are folded at compile time from
+ * the source and destination units, so the batch methods compile to a plain
+ * loop that the compiler can vectorize.
+ */
+class UnitConvert {
+public:
+  /**
+   * @brief Converts a temperature
+   *
+   * @tparam From Unit of value.
+   * @tparam To Unit to convert to.
+   *
+   * @param value Temperature in From
+   *
+   * @returns Temperature in To
+   */
+  template <TempUnit From, TempUnit To>
+  static constexpr num_t temp(const num_t value) {
+    return value * tempScale<From, To>() + tempOffset<From, To>();
+  }
+
+  /**
+   * @brief Converts an array of temperatures in place
+   *
+   * @tparam From Unit of the values.
+   * @tparam To Unit to convert to.
+   *
+   * @param values Temperatures in From, which are overwritten with
+   * temperatures in To
+   * @param count Number of values
+   */
+  template <TempUnit From, TempUnit To>
+  static void temp(num_t *values, const unsigned int count) {
+    if (From == To) {
+      return;
+    }
+
+    const num_t scale = tempScale<From, To>();
+    const num_t offset = tempOffset<From, To>();
+    for (unsigned int i = 0; i < count; i++) {
+      values[i] = values[i] * scale + offset;
+    }
+  }
+
+  /**
+   * @brief Converts a pressure
+   *
+   * @tparam From Unit of value.
+   * @tparam To Unit to convert to.
+   *
+   * @param value Pressure in From
+   *
+   * @returns Pressure in To
+   */
+  template <PressureUnit From, PressureUnit To>
+  static constexpr num_t pressure(const num_t value) {
+    return value * pressureScale<From, To>();
+  }
+
+  /**
+   * @brief Converts an array of pressures in place
+   *
+   * @tparam From Unit of the values.
+   * @tparam To Unit to convert to.
+   *
+   * @param values Pressures in From, which are overwritten with pressures in
+   * To
+   * @param count Number of values
+   */
+  template <PressureUnit From, PressureUnit To>
+  static void pressure(num_t *values, const unsigned int count) {
+    if (From == To) {
+      return;
+    }
+
+    const num_t scale = pressureScale<From, To>();
+    for (unsigned int i = 0; i < count; i++) {
+      values[i] *= scale;
+    }
+  }
+
+  /**
+   * @brief Gets the factor that temperature differences are multiplied by
+   *
+   * @tparam From Unit to convert from.
+   * @tparam To Unit to convert to.
+   *
+   * @returns Scale of To relative to From
+   */
+  template <TempUnit From, TempUnit To> static constexpr num_t tempScale() {
+    return perCelsius(To) / perCelsius(From);
+  }
+
+  /**
+   * @brief Gets the temperature in To of 0 in From
+   *
+   * @tparam From Unit to convert from.
+   * @tparam To Unit to convert to.
+   *
+   * @returns Offset of To relative to From
+   */
+  template <TempUnit From, TempUnit To> static constexpr num_t tempOffset() {
+    return zeroCelsius(To) - zeroCelsius(From) * tempScale<From, To>();
+  }
+
+  /**
+   * @brief Gets the factor that pressures are multiplied by
+   *
+   * @tparam From Unit to convert from.
+   * @tparam To Unit to convert to.
+   *
+   * @returns Scale of To relative to From
+   */
+  template <PressureUnit From, PressureUnit To>
+  static constexpr num_t pressureScale() {
+    return perKPa(To) / perKPa(From);
+  }
+
+private:
+  // size of one degree Celsius in unit
+  static constexpr num_t perCelsius(const TempUnit unit) {
+#ifdef IMUNANO33_FLOAT
+    return unit == FAHRENHEIT ? 1.8F : 1;
+#else
+    return unit == FAHRENHEIT ? 1.8 : 1;
+#endif
+  }
+
+  // 0 degrees Celsius in unit
+  static constexpr num_t zeroCelsius(const TempUnit unit) {
+#ifdef IMUNANO33_FLOAT
+    return unit == FAHRENHEIT ? 32 : unit == KELVIN ? 273.15F : 0;
+#else
+    return unit == FAHRENHEIT ? 32 : unit == KELVIN ? 273.15 : 0;
+#endif
+  }
+
+  // 1 kPa in unit
+  static constexpr num_t perKPa(const PressureUnit unit) {
+#ifdef IMUNANO33_FLOAT
+    return unit == ATM    ? 0.00986923266716F
+           : unit == MMHG ? 7.500617F
+           : unit == PSI  ? 0.1450377377F
+                          : 1;
+#else
+    return unit == ATM    ? 0.00986923266716
+           : unit == MMHG ? 7.500617
+           : unit == PSI  ? 0.1450377377
+                          : 1;
+#endif
+  }
+};
+} // namespace imunano33
+
+#endif
@@ -12,23 +12,43 @@
 #include <cmath>
 #endif
 
+#include "imunano33/instrument.hpp"
 #include "imunano33/mathutil.hpp"
 #include "imunano33/quaternion.hpp"
-#ifdef IMUNANO33_EMBED
-#include "imunano33/sv_embed.hpp"
-#else
-#include "imunano33/simplevectors.hpp"
-#endif
+#include "imunano33/stationary.hpp"
+#include "imunano33/trace.hpp"
 #include "imunano33/unit.hpp"
+#include "imunano33/vecops.hpp"
+#include "imunano33/vector.hpp"
 
-namespace imunano33 {
-#ifdef IMUNANO33_EMBED
-using Vector3D =
-    svector::EmbVec3D; //!< Alias to vector type in embedded systems
-#else
-using svector::Vector3D;
+#ifndef IMUNANO33_STATIONARY_WINDOW
+/**
+ * @brief Number of samples in each window of the stationary detector of
+ * imunano33::Filter
+ *
+ * Define this before including the library to change the size of the windows.
+ * The detector keeps this many gyro readings and this many accelerometer
+ * readings whether or not automatic calibration is on, which takes 24 bytes
+ * per sample with IMUNANO33_EMBED (48 bytes in double). The default of 32
+ * takes 844 of the 1040 bytes of a Filter on the Nano 33. Smaller windows save
+ * RAM, but average the bias over fewer readings.
+ */
+#define IMUNANO33_STATIONARY_WINDOW 32
 #endif
 
+namespace imunano33 {
+/**
+ * @brief An enumerator describing methods of integrating gyro readings
+ */
+enum GyroIntegrator {
+  FIRST_ORDER, //!< Rotates by the latest reading over the whole interval
+  MIDPOINT,    //!< Rotates by the average of the previous and latest readings
+  RK4,         //!< Fourth order Runge-Kutta, interpolating quadratically
+               //!< through the previous two and latest readings
+  CONING       //!< Rotation vector from the quadratic through the previous two
+               //!< and latest readings, with a coning correction
+};
+
 /**
  * @brief A complementary filter for a 6 axis IMU using quaternions.
  *
@@ -37,12 +57,22 @@ using svector::Vector3D;
  * the gyro measurements. The fraction is specified through the gyroFavoring
  * parameter in the constructor.
  *
+ * Optionally, the filter can also detect when the IMU is at rest (see
+ * setAutoCalibrate()). While at rest, the gyro bias is estimated from the
+ * resting gyro readings and subtracted from all later readings, and gyro
+ * integration is skipped because the IMU is not rotating.
+ *
  * The math and details are based on these lectures from Stanford:
  * * https://stanford.edu/class/ee267/notes/ee267_notes_imu.pdf
  * * https://stanford.edu/class/ee267/lectures/lecture10.pdf
  */
 class Filter {
 public:
+  /**
+   * @brief Stationary detector used for automatic gyro bias calibration
+   */
+  using Detector = StationaryDetector<IMUNANO33_STATIONARY_WINDOW>;
+
   /**
    * @brief Default Constructor
    *
@@ -66,7 +96,7 @@ public:
    * gravity correction.
    */
   Filter(const num_t gyroFavoring) : m_qRot{1, Vector3D{}} {
-#ifdef IMUNANO33_EMBED
+#ifdef IMUNANO33_FLOAT
     m_gyroFavoring = MathUtil::clamp(gyroFavoring, 0.0F, 1.0F);
 #else
     m_gyroFavoring = MathUtil::clamp(gyroFavoring, 0.0, 1.0);
@@ -91,7 +121,7 @@ public:
    */
   Filter(const num_t gyroFavoring, const Quaternion &initialQ)
       : m_qRot{initialQ.unit()} {
-#ifdef IMUNANO33_EMBED
+#ifdef IMUNANO33_FLOAT
     m_gyroFavoring = MathUtil::clamp(gyroFavoring, 0.0F, 1.0F);
 #else
     m_gyroFavoring = MathUtil::clamp(gyroFavoring, 0.0, 1.0);
@@ -126,6 +156,13 @@ public:
   /**
    * @brief Updates filter with gyro data.
    *
+   * The gyro reading is integrated with the integrator chosen with
+   * setIntegrator(). All integrators except imunano33::FIRST_ORDER also use
+   * previous gyro readings and assume that readings are roughly evenly spaced
+   * in time. Until enough readings have been given, they fall back to lower
+   * order integration. A zero reading is skipped by every integrator, and
+   * previous readings from before the IMU came to rest are not used.
+   *
    * @param gyro Gyroscope reading (in rad/s)
    * @param time The time it took for the reading to happen (in s)
    *
@@ -134,72 +171,150 @@ public:
    * is to the left, and the positive z axis is to the top.
    */
   void updateGyro(const Vector3D &gyro, const num_t time) {
+    IMUNANO33_TIME_CALL(GYRO_UPDATE_CALL);
+
     if (MathUtil::nearZero(gyro)) {
-      // if gyro reading is 0, then don't correct
+      // if gyro reading is 0, then don't correct, and leave it out of the
+      // bias estimate and the previous readings of the higher order
+      // integrators
+      IMUNANO33_COUNT_BRANCH(GYRO_SKIPPED);
       return;
     }
 
-    // otherwise integrate quaternion reading
-    const Quaternion qGyroDelta{normalize(gyro), time * magn(gyro)};
-    m_qRot *= qGyroDelta;
+    if (m_autoCalibrate) {
+      m_stationary.updateGyro(gyro);
+
+      if (m_stationary.isStationary()) {
+        // at rest, so the resting readings are purely bias and there is no
+        // rotation to integrate
+        m_gyroBias = m_stationary.getGyroMean();
+        m_numPrevGyro = 0;
+        IMUNANO33_COUNT_BRANCH(GYRO_STATIONARY);
+        return;
+      }
+    }
+
+    const Vector3D gyroCorr = gyro - m_gyroBias;
+
+    const Vector3D gyroPrev = m_numPrevGyro > 0 ? m_prevGyro : gyroCorr;
+    const Vector3D gyroPrev2 = m_numPrevGyro > 1 ? m_prevGyro2 : gyroPrev;
+    m_prevGyro2 = gyroPrev;
+    m_prevGyro = gyroCorr;
+    m_numPrevGyro = m_numPrevGyro < 2 ? m_numPrevGyro + 1 : 2;
+
+    switch (m_integrator) {
+    case MIDPOINT: {
+      const Quaternion qGyroDelta = Quaternion::fromRotVec(
+          linComb(gyroPrev, time / 2, gyroCorr, time / 2));
+      IMUNANO33_TRACE_GYRO(qGyroDelta, gyroCorr, time);
+      m_qRot *= qGyroDelta;
+      ++m_version;
+      break;
+    }
+    case CONING: {
+      // integral of the quadratic through the last three readings over the
+      // latest interval, plus the coning correction from Bortz's equation
+      const Vector3D rotVec = crossAdd(linComb(gyroPrev, time * 8 / 12,
+                                               gyroCorr, time * 5 / 12,
+                                               gyroPrev2, -time / 12),
+                                       gyroPrev, gyroCorr, time * time / 12);
+      const Quaternion qGyroDelta = Quaternion::fromRotVec(rotVec);
+      IMUNANO33_TRACE_GYRO(qGyroDelta, gyroCorr, time);
+      m_qRot *= qGyroDelta;
+      ++m_version;
+      break;
+    }
+    case RK4: {
+      const Quaternion qNext =
+          integrateRK4(m_qRot, gyroPrev2, gyroPrev, gyroCorr, time);
+      IMUNANO33_TRACE_GYRO(m_qRot.conj() * qNext, gyroCorr, time);
+      m_qRot = qNext;
+      ++m_version;
+      break;
+    }
+    default: {
+      if (MathUtil::nearZero(gyroCorr)) {
+        // a reading of only bias has no rotation, nor an axis to rotate about
+        return;
+      }
+
+      const Quaternion qGyroDelta{normalize(gyroCorr), time * magn(gyroCorr)};
+      IMUNANO33_TRACE_GYRO(qGyroDelta, gyroCorr, time);
+      m_qRot *= qGyroDelta;
+      ++m_version;
+    }
+    }
   }
 
   /**
    * @brief Updates filter with accelerometer data.
    *
+   * The reading is also rotated into the world frame to find the linear
+   * acceleration (see getLinearAccel()), and if velocity tracking is enabled,
+   * the linear acceleration is integrated into the velocity.
+   *
    * @param accel Accelerometer reading, in <x, y, z>, where positive z is up
    * (important for gravity corrections), and xy is translational motion. The
    * note comes with more details specific to the Arduino Nano 33.
+   * @param time The time since the previous accelerometer reading (in s). This
+   * is only used for velocity tracking, and velocity is not integrated if it is
+   * 0.
    *
    * @note With the opening of the USB port facing front and the Arduino's
    * sensors facing up, the positive x axis is to the front, the positive y axis
    * is to the left, and the positive z axis is to the top.
    */
-  void updateAccel(const Vector3D &accel) {
+  void updateAccel(const Vector3D &accel, const num_t time = 0) {
+    IMUNANO33_TIME_CALL(ACCEL_UPDATE_CALL);
+
     // don't bother with acceleration correction if acceleration is basically
     // 0
     if (MathUtil::nearZero(accel)) {
+      m_linearAccel = Vector3D{};
+      IMUNANO33_COUNT_BRANCH(ACCEL_SKIPPED);
       return;
     }
 
+    if (m_autoCalibrate) {
+      m_stationary.updateAccel(accel);
+    }
+
     // gravity vector rotation
-    const Quaternion qAccelBody{0, accel};
-    const Quaternion qAccelWorld =
-        m_qRot * qAccelBody *
-        m_qRot.conj(); // rotates body acceleration by gyro measurements
+    const Vector3D vecAccelWorld = m_qRot.rotate(
+        accel); // rotates body acceleration by gyro measurements
+
+    updateLinear(vecAccelWorld, time);
 
     // correcting gyro drift with accelerometer
-    const Vector3D vecAccelWorldNorm = normalize(qAccelWorld.vec());
-    const Vector3D vecAccelGravity{0, 0, -1};
-    const Vector3D vecRotAxis =
-        cross(vecAccelWorldNorm,
-              vecAccelGravity); // rotation axis for correction rotation from
-                                // estimated gravity vector (from gyro
-                                // readings) to true gravity vector
+    const Vector3D vecAccelWorldNorm = normalize(vecAccelWorld);
+    // the true gravity direction is {0, 0, -1}, so the rotation axis from the
+    // estimated gravity vector (from gyro readings) to it, cross(n, gravity),
+    // and the cosine of the angle between them, dot(gravity, n), reduce to
+    // components of n
+    const Vector3D vecRotAxis{-y(vecAccelWorldNorm), x(vecAccelWorldNorm), 0};
 
+    // angle to rotate to correct acceleration vector
 #ifdef IMUNANO33_EMBED
-    const num_t rotAngle = acosf(MathUtil::clamp(
-        dot(vecAccelGravity, vecAccelWorldNorm) /
-            (magn(vecAccelGravity) * magn(vecAccelWorldNorm)),
-        -1.0F,
-        1.0F)); // angle to rotate to correct acceleration vector
+    const num_t rotAngle =
+        acosf(MathUtil::clamp<num_t>(-z(vecAccelWorldNorm), -1, 1));
 #else
-    const num_t rotAngle = std::acos(
-        MathUtil::clamp(dot(vecAccelGravity, vecAccelWorldNorm) /
-                            (magn(vecAccelGravity) * magn(vecAccelWorldNorm)),
-                        -1.0,
-                        1.0)); // angle to rotate to correct acceleration vector
+    const num_t rotAngle =
+        std::acos(MathUtil::clamp<num_t>(-z(vecAccelWorldNorm), -1, 1));
 #endif
 
     // if the axis to rotate around is 0, then don't bother correcting
     if (MathUtil::nearZero(vecRotAxis)) {
+      IMUNANO33_COUNT_BRANCH(AXIS_DEGENERATE);
+      IMUNANO33_TRACE_ACCEL(Quaternion{}, vecRotAxis, rotAngle);
       return;
     }
 
     // complementary filter
     const Quaternion qAccelCur{normalize(vecRotAxis),
                                (1 - m_gyroFavoring) * rotAngle};
+    IMUNANO33_TRACE_ACCEL(qAccelCur, vecRotAxis, rotAngle);
     m_qRot = qAccelCur * m_qRot;
+    ++m_version;
   }
 
   /**
@@ -225,7 +340,7 @@ public:
     // https://stanford.edu/class/ee267/notes/ee267_notes_imu.pdf
 
     updateGyro(gyro, time);
-    updateAccel(accel);
+    updateAccel(accel, time);
   }
 
   /**
@@ -241,6 +356,16 @@ public:
    */
   Quaternion getRotQ() const { return m_qRot; }
 
+  /**
+   * @brief Gets version of the rotation quaternion
+   *
+   * The version changes every time the rotation quaternion changes, so
+   * anything derived from getRotQ() can be cached until the version changes.
+   *
+   * @returns Version number
+   */
+  unsigned long getVersion() const { return m_version; }
+
   /**
    * @brief Gets gyroscope favoring
    *
@@ -256,7 +381,10 @@ public:
    * @note If q is unnormalized, then this method will normalize it. If q is set
    * to be zeros, this will result in undefined behavior.
    */
-  void setRotQ(const Quaternion &q) { m_qRot = q.unit(); }
+  void setRotQ(const Quaternion &q) {
+    m_qRot = q.unit();
+    ++m_version;
+  }
 
   /**
    * @brief Sets gyro favoring
@@ -267,17 +395,308 @@ public:
    * or 1.
    */
   void setGyroFavoring(const num_t favoring) {
-#ifdef IMUNANO33_EMBED
+#ifdef IMUNANO33_FLOAT
     m_gyroFavoring = MathUtil::clamp(favoring, 0.0F, 1.0F);
 #else
     m_gyroFavoring = MathUtil::clamp(favoring, 0.0, 1.0);
 #endif
   }
 
+  /**
+   * @brief Enables or disables automatic gyro bias calibration
+   *
+   * When enabled, the filter keeps a window of recent gyro and accelerometer
+   * readings. Whenever both windows are steady, the IMU is treated as being at
+   * rest: the mean gyro reading becomes the new gyro bias, and gyro
+   * integration is skipped. Rest can only be detected if nonzero
+   * accelerometer readings are given.
+   *
+   * The gyro bias is kept when calibration is disabled.
+   *
+   * @param enabled Whether to calibrate automatically
+   */
+  void setAutoCalibrate(const bool enabled) {
+    if (enabled && !m_autoCalibrate) {
+      m_stationary.reset();
+    }
+    m_autoCalibrate = enabled;
+  }
+
+  /**
+   * @brief Determines if automatic gyro bias calibration is enabled
+   *
+   * @returns If automatic calibration is enabled
+   */
+  bool getAutoCalibrate() const { return m_autoCalibrate; }
+
+  /**
+   * @brief Determines if the IMU is currently at rest
+   *
+   * @returns If the IMU is at rest. This is always false if automatic
+   * calibration is disabled.
+   */
+  bool isStationary() const {
+    return m_autoCalibrate && m_stationary.isStationary();
+  }
+
+  /**
+   * @brief Gets the gyro bias subtracted from every gyro reading
+   *
+   * @returns Gyro bias, in rad/s
+   */
+  Vector3D getGyroBias() const { return m_gyroBias; }
+
+  /**
+   * @brief Sets the gyro bias subtracted from every gyro reading
+   *
+   * If automatic calibration is enabled, this is overwritten the next time
+   * the IMU is at rest.
+   *
+   * @param bias Gyro bias, in rad/s
+   */
+  void setGyroBias(const Vector3D &bias) { m_gyroBias = bias; }
+
+  /**
+   * @brief Gets linear acceleration in the world frame
+   *
+   * This is the latest accelerometer reading rotated into the world frame,
+   * with gravity removed. Positive z is up, so an upwards acceleration has a
+   * positive z component. It is in the same unit as the accelerometer
+   * readings.
+   *
+   * @returns Linear acceleration
+   */
+  Vector3D getLinearAccel() const { return m_linearAccel; }
+
+  /**
+   * @brief Gets velocity in the world frame
+   *
+   * This is only updated if velocity tracking is enabled, and its unit is the
+   * accelerometer unit multiplied by seconds.
+   *
+   * @returns Velocity
+   */
+  Vector3D getVelocity() const { return m_velocity; }
+
+  /**
+   * @brief Sets velocity to zero
+   */
+  void resetVelocity() { m_velocity = Vector3D{}; }
+
+  /**
+   * @brief Enables or disables velocity tracking
+   *
+   * When enabled, linear acceleration is integrated into a velocity on every
+   * accelerometer reading that comes with a time. Velocity from integrating
+   * acceleration drifts quickly, so the velocity is reset to zero whenever the
+   * IMU is detected to be at rest (see setAutoCalibrate()), and it can also be
+   * made to decay over time with setVelocityLeak().
+   *
+   * @param enabled Whether to track velocity
+   */
+  void setVelocityTracking(const bool enabled) {
+    if (!enabled) {
+      resetVelocity();
+    }
+    m_trackVelocity = enabled;
+  }
+
+  /**
+   * @brief Determines if velocity tracking is enabled
+   *
+   * @returns If velocity tracking is enabled
+   */
+  bool getVelocityTracking() const { return m_trackVelocity; }
+
+  /**
+   * @brief Sets how quickly the tracked velocity decays
+   *
+   * @param timeConstant Time, in s, for the velocity to decay to about 37% of
+   * its value without any acceleration. A value of 0 disables decay.
+   */
+  void setVelocityLeak(const num_t timeConstant) {
+    m_velocityLeak = timeConstant;
+  }
+
+  /**
+   * @brief Sets magnitude of gravity
+   *
+   * This should be in the same unit as the accelerometer readings, so 1 if the
+   * accelerometer measures in g. If automatic calibration is enabled, this is
+   * overwritten with the measured magnitude of gravity whenever the IMU is at
+   * rest.
+   *
+   * @param gravity Magnitude of gravity, 9.80665 by default
+   */
+  void setGravity(const num_t gravity) { m_gravity = gravity; }
+
+  /**
+   * @brief Gets magnitude of gravity
+   *
+   * @returns Magnitude of gravity, in the accelerometer unit
+   */
+  num_t getGravity() const { return m_gravity; }
+
+  /**
+   * @brief Sets the method used to integrate gyro readings
+   *
+   * Higher order integrators are more accurate when the angular velocity
+   * changes quickly relative to the sample rate, so they allow for a lower
+   * sample rate with the same accuracy.
+   *
+   * @param integrator Gyro integrator
+   */
+  void setIntegrator(const GyroIntegrator integrator) {
+    m_integrator = integrator;
+  }
+
+  /**
+   * @brief Gets the method used to integrate gyro readings
+   *
+   * @returns Gyro integrator
+   */
+  GyroIntegrator getIntegrator() const { return m_integrator; }
+
+  /**
+   * @brief Gets the stationary detector used for automatic calibration
+   *
+   * This can be used to tune the detector thresholds.
+   *
+   * @returns Stationary detector
+   */
+  Detector &stationaryDetector() { return m_stationary; }
+
 private:
   num_t m_gyroFavoring;
 
   Quaternion m_qRot;
+  unsigned long m_version{0};
+
+  GyroIntegrator m_integrator{FIRST_ORDER};
+  unsigned int m_numPrevGyro{0};
+  Vector3D m_prevGyro;
+  Vector3D m_prevGyro2;
+
+  bool m_autoCalibrate{false};
+  Vector3D m_gyroBias;
+  Detector m_stationary;
+
+#ifdef IMUNANO33_FLOAT
+  num_t m_gravity = 9.80665F;
+#else
+  num_t m_gravity = 9.80665;
+#endif
+  Vector3D m_linearAccel;
+  bool m_trackVelocity{false};
+  num_t m_velocityLeak = 0;
+  Vector3D m_velocity;
+
+  /**
+   * @brief Updates linear acceleration and velocity
+   *
+   * @param accelWorld Accelerometer reading in the world frame
+   * @param time Time since the previous accelerometer reading
+   */
+  void updateLinear(const Vector3D &accelWorld, const num_t time) {
+    const bool stationary = m_autoCalibrate && m_stationary.isStationary();
+    if (stationary) {
+      m_gravity = magn(m_stationary.getAccelMean());
+    }
+
+    // readings point along gravity at rest, so linear acceleration is what is
+    // left after taking the reading away from gravity
+    m_linearAccel =
+        Vector3D{-x(accelWorld), -y(accelWorld), -m_gravity - z(accelWorld)};
+
+    if (!m_trackVelocity) {
+      return;
+    }
+
+    if (stationary) {
+      // zero velocity update
+      m_velocity = Vector3D{};
+      return;
+    }
+
+    if (time <= 0) {
+      return;
+    }
+
+    addScaled(m_velocity, m_linearAccel, time);
+    if (m_velocityLeak > 0) {
+      m_velocity *= 1 - MathUtil::clamp(time / m_velocityLeak,
+                                        static_cast<num_t>(0),
+                                        static_cast<num_t>(1));
+    }
+  }
+
+  /**
+   * @brief Integrates q' = q * [0, w] / 2 with one step of RK4
+   *
+   * The angular velocity in the middle of the step is taken from the
+   * quadratic through the previous two readings and the latest reading.
+   *
+   * @param q Rotation quaternion at the start of the step
+   * @param wPrev Angular velocity one step before the start of the step
+   * @param w0 Angular velocity at the start of the step
+   * @param w1 Angular velocity at the end of the step
+   * @param h Step size
+   *
+   * @returns Unit rotation quaternion at the end of the step
+   */
+  static Quaternion integrateRK4(const Quaternion &q, const Vector3D &wPrev,
+                                 const Vector3D &w0, const Vector3D &w1,
+                                 const num_t h) {
+    const num_t q0[4] = {q.w(), x(q.vec()), y(q.vec()), z(q.vec())};
+    const Vector3D wMid =
+        linComb(w0, static_cast<num_t>(6) / 8, w1, static_cast<num_t>(3) / 8,
+                wPrev, static_cast<num_t>(-1) / 8);
+
+    num_t k1[4];
+    num_t k2[4];
+    num_t k3[4];
+    num_t k4[4];
+    num_t tmp[4];
+
+    derivative(q0, w0, k1);
+    step(q0, k1, h / 2, tmp);
+    derivative(tmp, wMid, k2);
+    step(q0, k2, h / 2, tmp);
+    derivative(tmp, wMid, k3);
+    step(q0, k3, h, tmp);
+    derivative(tmp, w1, k4);
+
+    num_t res[4];
+    for (unsigned int i = 0; i < 4; i++) {
+      res[i] = q0[i] + h / 6 * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+    }
+
+    return Quaternion{res[0], Vector3D{res[1], res[2], res[3]}}.unit();
+  }
+
+  /**
+   * @brief Computes q * [0, w] / 2, the derivative of the rotation quaternion
+   */
+  static void derivative(const num_t q[4], const Vector3D &w, num_t out[4]) {
+    const num_t wx = x(w);
+    const num_t wy = y(w);
+    const num_t wz = z(w);
+
+    out[0] = -(q[1] * wx + q[2] * wy + q[3] * wz) / 2;
+    out[1] = (q[0] * wx + q[2] * wz - q[3] * wy) / 2;
+    out[2] = (q[0] * wy + q[3] * wx - q[1] * wz) / 2;
+    out[3] = (q[0] * wz + q[1] * wy - q[2] * wx) / 2;
+  }
+
+  /**
+   * @brief Computes q + k * h
+   */
+  static void step(const num_t q[4], const num_t k[4], const num_t h,
+                   num_t out[4]) {
+    for (unsigned int i = 0; i < 4; i++) {
+      out[i] = q[i] + k[i] * h;
+    }
+  }
 };
 
 } // namespace imunano33
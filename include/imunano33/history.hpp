@@ -0,0 +1,398 @@
+/**
+ * @file
+ * @brief File containing the imunano33::OrientationHistory class
+ */
+
+#ifndef INCLUDE_IMUNANO33_HISTORY_HPP_
+#define INCLUDE_IMUNANO33_HISTORY_HPP_
+
+#ifndef IMUNANO33_EMBED
+#include <atomic>
+#endif
+
+#include "imunano33/packedquat.hpp"
+#include "imunano33/quaternion.hpp"
+#include "imunano33/unit.hpp"
+
+#ifndef IMUNANO33_ORIENTATION_HISTORY
+/**
+ * @brief Number of orientations kept by imunano33::IMUNano33
+ *
+ * Define this before including the library to change the size of the history.
+ * It must be a power of two.
+ */
+#define IMUNANO33_ORIENTATION_HISTORY 32
+#endif
+
+namespace imunano33 {
+/**
+ * @brief Fixed ring of timestamped orientations with lookup by time
+ *
+ * Keeps the last N orientations, as the components of a PackedQuaternion,
+ * with the time each was recorded. The orientation at any time between the
+ * oldest and newest entries is found with a binary search over the
+ * timestamps, then interpolated between the two neighbouring entries with
+ * nlerp() or slerp(). This is meant for
+ * aligning the orientation with data that arrives late, such as camera frames.
+ *
+ * Timestamps are whole microseconds, such as those from Arduino's micros(),
+ * so they keep their resolution however long the device runs. They may wrap
+ * around past the largest unsigned long, as long as the history spans less
+ * than half that range, which is over 35 minutes with a 32-bit unsigned long.
+ *
+ * Nothing is allocated after construction. One writer and any number of
+ * readers may use the history at the same time without locks: the writer
+ * marks each push with a sequence number, and a reader that overlapped a push
+ * discards what it read and retries. Every field is read and written as a
+ * relaxed atomic, so a reader that overlaps a push may see a mix of old and
+ * new values, but never a torn one, and the sequence check discards the mix.
+ *
+ * @note A reader that preempts the writer and waits for it, such as an
+ * interrupt handler that interrupts push(), never finishes. Read from the
+ * writer's context or a context the writer can preempt.
+ *
+ * @tparam N Number of orientations kept, which must be a power of two.
+ */
+template <unsigned int N> class OrientationHistory {
+public:
+  static_assert(N > 0 && (N & (N - 1)) == 0,
+                "History size must be a power of two");
+
+  /**
+   * @brief Default constructor
+   *
+   * Initializes an empty history.
+   */
+  OrientationHistory() = default;
+
+  /**
+   * @brief Copy constructor
+   *
+   * @note other must not be written to during the copy.
+   *
+   * @param other Other history
+   */
+  OrientationHistory(const OrientationHistory &other) { *this = other; }
+
+  /**
+   * @brief Assignment operator
+   *
+   * @note Neither history may be written to during the copy.
+   *
+   * @param other Other history
+   *
+   * @returns This history
+   */
+  OrientationHistory &operator=(const OrientationHistory &other) {
+    for (unsigned int i = 0; i < N; i++) {
+      storeRelaxed(m_times[i], loadRelaxed(other.m_times[i]));
+      copyRot(other.m_rots[i], m_rots[i]);
+    }
+    storeRelaxed(m_head, loadRelaxed(other.m_head));
+    storeRelaxed(m_size, loadRelaxed(other.m_size));
+    storeSeq(other.loadSeq());
+    return *this;
+  }
+
+  /**
+   * @brief Records an orientation
+   *
+   * If time equals the newest timestamp, the newest orientation is replaced,
+   * so several updates at the same time keep only the last. If time is before
+   * the newest timestamp, the history is cleared first, as the timestamps
+   * must not decrease. If the history is full, the oldest orientation is
+   * dropped.
+   *
+   * @param time Timestamp, in us
+   * @param q Orientation
+   */
+  void push(const unsigned long time, const Quaternion &q) {
+    const unsigned int seq = loadSeq();
+    storeSeq(seq + 1);
+    writeFence();
+
+    const unsigned int head = loadRelaxed(m_head);
+    unsigned int size = loadRelaxed(m_size);
+    // as the timestamps wrap around, a time more than half the range after
+    // the newest is before it
+    if (size > 0 && time - timeAt(head, size, size - 1) > ~0UL / 2) {
+      size = 0;
+    }
+
+    if (size > 0 && time == timeAt(head, size, size - 1)) {
+      storeRot(q, m_rots[slot(head, size, size - 1)]);
+    } else {
+      storeRelaxed(m_times[head], time);
+      storeRot(q, m_rots[head]);
+      storeRelaxed(m_head, (head + 1) & (N - 1));
+      if (size < N) {
+        ++size;
+      }
+    }
+    storeRelaxed(m_size, size);
+
+    publishSeq(seq + 2);
+  }
+
+  /**
+   * @brief Gets the orientation at a time with nlerp()
+   *
+   * @param time Timestamp, in us
+   * @param q Orientation at time, which is only written to if time is in the
+   * history
+   *
+   * @returns Whether time is between the oldest and newest timestamps
+   */
+  bool nlerpAt(const unsigned long time, Quaternion &q) const {
+    return interpAt(time, q, nlerp);
+  }
+
+  /**
+   * @brief Gets the orientation at a time with slerp()
+   *
+   * @param time Timestamp, in us
+   * @param q Orientation at time, which is only written to if time is in the
+   * history
+   *
+   * @returns Whether time is between the oldest and newest timestamps
+   */
+  bool slerpAt(const unsigned long time, Quaternion &q) const {
+    return interpAt(time, q, slerp);
+  }
+
+  /**
+   * @brief Gets the oldest and newest timestamps
+   *
+   * @param oldest Oldest timestamp, in us
+   * @param newest Newest timestamp, in us
+   *
+   * @returns Whether the history has any orientations, in which case oldest
+   * and newest are written to
+   */
+  bool getTimeRange(unsigned long &oldest, unsigned long &newest) const {
+    bool found = false;
+    unsigned int seq;
+    do {
+      seq = waitSeq();
+      const unsigned int head = loadRelaxed(m_head);
+      const unsigned int size = loadRelaxed(m_size);
+      found = size > 0;
+      if (found) {
+        oldest = timeAt(head, size, 0);
+        newest = timeAt(head, size, size - 1);
+      }
+    } while (!sameSeq(seq));
+
+    return found;
+  }
+
+  /**
+   * @brief Gets number of orientations in the history
+   *
+   * @returns Number of orientations, at most N
+   */
+  unsigned int size() const {
+    unsigned int size;
+    unsigned int seq;
+    do {
+      seq = waitSeq();
+      size = loadRelaxed(m_size);
+    } while (!sameSeq(seq));
+
+    return size;
+  }
+
+  /**
+   * @brief Gets maximum number of orientations
+   *
+   * @returns N
+   */
+  static constexpr unsigned int capacity() { return N; }
+
+  /**
+   * @brief Removes all orientations
+   */
+  void reset() {
+    const unsigned int seq = loadSeq();
+    storeSeq(seq + 1);
+    writeFence();
+    storeRelaxed(m_size, 0U);
+    publishSeq(seq + 2);
+  }
+
+private:
+#ifdef IMUNANO33_EMBED
+  template <typename T> using Atomic = T;
+#else
+  template <typename T> using Atomic = std::atomic<T>;
+#endif
+
+  // [w, x, y, z] rows rather than PackedQuaternion, whose 16-byte alignment
+  // would pad this class and every class holding it
+  Atomic<unsigned long> m_times[N] = {};
+  Atomic<num_t> m_rots[N][4] = {};
+  Atomic<unsigned int> m_head{0};
+  Atomic<unsigned int> m_size{0};
+  Atomic<unsigned int> m_seq{0}; // odd while a push is in progress
+
+  // ring index of the i-th oldest of size orientations ending before head
+  static unsigned int slot(const unsigned int head, const unsigned int size,
+                           const unsigned int i) {
+    return (head - size + i) & (N - 1);
+  }
+
+  unsigned long timeAt(const unsigned int head, const unsigned int size,
+                       const unsigned int i) const {
+    return loadRelaxed(m_times[slot(head, size, i)]);
+  }
+
+  static void copyRot(const Atomic<num_t> (&from)[4],
+                      Atomic<num_t> (&to)[4]) {
+    for (unsigned int i = 0; i < 4; i++) {
+      storeRelaxed(to[i], loadRelaxed(from[i]));
+    }
+  }
+
+  static void storeRot(const Quaternion &q, Atomic<num_t> (&row)[4]) {
+    const PackedQuaternion packed{q};
+    for (unsigned int i = 0; i < 4; i++) {
+      storeRelaxed(row[i], packed.data()[i]);
+    }
+  }
+
+  static PackedQuaternion loadRot(const Atomic<num_t> (&row)[4]) {
+    return PackedQuaternion{loadRelaxed(row[0]), loadRelaxed(row[1]),
+                            loadRelaxed(row[2]), loadRelaxed(row[3])};
+  }
+
+  template <typename Interp>
+  bool interpAt(const unsigned long time, Quaternion &q,
+                Interp interp) const {
+    bool found = false;
+    PackedQuaternion from;
+    PackedQuaternion to;
+    num_t t = 0;
+
+    unsigned int seq;
+    do {
+      seq = waitSeq();
+      const unsigned int head = loadRelaxed(m_head);
+      const unsigned int size = loadRelaxed(m_size);
+      if (size == 0) {
+        found = false;
+        continue;
+      }
+
+      // times are compared as offsets from the oldest, which do not wrap
+      const unsigned long oldest = timeAt(head, size, 0);
+      const unsigned long offset = time - oldest;
+      found = offset <= timeAt(head, size, size - 1) - oldest;
+      if (!found) {
+        continue;
+      }
+
+      // first entry at or after time
+      unsigned int lo = 0;
+      unsigned int hi = size - 1;
+      while (lo < hi) {
+        const unsigned int mid = lo + (hi - lo) / 2;
+        if (timeAt(head, size, mid) - oldest < offset) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+
+      const unsigned int toSlot = slot(head, size, lo);
+      const unsigned int fromSlot = lo > 0 ? slot(head, size, lo - 1) : toSlot;
+      to = loadRot(m_rots[toSlot]);
+      from = loadRot(m_rots[fromSlot]);
+      const unsigned long fromOffset = loadRelaxed(m_times[fromSlot]) - oldest;
+      const unsigned long toOffset = loadRelaxed(m_times[toSlot]) - oldest;
+      t = toOffset > fromOffset
+              ? static_cast<num_t>(offset - fromOffset) /
+                    static_cast<num_t>(toOffset - fromOffset)
+              : 1;
+    } while (!sameSeq(seq));
+
+    if (found) {
+      q = interp(from.toQuaternion(), to.toQuaternion(), t);
+    }
+    return found;
+  }
+
+#ifdef IMUNANO33_EMBED
+  unsigned int loadSeq() const {
+    return __atomic_load_n(&m_seq, __ATOMIC_ACQUIRE);
+  }
+
+  void storeSeq(const unsigned int seq) {
+    __atomic_store_n(&m_seq, seq, __ATOMIC_RELAXED);
+  }
+
+  void publishSeq(const unsigned int seq) {
+    __atomic_store_n(&m_seq, seq, __ATOMIC_RELEASE);
+  }
+
+  static void writeFence() { __atomic_thread_fence(__ATOMIC_RELEASE); }
+
+  static void readFence() { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+
+  // the generic builtins, as the _n ones take only integers and pointers
+  template <typename T> static T loadRelaxed(const T &from) {
+    T value;
+    __atomic_load(&from, &value, __ATOMIC_RELAXED);
+    return value;
+  }
+
+  template <typename T> static void storeRelaxed(T &to, T value) {
+    __atomic_store(&to, &value, __ATOMIC_RELAXED);
+  }
+#else
+  unsigned int loadSeq() const { return m_seq.load(std::memory_order_acquire); }
+
+  void storeSeq(const unsigned int seq) {
+    m_seq.store(seq, std::memory_order_relaxed);
+  }
+
+  void publishSeq(const unsigned int seq) {
+    m_seq.store(seq, std::memory_order_release);
+  }
+
+  static void writeFence() {
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  static void readFence() {
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+
+  template <typename T> static T loadRelaxed(const std::atomic<T> &from) {
+    return from.load(std::memory_order_relaxed);
+  }
+
+  template <typename T>
+  static void storeRelaxed(std::atomic<T> &to, const T value) {
+    to.store(value, std::memory_order_relaxed);
+  }
+#endif
+
+  // waits until no push is in progress, and returns the sequence number to
+  // check the read against
+  unsigned int waitSeq() const {
+    unsigned int seq = loadSeq();
+    while ((seq & 1) != 0) {
+      seq = loadSeq();
+    }
+    return seq;
+  }
+
+  // whether nothing was pushed since waitSeq() returned seq
+  bool sameSeq(const unsigned int seq) const {
+    readFence();
+    return loadRelaxed(m_seq) == seq;
+  }
+};
+} // namespace imunano33
+
+#endif
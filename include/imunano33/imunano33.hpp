@@ -30,24 +30,20 @@
 #ifndef INCLUDE_IMUNANO33_IMUNANO33_HPP_
 #define INCLUDE_IMUNANO33_IMUNANO33_HPP_
 
+#include "imunano33/altitude.hpp"
 #include "imunano33/climate.hpp"
 #include "imunano33/filter.hpp"
+#include "imunano33/history.hpp"
+#include "imunano33/instrument.hpp"
+#include "imunano33/mathutil.hpp"
+#include "imunano33/publish.hpp"
 #include "imunano33/quaternion.hpp"
-#ifdef IMUNANO33_EMBED
-#include "imunano33/sv_embed.hpp"
-#else
-#include "imunano33/simplevectors.hpp"
-#endif
+#include "imunano33/sensorinput.hpp"
+#include "imunano33/tempcomp.hpp"
 #include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
 
 namespace imunano33 {
-#ifdef IMUNANO33_EMBED
-using Vector3D =
-    svector::EmbVec3D; //!< Alias to vector type in embedded systems
-#else
-using svector::Vector3D;
-#endif
-
 /**
  * @brief A data processor for IMU and climate data from an Arduino Nano 33 BLE
  * Sense.
@@ -83,9 +79,26 @@ using svector::Vector3D;
  * to have an accelerometer ccorrect gyro measurements, pass a zero vector for
  * the accelerometer measurement so that there will be no correction. If you do
  * not know climate data, do not call updateClimate() and only call updateIMU().
+ *
+ * With IMUNANO33_EMBED, a processor takes about 3.8 KB of RAM, most of it in
+ * fixed windows and histories: the stationary detector of the filter (see
+ * IMUNANO33_STATIONARY_WINDOW), the climate history (see
+ * IMUNANO33_CLIMATE_HISTORY), and the orientation history (see
+ * IMUNANO33_ORIENTATION_HISTORY). Define smaller sizes to save RAM.
  */
 class IMUNano33 {
 public:
+  /**
+   * @brief Type of the temperature compensation for the gyroscope and
+   * accelerometer
+   */
+  using TempComp = TempCompensation<2>;
+
+  /**
+   * @brief Type of the orientation history
+   */
+  using RotHistory = OrientationHistory<IMUNANO33_ORIENTATION_HISTORY>;
+
   /**
    * @brief Default constructor
    *
@@ -165,10 +178,26 @@ public:
    * @param temperature Temperature, in C
    * @param humidity Relative humidity, in percent
    * @param pressure Pressure, in kPa
+   * @param deltaT The time between this measurement and the previous climate
+   * measurement, in seconds. If this is the first measurement, deltaT would
+   * refer to the time since startup. This advances getClimateTime(), which
+   * the climate history and publisher intervals use, so it can be left out if
+   * neither is used.
+   *
+   * @note The data is timestamped in the climate history with
+   * getClimateTime().
    */
   void updateClimate(const num_t temperature, const num_t humidity,
-                     const num_t pressure) {
-    m_climate.update(temperature, humidity, pressure);
+                     const num_t pressure, const num_t deltaT = 0) {
+    IMUNANO33_TIME_CALL(CLIMATE_UPDATE_CALL);
+
+    m_climateTime += deltaT;
+    m_climate.update(temperature, humidity, pressure, m_climateTime);
+    m_altitude.updatePressure(pressure);
+    m_gyroComp.setTemp(temperature);
+    m_accelComp.setTemp(temperature);
+    m_climateChanged =
+        m_publisher.update(temperature, humidity, pressure, m_climateTime);
   }
 
   /**
@@ -188,7 +217,13 @@ public:
    */
   void updateIMU(const Vector3D &accel, const Vector3D &gyro,
                  const num_t deltaT) {
-    m_filter.update(accel, gyro, deltaT);
+    IMUNANO33_TIME_CALL(IMU_UPDATE_CALL);
+
+    m_filter.update(compensate(m_accelComp, accel),
+                    compensate(m_gyroComp, gyro), deltaT);
+    advanceTime(deltaT);
+    updateAltitude(deltaT);
+    m_rotHistory.push(m_micros, m_filter.getRotQ());
   }
 
   /**
@@ -197,8 +232,14 @@ public:
    * @param accel Accelerometer reading, in <x, y, z>, where positive z is up
    * (important for gravity corrections), and xy is translational motion. The
    * note comes with more details specific to the Arduino Nano 33.
+   * @param deltaT The time between this measurement and the previous
+   * accelerometer measurement, in seconds. This is only needed for velocity
+   * tracking (see setVelocityTracking()) and altitude (see getAltitude()).
    */
-  void updateIMUAccel(const Vector3D &accel) { m_filter.updateAccel(accel); }
+  void updateIMUAccel(const Vector3D &accel, const num_t deltaT = 0) {
+    m_filter.updateAccel(compensate(m_accelComp, accel), deltaT);
+    updateAltitude(deltaT);
+  }
 
   /**
    * @brief Updates IMU gyroscope data.
@@ -213,7 +254,87 @@ public:
    * refer to the time since startup (when initialQ was measured).
    */
   void updateIMUGyro(const Vector3D &gyro, const num_t deltaT) {
-    m_filter.updateGyro(gyro, deltaT);
+    m_filter.updateGyro(compensate(m_gyroComp, gyro), deltaT);
+    advanceTime(deltaT);
+    m_rotHistory.push(m_micros, m_filter.getRotQ());
+  }
+
+  /**
+   * @brief Updates IMU data from raw sensor readings
+   *
+   * The readings are converted to the library's axes and units with the given
+   * SensorInput types, then passed to updateIMU().
+   *
+   * @tparam AccelInput SensorInput converting accelerometer readings.
+   * @tparam GyroInput SensorInput converting gyroscope readings, which must
+   * give rad/s.
+   *
+   * @param accel Raw accelerometer reading, as x, y, z
+   * @param gyro Raw gyroscope reading, as x, y, z
+   * @param deltaT The time between this measurement and the previous
+   * measurement, in seconds.
+   */
+  template <typename AccelInput, typename GyroInput, typename T>
+  void updateIMURaw(const T *accel, const T *gyro, const num_t deltaT) {
+    updateIMU(AccelInput::apply(accel[0], accel[1], accel[2]),
+              GyroInput::apply(gyro[0], gyro[1], gyro[2]), deltaT);
+  }
+
+  /**
+   * @brief Updates IMU data from a batch of raw sensor readings
+   *
+   * Each pair of readings is converted and passed to updateIMU() in order, such
+   * as for readings from a sensor FIFO sampled at a fixed rate.
+   *
+   * @tparam AccelInput SensorInput converting accelerometer readings.
+   * @tparam GyroInput SensorInput converting gyroscope readings, which must
+   * give rad/s.
+   *
+   * @param accel Raw accelerometer readings, as consecutive x, y, z triples
+   * @param gyro Raw gyroscope readings, as consecutive x, y, z triples
+   * @param count Number of readings in each array
+   * @param deltaT The time between consecutive readings, in seconds.
+   */
+  template <typename AccelInput, typename GyroInput, typename T>
+  void updateIMURaw(const T *accel, const T *gyro, const unsigned int count,
+                    const num_t deltaT) {
+    for (unsigned int i = 0; i < count; i++) {
+      updateIMURaw<AccelInput, GyroInput>(accel + 3 * i, gyro + 3 * i, deltaT);
+    }
+  }
+
+  /**
+   * @brief Updates IMU acceleration data from a raw sensor reading
+   *
+   * @tparam Input SensorInput converting the reading.
+   *
+   * @param rawX Raw accelerometer x reading
+   * @param rawY Raw accelerometer y reading
+   * @param rawZ Raw accelerometer z reading
+   * @param deltaT The time between this measurement and the previous
+   * accelerometer measurement, in seconds (see updateIMUAccel()).
+   */
+  template <typename Input, typename T>
+  void updateIMUAccelRaw(const T rawX, const T rawY, const T rawZ,
+                         const num_t deltaT = 0) {
+    updateIMUAccel(Input::apply(rawX, rawY, rawZ), deltaT);
+  }
+
+  /**
+   * @brief Updates IMU gyroscope data from a raw sensor reading
+   *
+   * @tparam Input SensorInput converting the reading, which must give rad/s.
+   *
+   * @param rawX Raw gyroscope x reading
+   * @param rawY Raw gyroscope y reading
+   * @param rawZ Raw gyroscope z reading
+   * @param deltaT The time between this measurement and the previous
+   * measurement, in seconds (see updateIMUGyro()).
+   */
+  template <typename Input, typename T>
+  void updateIMUGyroRaw(const T rawX, const T rawY, const T rawZ,
+                        const num_t deltaT) {
+    updateIMUGyro(Input::apply(rawX, rawY, rawZ), deltaT);
   }
 
   /**
@@ -241,7 +362,7 @@ public:
               const num_t temperature, const num_t humidity,
               const num_t pressure) {
     updateIMU(accel, gyro, deltaT);
-    updateClimate(temperature, humidity, pressure);
+    updateClimate(temperature, humidity, pressure, deltaT);
   }
 
   /**
@@ -249,36 +370,53 @@ public:
    * constructor.
    *
    * All measurements from this point on will be in the frame of reference of
-   * the initial quaternion.
+   * the initial quaternion. The orientation history is cleared.
    */
-  void resetIMU() { m_filter.setRotQ(m_initialQ); }
+  void resetIMU() {
+    m_filter.setRotQ(m_initialQ);
+    m_rotHistory.reset();
+  }
 
   /**
    * @brief Sets current IMU orientation to be facing the positive X-axis..
    *
    * All measurements from this point on will be relative to where you set the
-   * orientation to be the positive X-axis.
+   * orientation to be the positive X-axis. The orientation history is
+   * cleared.
    */
-  void zeroIMU() { m_filter.reset(); }
+  void zeroIMU() {
+    m_filter.reset();
+    m_rotHistory.reset();
+  }
 
   /**
    * @brief Resets climate data
    *
-   * climateDataExists() will be false after this is called.
+   * climateDataExists() will be false after this is called, and the altitude
+   * estimate restarts at the next climate update.
    */
-  void resetClimate() { m_climate.reset(); }
+  void resetClimate() {
+    m_climate.reset();
+    m_altitude.reset();
+    m_publisher.reset();
+    m_climateChanged = false;
+  }
 
   /**
    * @brief Sets rotation quaternion for the filter
    *
    * All measurements from this point on will be relative to this quaternion.
+   * The orientation history is cleared.
    *
    * @param q The rotation quaternion
    *
    * @note If q is unnormalized, then this method will normalize it. If q is set
    * to be zeros, this will result in undefined behavior.
    */
-  void setRotQ(const Quaternion &q) { m_filter.setRotQ(q); }
+  void setRotQ(const Quaternion &q) {
+    m_filter.setRotQ(q);
+    m_rotHistory.reset();
+  }
 
   /**
    * @brief Sets gyro favoring
@@ -295,6 +433,122 @@ public:
     m_filter.setGyroFavoring(favoring);
   }
 
+  /**
+   * @brief Enables or disables automatic gyro bias calibration
+   *
+   * When enabled, the IMU is detected to be at rest whenever recent gyro and
+   * accelerometer readings are steady. While at rest, the gyro bias is
+   * estimated and subtracted from all later gyro readings, so zeroIMU() does
+   * not need to be called to undo gyro drift after the IMU has been still.
+   *
+   * @param enabled Whether to calibrate automatically
+   */
+  void setAutoCalibrate(const bool enabled) {
+    m_filter.setAutoCalibrate(enabled);
+  }
+
+  /**
+   * @brief Sets the gyro bias subtracted from every gyro reading
+   *
+   * @param bias Gyro bias, in rad/s
+   */
+  void setGyroBias(const Vector3D &bias) { m_filter.setGyroBias(bias); }
+
+  /**
+   * @brief Enables or disables velocity tracking
+   *
+   * When enabled, the linear acceleration (see getLinearAccel()) is integrated
+   * into a velocity. The velocity is reset whenever the IMU is detected to be
+   * at rest, which requires automatic calibration (see setAutoCalibrate()).
+   *
+   * @param enabled Whether to track velocity
+   */
+  void setVelocityTracking(const bool enabled) {
+    m_filter.setVelocityTracking(enabled);
+  }
+
+  /**
+   * @brief Sets how quickly the tracked velocity decays
+   *
+   * @param timeConstant Time, in s, for the velocity to decay to about 37% of
+   * its value without any acceleration. A value of 0 disables decay.
+   */
+  void setVelocityLeak(const num_t timeConstant) {
+    m_filter.setVelocityLeak(timeConstant);
+  }
+
+  /**
+   * @brief Sets velocity to zero
+   */
+  void resetVelocity() { m_filter.resetVelocity(); }
+
+  /**
+   * @brief Sets magnitude of gravity
+   *
+   * This should be in the same unit as the accelerometer readings, so 1 if the
+   * accelerometer measures in g.
+   *
+   * @param gravity Magnitude of gravity, 9.80665 by default
+   */
+  void setGravity(const num_t gravity) { m_filter.setGravity(gravity); }
+
+  /**
+   * @brief Sets temperature compensation of the gyroscope
+   *
+   * Every gyro reading is corrected at the temperature of the latest climate
+   * update before it reaches the filter. Until the first climate update, the
+   * correction is at the reference temperature of comp. Zero readings, which
+   * the filter skips, are passed on unchanged.
+   *
+   * @param comp Temperature compensation, fit with TempComp::Calibrator
+   */
+  void setGyroTempComp(const TempComp &comp) {
+    m_gyroComp = comp;
+    if (m_climate.dataExists()) {
+      m_gyroComp.setTemp(m_climate.getTemp<CELSIUS>());
+    }
+  }
+
+  /**
+   * @brief Sets temperature compensation of the accelerometer
+   *
+   * Every accelerometer reading is corrected at the temperature of the latest
+   * climate update before it reaches the filter. Until the first climate
+   * update, the correction is at the reference temperature of comp. Zero
+   * readings, which the filter skips, are passed on unchanged.
+   *
+   * @param comp Temperature compensation, fit with TempComp::Calibrator
+   */
+  void setAccelTempComp(const TempComp &comp) {
+    m_accelComp = comp;
+    if (m_climate.dataExists()) {
+      m_accelComp.setTemp(m_climate.getTemp<CELSIUS>());
+    }
+  }
+
+  /**
+   * @brief Sets sea level pressure for the altitude estimate
+   *
+   * Setting this to the current pressure at a reference point makes the
+   * altitude relative to that point.
+   *
+   * @param seaLevel Sea level pressure, in kPa
+   */
+  void setSeaLevelPressure(const num_t seaLevel) {
+    m_altitude.setSeaLevelPressure(seaLevel);
+  }
+
+  /**
+   * @brief Sets how quickly the altitude estimate follows the barometer
+   *
+   * @param timeConstant Time constant, in s, 1 by default. Shorter time
+   * constants trust the barometer more, and longer time constants trust the
+   * accelerometer more.
+   */
+  void setAltitudeTimeConstant(const num_t timeConstant) {
+    m_altitude.setTimeConstant(timeConstant);
+  }
+
   /**
    * @brief Gets rotation quaternion of the complementary filter
    *
@@ -302,6 +556,68 @@ public:
    */
   Quaternion getRotQ() const { return m_filter.getRotQ(); }
 
+  /**
+   * @brief Gets orientation as Euler angles
+   *
+   * See Quaternion::toEuler() for the convention. The result is cached until
+   * the orientation changes, so repeated calls between updates are free.
+   *
+   * @returns <roll, pitch, yaw>, in radians
+   */
+  const Vector3D &getEuler() const {
+    if (!cacheValid(EULER)) {
+      m_cache.euler = m_filter.getRotQ().toEuler();
+      validate(EULER);
+    }
+    return m_cache.euler;
+  }
+
+  /**
+   * @brief Gets orientation as a rotation matrix
+   *
+   * The result is cached until the orientation changes, so repeated calls
+   * between updates are free.
+   *
+   * @returns Rotation matrix
+   */
+  const RotationMatrix &getRotMatrix() const {
+    if (!cacheValid(MATRIX)) {
+      m_cache.matrix = m_filter.getRotQ().toMatrix();
+      validate(MATRIX);
+    }
+    return m_cache.matrix;
+  }
+
+  /**
+   * @brief Gets orientation as an axis and angle
+   *
+   * The result is cached until the orientation changes, so repeated calls
+   * between updates are free.
+   *
+   * @returns Axis and angle of rotation
+   */
+  const AxisAngle &getAxisAngle() const {
+    if (!cacheValid(AXIS_ANGLE)) {
+      m_cache.axisAngle = m_filter.getRotQ().toAxisAngle();
+      validate(AXIS_ANGLE);
+    }
+    return m_cache.axisAngle;
+  }
+
+  /**
+   * @brief Gets temperature compensation of the gyroscope
+   *
+   * @returns Temperature compensation
+   */
+  const TempComp &getGyroTempComp() const { return m_gyroComp; }
+
+  /**
+   * @brief Gets temperature compensation of the accelerometer
+   *
+   * @returns Temperature compensation
+   */
+  const TempComp &getAccelTempComp() const { return m_accelComp; }
+
   /**
    * @brief Gets gyroscope favoring
    *
@@ -309,6 +625,49 @@ public:
    */
   num_t getGyroFavoring() const { return m_filter.getGyroFavoring(); }
 
+  /**
+   * @brief Gets the gyro bias subtracted from every gyro reading
+   *
+   * @returns Gyro bias, in rad/s
+   */
+  Vector3D getGyroBias() const { return m_filter.getGyroBias(); }
+
+  /**
+   * @brief Gets linear acceleration in the world frame
+   *
+   * This is the latest accelerometer reading rotated into the world frame,
+   * with gravity removed, in the same unit as the accelerometer readings.
+   * Positive z is up.
+   *
+   * @returns Linear acceleration
+   */
+  Vector3D getLinearAccel() const { return m_filter.getLinearAccel(); }
+
+  /**
+   * @brief Gets velocity in the world frame
+   *
+   * This is only updated if velocity tracking is enabled (see
+   * setVelocityTracking()).
+   *
+   * @returns Velocity, in the accelerometer unit multiplied by seconds
+   */
+  Vector3D getVelocity() const { return m_filter.getVelocity(); }
+
+  /**
+   * @brief Gets magnitude of gravity
+   *
+   * @returns Magnitude of gravity, in the accelerometer unit
+   */
+  num_t getGravity() const { return m_filter.getGravity(); }
+
+  /**
+   * @brief Determines if the IMU is currently at rest
+   *
+   * @returns If the IMU is at rest. This is always false if automatic
+   * calibration is disabled (see setAutoCalibrate()).
+   */
+  bool isStationary() const { return m_filter.isStationary(); }
+
   /**
    * @brief Gets temperature
    *
@@ -359,10 +718,192 @@ public:
    */
   bool climateDataExists() const { return m_climate.dataExists(); }
 
+  /**
+   * @brief Gets altitude
+   *
+   * The altitude blends the barometric altitude from the climate updates with
+   * the vertical linear acceleration from the IMU updates, so it is updated at
+   * the IMU rate. Check that the estimate exists with altitudeDataExists()
+   * first.
+   *
+   * @returns Altitude above sea level (see setSeaLevelPressure()), in m
+   */
+  num_t getAltitude() const { return m_altitude.getAltitude(); }
+
+  /**
+   * @brief Gets vertical speed
+   *
+   * @returns Vertical speed, in m/s, where positive is up
+   */
+  num_t getVerticalSpeed() const { return m_altitude.getVerticalSpeed(); }
+
+  /**
+   * @brief Determines if an altitude estimate exists
+   *
+   * @returns If there has been a climate update since construction or
+   * resetClimate().
+   */
+  bool altitudeDataExists() const { return m_altitude.dataExists(); }
+
+  /**
+   * @brief Determines if the latest climate update should be published
+   *
+   * This is decided by the climate publisher (see climatePublisher()), which by
+   * default publishes every changed reading. Climate updates are timestamped
+   * with getClimateTime().
+   *
+   * @returns If the latest climate update changed enough to publish. The
+   * values to publish are given by the publisher.
+   */
+  bool climateChanged() const { return m_climateChanged; }
+
+  /**
+   * @brief Gets the climate publisher
+   *
+   * This can be used to set the deadbands, smoothing, and intervals, and to
+   * get the smoothed values to publish.
+   *
+   * @returns Climate publisher
+   */
+  ClimatePublisher &climatePublisher() { return m_publisher; }
+
+  /**
+   * @brief Gets history of climate data
+   *
+   * The history holds the last IMUNANO33_CLIMATE_HISTORY climate updates,
+   * timestamped with getClimateTime(), along with their rolling mean, variance,
+   * minimum, and maximum.
+   *
+   * @returns Climate history
+   */
+  const Climate::History &getClimateHistory() const {
+    return m_climate.getHistory();
+  }
+
+  /**
+   * @brief Gets history of orientations
+   *
+   * The history holds the orientation (see getRotQ()) after each of the last
+   * IMUNANO33_ORIENTATION_HISTORY IMU updates, timestamped with getMicros(). An
+   * accelerometer update does not advance the time, so it adds no entry; its
+   * correction shows in the entry of the next gyroscope update. The history is
+   * cleared by resetIMU(), zeroIMU(), and setRotQ(). The history can be read
+   * from another thread while this processor is updated.
+   *
+   * @returns Orientation history
+   */
+  const RotHistory &getRotHistory() const { return m_rotHistory; }
+
+  /**
+   * @brief Gets time elapsed
+   *
+   * This is the sum of the deltaT arguments to updateIMU(), updateIMUGyro(),
+   * and update().
+   *
+   * @returns Time elapsed since construction, in s
+   */
+  num_t getTime() const { return m_time; }
+
+  /**
+   * @brief Gets time elapsed in whole microseconds
+   *
+   * This is the same sum as getTime(), but kept as an integer with the
+   * fraction of a microsecond carried to the next update, so it does not lose
+   * resolution as it grows the way a float sum of deltaT does. Like Arduino's
+   * micros(), it wraps around past the largest unsigned long.
+   *
+   * @returns Time elapsed since construction, in us
+   */
+  unsigned long getMicros() const { return m_micros; }
+
+  /**
+   * @brief Gets time elapsed according to climate updates
+   *
+   * This is the sum of the deltaT arguments to updateClimate() and update(),
+   * so it advances even if the IMU is never updated.
+   *
+   * @returns Time elapsed since construction, in s
+   */
+  num_t getClimateTime() const { return m_climateTime; }
+
 private:
+  /**
+   * @brief Orientation representations that are cached
+   */
+  enum CacheEntry { EULER = 1, MATRIX = 2, AXIS_ANGLE = 4 };
+
+  /**
+   * @brief Orientation representations derived from the filter
+   */
+  struct Cache {
+    unsigned long version{0}; // filter version the entries were computed at
+    unsigned int valid{0};    // bitmask of CacheEntry values
+    Vector3D euler;
+    RotationMatrix matrix{};
+    AxisAngle axisAngle{};
+  };
+
+  // a zero reading means there is no reading, which the offset of the
+  // compensation would turn into a real one
+  static Vector3D compensate(const TempComp &comp, const Vector3D &raw) {
+    return MathUtil::nearZero(raw) ? raw : comp.apply(raw);
+  }
+
+  void advanceTime(const num_t deltaT) {
+    m_time += deltaT;
+    if (deltaT <= 0) {
+      return;
+    }
+
+    const num_t micros = deltaT * 1000000 + m_microsFraction;
+    const auto whole = static_cast<unsigned long>(micros);
+    m_microsFraction = micros - static_cast<num_t>(whole);
+    m_micros += whole;
+  }
+
+  void updateAltitude(const num_t deltaT) {
+    if (deltaT <= 0 || !m_altitude.dataExists()) {
+      return;
+    }
+
+    // the altitude filter needs m/s^2, but the accelerometer can be in any
+    // unit as long as gravity is in the same unit
+#ifdef IMUNANO33_FLOAT
+    const num_t scale = 9.80665F / m_filter.getGravity();
+#else
+    const num_t scale = 9.80665 / m_filter.getGravity();
+#endif
+    m_altitude.updateAccel(z(m_filter.getLinearAccel()) * scale, deltaT);
+  }
+
+  bool cacheValid(const CacheEntry entry) const {
+    return m_cache.version == m_filter.getVersion() &&
+           (m_cache.valid & entry) != 0;
+  }
+
+  void validate(const CacheEntry entry) const {
+    if (m_cache.version != m_filter.getVersion()) {
+      m_cache.version = m_filter.getVersion();
+      m_cache.valid = 0;
+    }
+    m_cache.valid |= entry;
+  }
+
   Quaternion m_initialQ;
   Filter m_filter;
   Climate m_climate;
+  AltitudeEstimator m_altitude;
+  TempComp m_gyroComp;
+  TempComp m_accelComp;
+  ClimatePublisher m_publisher;
+  bool m_climateChanged{false};
+  num_t m_time = 0;
+  unsigned long m_micros = 0;
+  num_t m_microsFraction = 0; // part of a microsecond not yet in m_micros
+  num_t m_climateTime = 0;
+  RotHistory m_rotHistory;
+
+  mutable Cache m_cache;
 };
 } // namespace imunano33
 #endif
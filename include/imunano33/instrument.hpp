@@ -0,0 +1,208 @@
+/**
+ * @file
+ * @brief File containing the optional instrumentation of the update paths
+ *
+ * Instrumentation is only compiled in if IMUNANO33_INSTRUMENT is defined before
+ * including the library. Otherwise, IMUNANO33_TIME_CALL() and
+ * IMUNANO33_COUNT_BRANCH() expand to nothing, so there is no cost at all.
+ *
+ * When enabled, every instrumented call is timed into a histogram with
+ * power of two buckets, and the early return branches of the filter are
+ * counted. The statistics are shared by every object in the program, and can
+ * be read at any time with imunano33::Instrument::getStats(). They are not
+ * synchronized, so only update from one thread at a time.
+ *
+ * Times are in nanoseconds, read with IMUNANO33_INSTRUMENT_NOW(). On hosts,
+ * this defaults to std::chrono::steady_clock, and in embedded systems, to
+ * Arduino's micros(). Define it before including the library to use another
+ * clock.
+ */
+
+#ifndef INCLUDE_IMUNANO33_INSTRUMENT_HPP_
+#define INCLUDE_IMUNANO33_INSTRUMENT_HPP_
+
+#ifdef IMUNANO33_INSTRUMENT
+
+#ifndef IMUNANO33_EMBED
+#include <chrono>
+#endif
+
+#ifndef IMUNANO33_INSTRUMENT_NOW
+#ifdef IMUNANO33_EMBED
+/**
+ * @brief Current time in nanoseconds
+ */
+#define IMUNANO33_INSTRUMENT_NOW()                                             \
+  (static_cast<unsigned long long>(micros()) * 1000ULL)
+#else
+/**
+ * @brief Current time in nanoseconds
+ */
+#define IMUNANO33_INSTRUMENT_NOW()                                             \
+  static_cast<unsigned long long>(                                             \
+      std::chrono::duration_cast<std::chrono::nanoseconds>(                    \
+          std::chrono::steady_clock::now().time_since_epoch())                 \
+          .count())
+#endif
+#endif
+
+namespace imunano33 {
+/**
+ * @brief Instrumented calls
+ */
+enum InstrumentCall {
+  IMU_UPDATE_CALL,     //!< IMUNano33::updateIMU() and IMUNano33::update()
+  CLIMATE_UPDATE_CALL, //!< IMUNano33::updateClimate()
+  GYRO_UPDATE_CALL,    //!< Filter::updateGyro()
+  ACCEL_UPDATE_CALL,   //!< Filter::updateAccel()
+  NUM_INSTRUMENT_CALLS //!< Number of instrumented calls
+};
+
+/**
+ * @brief Counted branches
+ */
+enum InstrumentBranch {
+  GYRO_SKIPPED,          //!< Gyro reading was zero, so it was not integrated
+  GYRO_STATIONARY,       //!< IMU was at rest, so gyro integration was skipped
+  ACCEL_SKIPPED,         //!< Accelerometer reading was zero, so it was ignored
+  AXIS_DEGENERATE,       //!< Gravity was already aligned, so no correction
+  NUM_INSTRUMENT_BRANCHES //!< Number of counted branches
+};
+
+/**
+ * @brief Histogram of call durations
+ */
+struct LatencyHistogram {
+  /**
+   * @brief Number of buckets
+   *
+   * Bucket i counts durations in [2^i, 2^(i + 1)) ns, except that bucket 0
+   * also counts durations under 1 ns, and the last bucket counts every longer
+   * duration.
+   */
+  static constexpr unsigned int NUM_BUCKETS = 24;
+
+  unsigned long long buckets[NUM_BUCKETS]; //!< Count of calls in each bucket
+  unsigned long long count;                //!< Number of calls
+  unsigned long long totalNs;              //!< Sum of all durations, in ns
+  unsigned long long maxNs;                //!< Longest duration, in ns
+
+  /**
+   * @brief Adds a call duration
+   *
+   * @param ns Duration, in ns
+   */
+  void record(const unsigned long long ns) {
+    unsigned int bucket = 0;
+    while (bucket + 1 < NUM_BUCKETS && (ns >> (bucket + 1)) != 0) {
+      ++bucket;
+    }
+
+    ++buckets[bucket];
+    ++count;
+    totalNs += ns;
+    maxNs = ns > maxNs ? ns : maxNs;
+  }
+};
+
+/**
+ * @brief All instrumentation statistics
+ */
+struct InstrumentStats {
+  LatencyHistogram calls[NUM_INSTRUMENT_CALLS]; //!< Durations of each call
+  unsigned long long branches[NUM_INSTRUMENT_BRANCHES]; //!< Branch counts
+};
+
+/**
+ * @brief Access to the instrumentation statistics
+ */
+class Instrument {
+public:
+  /**
+   * @brief Gets the statistics
+   *
+   * @returns Statistics since the program started or reset() was called
+   */
+  static const InstrumentStats &getStats() { return stats(); }
+
+  /**
+   * @brief Sets all statistics to zero
+   */
+  static void reset() { stats() = InstrumentStats{}; }
+
+  /**
+   * @brief Records a call duration
+   *
+   * @param call Call that was timed
+   * @param ns Duration, in ns
+   */
+  static void recordCall(const InstrumentCall call,
+                         const unsigned long long ns) {
+    stats().calls[call].record(ns);
+  }
+
+  /**
+   * @brief Counts a branch
+   *
+   * @param branch Branch that was taken
+   */
+  static void countBranch(const InstrumentBranch branch) {
+    ++stats().branches[branch];
+  }
+
+private:
+  static InstrumentStats &stats() {
+    static InstrumentStats instance{};
+    return instance;
+  }
+};
+
+/**
+ * @brief Times a call from construction to destruction
+ */
+class ScopedCallTimer {
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param call Call to time
+   */
+  explicit ScopedCallTimer(const InstrumentCall call)
+      : m_call{call}, m_start{IMUNANO33_INSTRUMENT_NOW()} {}
+
+  /**
+   * @brief Destructor, which records the duration
+   */
+  ~ScopedCallTimer() {
+    Instrument::recordCall(m_call, IMUNANO33_INSTRUMENT_NOW() - m_start);
+  }
+
+  ScopedCallTimer(const ScopedCallTimer &) = delete;
+  ScopedCallTimer &operator=(const ScopedCallTimer &) = delete;
+
+private:
+  InstrumentCall m_call;
+  unsigned long long m_start;
+};
+} // namespace imunano33
+
+/**
+ * @brief Times the rest of the enclosing scope as the given InstrumentCall
+ */
+#define IMUNANO33_TIME_CALL(call)                                              \
+  const ::imunano33::ScopedCallTimer imunano33CallTimer_ { ::imunano33::call }
+
+/**
+ * @brief Counts the given InstrumentBranch
+ */
+#define IMUNANO33_COUNT_BRANCH(branch)                                         \
+  ::imunano33::Instrument::countBranch(::imunano33::branch)
+
+#else
+
+#define IMUNANO33_TIME_CALL(call) static_cast<void>(0)
+#define IMUNANO33_COUNT_BRANCH(branch) static_cast<void>(0)
+
+#endif
+
+#endif
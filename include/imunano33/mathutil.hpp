@@ -9,26 +9,22 @@
 #ifdef IMUNANO33_EMBED
 #include <float.h>
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 #else
-#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #endif
 
-#ifdef IMUNANO33_EMBED
-#include "imunano33/sv_embed.hpp"
-#else
-#include "imunano33/simplevectors.hpp"
-#endif
 #include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
 
 namespace imunano33 {
-#ifdef IMUNANO33_EMBED
-using Vector3D =
-    svector::EmbVec3D; //!< Alias to vector type in embedded systems
-#else
+#ifndef IMUNANO33_EMBED
 using std::fabs;
-using svector::Vector3D;
+using std::memcpy;
 #endif
 
 /**
@@ -81,13 +77,7 @@ public:
    * @returns if the vector is near zero
    */
   static bool nearZero(const Vector3D &vec, const num_t tol) {
-#ifdef IMUNANO33_EMBED
-    return fabs(vec.x) < tol && fabs(vec.y) < tol && fabs(vec.z) < tol;
-#else
-    return std::none_of(vec.begin(), vec.end(), [tol](const num_t &el) {
-      return std::fabs(el) >= tol;
-    });
-#endif
+    return fabs(x(vec)) < tol && fabs(y(vec)) < tol && fabs(z(vec)) < tol;
   }
 
   /**
@@ -138,10 +128,136 @@ public:
    *
    * @returns Clamped number
    */
-  template <typename T> static T clamp(const T &num, const T &lo, const T &hi) {
+  template <typename T>
+  static constexpr T clamp(const T &num, const T &lo, const T &hi) {
     return num < lo ? lo : num > hi ? hi : num;
   }
 
+  /**
+   * @brief Approximates the natural logarithm
+   *
+   * Splits num into its binary exponent and mantissa, then evaluates a short
+   * series for the logarithm of the mantissa, so there is no library call. The
+   * absolute error is below 1e-9 for doubles and within rounding error for
+   * floats.
+   *
+   * @param num Number to take the logarithm of
+   *
+   * @note num must be positive and normal (not denormal, infinite, or NaN).
+   *
+   * @returns ln(num)
+   */
+  static num_t fastLog(const num_t num) {
+#ifdef IMUNANO33_FLOAT
+    uint32_t bits;
+    memcpy(&bits, &num, sizeof(bits));
+    int expo = static_cast<int>((bits >> 23) & 0xff) - 127;
+    bits = (bits & 0x7fffff) | (UINT32_C(127) << 23);
+#else
+    uint64_t bits;
+    memcpy(&bits, &num, sizeof(bits));
+    int expo = static_cast<int>((bits >> 52) & 0x7ff) - 1023;
+    bits = (bits & UINT64_C(0xfffffffffffff)) | (UINT64_C(1023) << 52);
+#endif
+
+    // mantissa in [1, 2), moved to [sqrt(2) / 2, sqrt(2)) so the series below
+    // converges quickly
+    num_t mant;
+    memcpy(&mant, &bits, sizeof(mant));
+#ifdef IMUNANO33_FLOAT
+    if (mant > 1.41421356F) {
+      mant *= 0.5F;
+#else
+    if (mant > 1.4142135623730951) {
+      mant *= 0.5;
+#endif
+      ++expo;
+    }
+
+    // ln(m) = 2 atanh(s), where s = (m - 1) / (m + 1) and |s| < 0.172
+    const num_t s = (mant - 1) / (mant + 1);
+    const num_t s2 = s * s;
+#ifdef IMUNANO33_FLOAT
+    const num_t lnMant =
+        2 * s * (1 + s2 * (1.0F / 3 + s2 * (1.0F / 5 + s2 * (1.0F / 7))));
+    return static_cast<num_t>(expo) * 0.69314718F + lnMant;
+#else
+    const num_t lnMant =
+        2 * s *
+        (1 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7 + s2 * (1.0 / 9)))));
+    return static_cast<num_t>(expo) * 0.6931471805599453 + lnMant;
+#endif
+  }
+
+  /**
+   * @brief Approximates the exponential function
+   *
+   * Splits num into a power of two, which is built directly from its bits, and
+   * a small remainder, whose exponential is a short polynomial, so there is no
+   * library call. The relative error is below 1e-12 for doubles and within
+   * rounding error for floats.
+   *
+   * @param num Exponent
+   *
+   * @note num must be in [-700, 700] for doubles and [-87, 88] for floats, so
+   * that the result is finite and normal.
+   *
+   * @returns e^num
+   */
+  static num_t fastExp(const num_t num) {
+#ifdef IMUNANO33_FLOAT
+    const num_t twos = num * 1.44269504F;
+
+    // adding 1.5 * 2^23 rounds twos to the nearest integer without a branch
+    const num_t rounded = (twos + 12582912.0F) - 12582912.0F;
+    const num_t r = (twos - rounded) * 0.69314718F;
+
+    // |r| <= ln(2) / 2, so a degree 7 Taylor polynomial is enough. It is
+    // evaluated in pairs of terms (Estrin's scheme), which is a much shorter
+    // chain of dependent operations than Horner's method.
+    const num_t r2 = r * r;
+    const num_t terms01 = 1 + r;
+    const num_t terms23 = 1.0F / 2 + r * (1.0F / 6);
+    const num_t terms45 = 1.0F / 24 + r * (1.0F / 120);
+    const num_t terms67 = 1.0F / 720 + r * (1.0F / 5040);
+    const num_t expR = (terms01 + r2 * terms23) +
+                       r2 * r2 * (terms45 + r2 * terms67);
+
+    const uint32_t bits =
+        static_cast<uint32_t>(static_cast<int>(rounded) + 127) << 23;
+#else
+    const num_t twos = num * 1.4426950408889634;
+
+    // adding 1.5 * 2^52 rounds twos to the nearest integer without a branch
+    const num_t rounded = (twos + 6755399441055744.0) - 6755399441055744.0;
+    const num_t r = (twos - rounded) * 0.6931471805599453;
+
+    // |r| <= ln(2) / 2, so a degree 11 Taylor polynomial is enough. It is
+    // evaluated in pairs of terms (Estrin's scheme), which is a much shorter
+    // chain of dependent operations than Horner's method.
+    const num_t r2 = r * r;
+    const num_t r4 = r2 * r2;
+    const num_t terms01 = 1 + r;
+    const num_t terms23 = 1.0 / 2 + r * (1.0 / 6);
+    const num_t terms45 = 1.0 / 24 + r * (1.0 / 120);
+    const num_t terms67 = 1.0 / 720 + r * (1.0 / 5040);
+    const num_t terms89 = 1.0 / 40320 + r * (1.0 / 362880);
+    const num_t terms1011 = 1.0 / 3628800 + r * (1.0 / 39916800);
+    const num_t expR = (terms01 + r2 * terms23) +
+                       r4 * ((terms45 + r2 * terms67) +
+                             r4 * (terms89 + r2 * terms1011));
+
+    const uint64_t bits =
+        static_cast<uint64_t>(static_cast<int>(rounded) + 1023) << 52;
+#endif
+
+    // 2^rounded
+    num_t scale;
+    memcpy(&scale, &bits, sizeof(scale));
+
+    return expR * scale;
+  }
+
 private:
 #ifdef IMUNANO33_EMBED
   static constexpr num_t NEAR_ZERO = FLT_EPSILON;
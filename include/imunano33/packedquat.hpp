@@ -0,0 +1,274 @@
+/**
+ * @file
+ * @brief File containing the imunano33::PackedQuaternion class
+ */
+
+#ifndef INCLUDE_IMUNANO33_PACKEDQUAT_HPP_
+#define INCLUDE_IMUNANO33_PACKEDQUAT_HPP_
+
+#ifdef IMUNANO33_EMBED
+#include <math.h>
+#else
+#include <cmath>
+#endif
+
+#if !defined(IMUNANO33_EMBED) && !defined(IMUNANO33_FLOAT) &&                  \
+    !defined(IMUNANO33_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+/**
+ * @brief Defined if PackedQuaternion uses SSE2
+ *
+ * Define IMUNANO33_NO_SIMD before including the library to use the portable
+ * implementation instead.
+ */
+#define IMUNANO33_PACKED_SSE2
+#endif
+
+#include "imunano33/quaternion.hpp"
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+namespace imunano33 {
+#ifndef IMUNANO33_EMBED
+using std::sqrt;
+#endif
+
+/**
+ * @brief Quaternion stored as one aligned array of [w, x, y, z]
+ *
+ * Quaternion keeps its vector part in a separate vector object, which is
+ * convenient but not contiguous. This stores the four components together,
+ * 16-byte aligned, so it is smaller and can be loaded straight into SIMD
+ * registers. It is meant as the storage for large arrays and histories of
+ * orientations, converting to and from Quaternion at the edges.
+ *
+ * With SSE2 (on x86-64 hosts), the Hamilton product, conjugate, norm, and
+ * unit() are computed two components at a time. Otherwise, the same
+ * operations are plain loops over the array.
+ *
+ * The class is a literal type, so constants can be built at compile time with
+ * the functions in ConstMath.
+ */
+class alignas(16) PackedQuaternion {
+public:
+  /**
+   * @brief Default constructor
+   *
+   * Initializes quaternion to [1, 0, 0, 0]
+   */
+  constexpr PackedQuaternion() : m_q{1, 0, 0, 0} {}
+
+  /**
+   * @brief Constructor from components
+   *
+   * @param w The scalar component
+   * @param x The x component
+   * @param y The y component
+   * @param z The z component
+   */
+  constexpr PackedQuaternion(const num_t w, const num_t x, const num_t y,
+                             const num_t z)
+      : m_q{w, x, y, z} {}
+
+  /**
+   * @brief Constructor from a Quaternion
+   *
+   * @param q Quaternion to copy
+   */
+  explicit PackedQuaternion(const Quaternion &q) {
+    const Vector3D vec = q.vec();
+    m_q[0] = q.w();
+    m_q[1] = x(vec);
+    m_q[2] = y(vec);
+    m_q[3] = z(vec);
+  }
+
+  /**
+   * @brief Converts to a Quaternion
+   *
+   * @returns Quaternion with the same components
+   */
+  Quaternion toQuaternion() const {
+    return Quaternion{m_q[0], Vector3D{m_q[1], m_q[2], m_q[3]}};
+  }
+
+  /**
+   * @brief Gets the scalar component
+   *
+   * @returns w
+   */
+  constexpr num_t w() const { return m_q[0]; }
+
+  /**
+   * @brief Gets a component
+   *
+   * @param i Index of the component, where 0 is w, 1 is x, 2 is y, and 3 is z
+   *
+   * @returns Component
+   */
+  constexpr num_t operator[](const unsigned int i) const { return m_q[i]; }
+
+  /**
+   * @brief Gets all components
+   *
+   * @returns Pointer to [w, x, y, z], which is 16-byte aligned
+   */
+  constexpr const num_t *data() const { return m_q; }
+
+  /**
+   * @brief Gets the quaternion conjugate
+   *
+   * @returns The quaternion conjugate
+   */
+  PackedQuaternion conj() const {
+    PackedQuaternion res;
+#ifdef IMUNANO33_PACKED_SSE2
+    const __m128d signLo = _mm_set_pd(-0.0, 0.0);
+    const __m128d signHi = _mm_set_pd(-0.0, -0.0);
+    _mm_store_pd(res.m_q, _mm_xor_pd(_mm_load_pd(m_q), signLo));
+    _mm_store_pd(res.m_q + 2, _mm_xor_pd(_mm_load_pd(m_q + 2), signHi));
+#else
+    res.m_q[0] = m_q[0];
+    for (unsigned int i = 1; i < 4; i++) {
+      res.m_q[i] = -m_q[i];
+    }
+#endif
+    return res;
+  }
+
+  /**
+   * @brief Gets quaternion norm
+   *
+   * @returns Quaternion norm
+   */
+  num_t norm() const { return sqrt(normSq()); }
+
+  /**
+   * @brief Gets equivalent unit quaternion
+   *
+   * @note If the quaternion is zero, then results in undefined behavior.
+   *
+   * @returns Equivalent unit quaternion
+   */
+  PackedQuaternion unit() const {
+    const num_t inv = 1 / norm();
+    PackedQuaternion res;
+#ifdef IMUNANO33_PACKED_SSE2
+    const __m128d scale = _mm_set1_pd(inv);
+    _mm_store_pd(res.m_q, _mm_mul_pd(_mm_load_pd(m_q), scale));
+    _mm_store_pd(res.m_q + 2, _mm_mul_pd(_mm_load_pd(m_q + 2), scale));
+#else
+    for (unsigned int i = 0; i < 4; i++) {
+      res.m_q[i] = m_q[i] * inv;
+    }
+#endif
+    return res;
+  }
+
+  /**
+   * @brief Hamilton product of two quaternions
+   *
+   * @param lhs Left hand argument
+   * @param rhs Right hand argument
+   *
+   * @returns Product
+   */
+  friend PackedQuaternion operator*(const PackedQuaternion &lhs,
+                                    const PackedQuaternion &rhs) {
+    PackedQuaternion res;
+#ifdef IMUNANO33_PACKED_SSE2
+    // the product is lw * [rw, rx, ry, rz] + lx * [-rx, rw, -rz, ry]
+    // + ly * [-ry, rz, rw, -rx] + lz * [-rz, -ry, rx, rw], with each
+    // quaternion held as the pairs [w, x] and [y, z]
+    const __m128d lo = _mm_load_pd(rhs.m_q);
+    const __m128d hi = _mm_load_pd(rhs.m_q + 2);
+    const __m128d loSwap = _mm_shuffle_pd(lo, lo, 1);
+    const __m128d hiSwap = _mm_shuffle_pd(hi, hi, 1);
+    const __m128d negFirst = _mm_set_pd(0.0, -0.0);
+    const __m128d negSecond = _mm_set_pd(-0.0, 0.0);
+    const __m128d negBoth = _mm_set1_pd(-0.0);
+
+    const __m128d lw = _mm_set1_pd(lhs.m_q[0]);
+    const __m128d lx = _mm_set1_pd(lhs.m_q[1]);
+    const __m128d ly = _mm_set1_pd(lhs.m_q[2]);
+    const __m128d lz = _mm_set1_pd(lhs.m_q[3]);
+
+    __m128d resLo = _mm_mul_pd(lw, lo);
+    __m128d resHi = _mm_mul_pd(lw, hi);
+    resLo = _mm_add_pd(resLo, _mm_mul_pd(lx, _mm_xor_pd(loSwap, negFirst)));
+    resHi = _mm_add_pd(resHi, _mm_mul_pd(lx, _mm_xor_pd(hiSwap, negFirst)));
+    resLo = _mm_add_pd(resLo, _mm_mul_pd(ly, _mm_xor_pd(hi, negFirst)));
+    resHi = _mm_add_pd(resHi, _mm_mul_pd(ly, _mm_xor_pd(lo, negSecond)));
+    resLo = _mm_add_pd(resLo, _mm_mul_pd(lz, _mm_xor_pd(hiSwap, negBoth)));
+    resHi = _mm_add_pd(resHi, _mm_mul_pd(lz, loSwap));
+
+    _mm_store_pd(res.m_q, resLo);
+    _mm_store_pd(res.m_q + 2, resHi);
+#else
+    const num_t *l = lhs.m_q;
+    const num_t *r = rhs.m_q;
+    res.m_q[0] = l[0] * r[0] - l[1] * r[1] - l[2] * r[2] - l[3] * r[3];
+    res.m_q[1] = l[0] * r[1] + l[1] * r[0] + l[2] * r[3] - l[3] * r[2];
+    res.m_q[2] = l[0] * r[2] - l[1] * r[3] + l[2] * r[0] + l[3] * r[1];
+    res.m_q[3] = l[0] * r[3] + l[1] * r[2] - l[2] * r[1] + l[3] * r[0];
+#endif
+    return res;
+  }
+
+  /**
+   * @brief Multiplies a quaternion in place
+   *
+   * @param other Right hand argument
+   *
+   * @returns Quaternion multiplied in place
+   */
+  PackedQuaternion &operator*=(const PackedQuaternion &other) {
+    *this = (*this) * other;
+    return *this;
+  }
+
+  /**
+   * @brief Equality of two quaternions
+   *
+   * @param lhs Left hand argument
+   * @param rhs Right hand argument
+   *
+   * @returns Whether every component is equal
+   */
+  friend bool operator==(const PackedQuaternion &lhs,
+                         const PackedQuaternion &rhs) {
+    return lhs.m_q[0] == rhs.m_q[0] && lhs.m_q[1] == rhs.m_q[1] &&
+           lhs.m_q[2] == rhs.m_q[2] && lhs.m_q[3] == rhs.m_q[3];
+  }
+
+  /**
+   * @brief Inequality of two quaternions
+   *
+   * @param lhs Left hand argument
+   * @param rhs Right hand argument
+   *
+   * @returns Whether any component differs
+   */
+  friend bool operator!=(const PackedQuaternion &lhs,
+                         const PackedQuaternion &rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  num_t m_q[4];
+
+  num_t normSq() const {
+#ifdef IMUNANO33_PACKED_SSE2
+    const __m128d lo = _mm_load_pd(m_q);
+    const __m128d hi = _mm_load_pd(m_q + 2);
+    const __m128d sq = _mm_add_pd(_mm_mul_pd(lo, lo), _mm_mul_pd(hi, hi));
+    return _mm_cvtsd_f64(_mm_add_sd(sq, _mm_unpackhi_pd(sq, sq)));
+#else
+    return m_q[0] * m_q[0] + m_q[1] * m_q[1] + m_q[2] * m_q[2] +
+           m_q[3] * m_q[3];
+#endif
+  }
+};
+} // namespace imunano33
+
+#endif
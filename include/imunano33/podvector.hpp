@@ -0,0 +1,313 @@
+/**
+ * @file
+ * @brief File containing the imunano33::PodVec3D vector type
+ */
+
+#ifndef INCLUDE_IMUNANO33_PODVECTOR_HPP_
+#define INCLUDE_IMUNANO33_PODVECTOR_HPP_
+
+#include <math.h> // sqrt, sqrtf
+
+#include "imunano33/unit.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Plain 3D vector of num_t
+ *
+ * Has the same members and free functions as svector::EmbVec3D, but in the
+ * precision of num_t, and without a virtual destructor. It is trivially
+ * copyable, so copies are three loads and stores rather than a call through
+ * svector::Vector3D's iterators, and the compiler can keep it in registers.
+ *
+ * The library uses this as its vector type if IMUNANO33_POD_VECTORS is
+ * defined.
+ */
+struct PodVec3D {
+  /**
+   * @brief Default constructor
+   *
+   * Initializes a zero vector.
+   */
+  constexpr PodVec3D() : x{0}, y{0}, z{0} {}
+
+  /**
+   * @brief Initializes a vector given xyz components
+   *
+   * @param xOther The x-component
+   * @param yOther The y-component
+   * @param zOther The z-component
+   */
+  constexpr PodVec3D(const num_t xOther, const num_t yOther,
+                     const num_t zOther)
+      : x{xOther}, y{yOther}, z{zOther} {}
+
+  /**
+   * @brief In-place addition
+   *
+   * @param other Vector to add
+   *
+   * @returns This vector
+   */
+  PodVec3D &operator+=(const PodVec3D &other) {
+    x += other.x;
+    y += other.y;
+    z += other.z;
+    return *this;
+  }
+
+  /**
+   * @brief In-place subtraction
+   *
+   * @param other Vector to subtract
+   *
+   * @returns This vector
+   */
+  PodVec3D &operator-=(const PodVec3D &other) {
+    x -= other.x;
+    y -= other.y;
+    z -= other.z;
+    return *this;
+  }
+
+  /**
+   * @brief In-place scalar multiplication
+   *
+   * @param other Number to multiply by
+   *
+   * @returns This vector
+   */
+  PodVec3D &operator*=(const num_t other) {
+    x *= other;
+    y *= other;
+    z *= other;
+    return *this;
+  }
+
+  /**
+   * @brief In-place scalar division
+   *
+   * @param other Number to divide by
+   *
+   * @returns This vector
+   */
+  PodVec3D &operator/=(const num_t other) {
+    x /= other;
+    y /= other;
+    z /= other;
+    return *this;
+  }
+
+  num_t x; //!< The x-component
+  num_t y; //!< The y-component
+  num_t z; //!< The z-component
+};
+
+/**
+ * @brief Gets the x-component of a vector
+ *
+ * @param v A vector
+ *
+ * @returns x-component of the vector
+ */
+constexpr num_t x(const PodVec3D &v) { return v.x; }
+
+/**
+ * @brief Sets the x-component of a vector
+ *
+ * @param v A vector
+ * @param xValue The x-value to set to the vector
+ */
+inline void x(PodVec3D &v, const num_t xValue) { v.x = xValue; }
+
+/**
+ * @brief Gets the y-component of a vector
+ *
+ * @param v A vector
+ *
+ * @returns y-component of the vector
+ */
+constexpr num_t y(const PodVec3D &v) { return v.y; }
+
+/**
+ * @brief Sets the y-component of a vector
+ *
+ * @param v A vector
+ * @param yValue The y-value to set to the vector
+ */
+inline void y(PodVec3D &v, const num_t yValue) { v.y = yValue; }
+
+/**
+ * @brief Gets the z-component of a vector
+ *
+ * @param v A vector
+ *
+ * @returns z-component of the vector
+ */
+constexpr num_t z(const PodVec3D &v) { return v.z; }
+
+/**
+ * @brief Sets the z-component of a vector
+ *
+ * @param v A vector
+ * @param zValue The z-value to set to the vector
+ */
+inline void z(PodVec3D &v, const num_t zValue) { v.z = zValue; }
+
+/**
+ * @brief Vector addition
+ *
+ * @param lhs The first vector
+ * @param rhs The second vector
+ *
+ * @returns lhs + rhs
+ */
+constexpr PodVec3D operator+(const PodVec3D &lhs, const PodVec3D &rhs) {
+  return PodVec3D{lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+}
+
+/**
+ * @brief Vector subtraction
+ *
+ * @param lhs The first vector
+ * @param rhs The second vector
+ *
+ * @returns lhs - rhs
+ */
+constexpr PodVec3D operator-(const PodVec3D &lhs, const PodVec3D &rhs) {
+  return PodVec3D{lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+}
+
+/**
+ * @brief Negative of a vector
+ *
+ * @param vec A vector
+ *
+ * @returns The vector in the opposite direction
+ */
+constexpr PodVec3D operator-(const PodVec3D &vec) {
+  return PodVec3D{-vec.x, -vec.y, -vec.z};
+}
+
+/**
+ * @brief Positive of a vector
+ *
+ * @param vec A vector
+ *
+ * @returns The same vector
+ */
+constexpr PodVec3D operator+(const PodVec3D &vec) {
+  return PodVec3D{+vec.x, +vec.y, +vec.z};
+}
+
+/**
+ * @brief Scalar multiplication
+ *
+ * @param lhs A vector
+ * @param rhs Number to multiply by
+ *
+ * @returns lhs * rhs
+ */
+constexpr PodVec3D operator*(const PodVec3D &lhs, const num_t rhs) {
+  return PodVec3D{lhs.x * rhs, lhs.y * rhs, lhs.z * rhs};
+}
+
+/**
+ * @brief Scalar division
+ *
+ * @param lhs A vector
+ * @param rhs Number to divide by
+ *
+ * @returns lhs / rhs
+ */
+constexpr PodVec3D operator/(const PodVec3D &lhs, const num_t rhs) {
+  return PodVec3D{lhs.x / rhs, lhs.y / rhs, lhs.z / rhs};
+}
+
+/**
+ * @brief Compares equality of two vectors
+ *
+ * @param lhs The first vector
+ * @param rhs The second vector
+ *
+ * @returns Whether all components are equal
+ */
+constexpr bool operator==(const PodVec3D &lhs, const PodVec3D &rhs) {
+  return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+}
+
+/**
+ * @brief Compares inequality of two vectors
+ *
+ * @param lhs The first vector
+ * @param rhs The second vector
+ *
+ * @returns Whether any component differs
+ */
+constexpr bool operator!=(const PodVec3D &lhs, const PodVec3D &rhs) {
+  return !(lhs == rhs);
+}
+
+/**
+ * @brief Calculates the dot product of two vectors
+ *
+ * @param lhs The first vector
+ * @param rhs The second vector
+ *
+ * @returns The dot product of lhs and rhs
+ */
+constexpr num_t dot(const PodVec3D &lhs, const PodVec3D &rhs) {
+  return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+/**
+ * @brief Calculates the cross product of two vectors
+ *
+ * @param lhs The first vector
+ * @param rhs The second vector
+ *
+ * @returns The cross product of lhs and rhs
+ */
+constexpr PodVec3D cross(const PodVec3D &lhs, const PodVec3D &rhs) {
+  return PodVec3D{lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z,
+                  lhs.x * rhs.y - lhs.y * rhs.x};
+}
+
+/**
+ * @brief Gets the magnitude of a vector
+ *
+ * @param vec A vector
+ *
+ * @returns Magnitude of the vector
+ */
+inline num_t magn(const PodVec3D &vec) {
+#ifdef IMUNANO33_FLOAT
+  return sqrtf(dot(vec, vec));
+#else
+  return sqrt(dot(vec, vec));
+#endif
+}
+
+/**
+ * @brief Normalizes a vector
+ *
+ * @note The result is undefined for a zero vector.
+ *
+ * @param vec A vector
+ *
+ * @returns Unit vector in the direction of vec
+ */
+inline PodVec3D normalize(const PodVec3D &vec) { return vec / magn(vec); }
+
+/**
+ * @brief Determines whether a vector is a zero vector
+ *
+ * @param vec A vector
+ *
+ * @returns Whether all components are zero
+ */
+constexpr bool isZero(const PodVec3D &vec) {
+  return vec.x == 0 && vec.y == 0 && vec.z == 0;
+}
+} // namespace imunano33
+
+#endif
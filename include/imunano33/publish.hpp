@@ -0,0 +1,211 @@
+/**
+ * @file
+ * @brief File containing the imunano33::ClimatePublisher class
+ */
+
+#ifndef INCLUDE_IMUNANO33_PUBLISH_HPP_
+#define INCLUDE_IMUNANO33_PUBLISH_HPP_
+
+#include "imunano33/unit.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Channels of climate data
+ *
+ * These are bit flags, so they can be combined.
+ */
+enum ClimateChannel {
+  TEMPERATURE_CHANNEL = 1, //!< Temperature
+  HUMIDITY_CHANNEL = 2,    //!< Relative humidity
+  PRESSURE_CHANNEL = 4     //!< Pressure
+};
+
+/**
+ * @brief Decides when climate data has changed enough to be published
+ *
+ * Every climate reading is first optionally smoothed with an exponential moving
+ * average. A reading is worth publishing when any smoothed channel has moved
+ * further than its deadband from the last published value. Readings are never
+ * published more often than the minimum interval, and are always published
+ * after the maximum interval, so the receiver knows the sender is alive.
+ *
+ * By default, there is no smoothing, no deadband, and no minimum or maximum
+ * interval, so every changed reading is published.
+ */
+class ClimatePublisher {
+public:
+  /**
+   * @brief Default constructor
+   */
+  ClimatePublisher() = default;
+
+  /**
+   * @brief Constructor
+   *
+   * @param tempBand Deadband of temperature, in C
+   * @param humidBand Deadband of relative humidity, in percent
+   * @param pressureBand Deadband of pressure, in kPa
+   */
+  ClimatePublisher(const num_t tempBand, const num_t humidBand,
+                   const num_t pressureBand) {
+    setDeadband(tempBand, humidBand, pressureBand);
+  }
+
+  /**
+   * @brief Adds a climate reading
+   *
+   * If this returns true, the reading is counted as published, so the next
+   * readings are compared against it.
+   *
+   * @param temp Temperature, in C
+   * @param humid Relative humidity, in percent
+   * @param pressure Pressure, in kPa
+   * @param time Timestamp of the reading, in s
+   *
+   * @returns If the reading should be published. The values to publish are
+   * getTemp(), getHumidity(), and getPressure().
+   */
+  bool update(const num_t temp, const num_t humid, const num_t pressure,
+              const num_t time) {
+    const num_t reading[3] = {temp, humid, pressure};
+
+    for (unsigned int i = 0; i < 3; i++) {
+      if (m_hasReading) {
+        m_smoothed[i] += m_alpha * (reading[i] - m_smoothed[i]);
+      } else {
+        m_smoothed[i] = reading[i];
+      }
+    }
+    m_hasReading = true;
+    m_changed = 0;
+
+    if (m_hasPublished) {
+      const num_t elapsed = time - m_publishTime;
+      if (elapsed < m_minInterval) {
+        return false;
+      }
+
+      for (unsigned int i = 0; i < 3; i++) {
+        const num_t diff = m_smoothed[i] - m_published[i];
+        if (diff > m_band[i] || -diff > m_band[i]) {
+          m_changed |= 1U << i;
+        }
+      }
+
+      const bool heartbeat = m_maxInterval > 0 && elapsed >= m_maxInterval;
+      if (m_changed == 0 && !heartbeat) {
+        return false;
+      }
+    } else {
+      m_changed = TEMPERATURE_CHANNEL | HUMIDITY_CHANNEL | PRESSURE_CHANNEL;
+    }
+
+    for (unsigned int i = 0; i < 3; i++) {
+      m_published[i] = m_smoothed[i];
+    }
+    m_publishTime = time;
+    m_hasPublished = true;
+    return true;
+  }
+
+  /**
+   * @brief Sets how far each channel can move before it is published
+   *
+   * A channel is published when it differs from its last published value by
+   * more than its deadband.
+   *
+   * @param tempBand Deadband of temperature, in C
+   * @param humidBand Deadband of relative humidity, in percent
+   * @param pressureBand Deadband of pressure, in kPa
+   */
+  void setDeadband(const num_t tempBand, const num_t humidBand,
+                   const num_t pressureBand) {
+    m_band[0] = tempBand;
+    m_band[1] = humidBand;
+    m_band[2] = pressureBand;
+  }
+
+  /**
+   * @brief Sets exponential smoothing of the readings
+   *
+   * @param alpha Weight of each new reading, in the range (0, 1]. 1 disables
+   * smoothing, and smaller values smooth more.
+   */
+  void setSmoothing(const num_t alpha) { m_alpha = alpha; }
+
+  /**
+   * @brief Sets the minimum and maximum time between publishes
+   *
+   * @param minInterval Shortest time between publishes, in s
+   * @param maxInterval Longest time between publishes, in s. After this long, a
+   * reading is published even if nothing changed. 0 disables this.
+   */
+  void setInterval(const num_t minInterval, const num_t maxInterval) {
+    m_minInterval = minInterval;
+    m_maxInterval = maxInterval;
+  }
+
+  /**
+   * @brief Gets which channels changed in the latest published reading
+   *
+   * @returns Bitwise or of ClimateChannel values. This is 0 if the latest
+   * publish was only because of the maximum interval.
+   */
+  unsigned int getChangedChannels() const { return m_changed; }
+
+  /**
+   * @brief Gets smoothed temperature
+   *
+   * @returns Temperature, in C
+   */
+  num_t getTemp() const { return m_smoothed[0]; }
+
+  /**
+   * @brief Gets smoothed relative humidity
+   *
+   * @returns Relative humidity, in percent
+   */
+  num_t getHumidity() const { return m_smoothed[1]; }
+
+  /**
+   * @brief Gets smoothed pressure
+   *
+   * @returns Pressure, in kPa
+   */
+  num_t getPressure() const { return m_smoothed[2]; }
+
+  /**
+   * @brief Gets time of the last publish
+   *
+   * @returns Timestamp of the last published reading, in s
+   */
+  num_t getPublishTime() const { return m_publishTime; }
+
+  /**
+   * @brief Forgets all readings
+   *
+   * The next reading is always published.
+   */
+  void reset() {
+    m_hasReading = false;
+    m_hasPublished = false;
+    m_changed = 0;
+  }
+
+private:
+  bool m_hasReading{false};
+  bool m_hasPublished{false};
+  unsigned int m_changed{0};
+
+  num_t m_band[3] = {0, 0, 0};
+  num_t m_alpha = 1;
+  num_t m_minInterval = 0;
+  num_t m_maxInterval = 0;
+
+  num_t m_smoothed[3] = {0, 0, 0};
+  num_t m_published[3] = {0, 0, 0};
+  num_t m_publishTime = 0;
+};
+} // namespace imunano33
+
+#endif
@@ -13,24 +13,54 @@
 #include <cmath>
 #endif
 
-#ifdef IMUNANO33_EMBED
-#include "imunano33/sv_embed.hpp"
-#else
-#include "imunano33/simplevectors.hpp"
-#endif
 #include "imunano33/unit.hpp"
+#include "imunano33/vecops.hpp"
+#include "imunano33/vector.hpp"
 
 namespace imunano33 {
-#ifdef IMUNANO33_EMBED
-using Vector3D =
-    svector::EmbVec3D; //!< Alias to vector type in embedded systems
-#else
+#ifndef IMUNANO33_EMBED
+using std::asin;
+using std::atan2;
 using std::cos;
 using std::sin;
 using std::sqrt;
-using svector::Vector3D;
 #endif
 
+/**
+ * @brief A 3x3 rotation matrix
+ */
+struct RotationMatrix {
+  num_t m[3][3]; //!< Matrix entries, indexed as m[row][column]
+
+  /**
+   * @brief Rotates a vector
+   *
+   * This is cheaper than Quaternion::rotate() when rotating many vectors by
+   * the same rotation.
+   *
+   * @param vec The vector to rotate
+   *
+   * @returns The rotated vector
+   */
+  Vector3D rotate(const Vector3D &vec) const {
+    const num_t vx = x(vec);
+    const num_t vy = y(vec);
+    const num_t vz = z(vec);
+
+    return Vector3D{m[0][0] * vx + m[0][1] * vy + m[0][2] * vz,
+                    m[1][0] * vx + m[1][1] * vy + m[1][2] * vz,
+                    m[2][0] * vx + m[2][1] * vy + m[2][2] * vz};
+  }
+};
+
+/**
+ * @brief A rotation as a unit axis and an angle around it
+ */
+struct AxisAngle {
+  Vector3D axis; //!< Unit axis of rotation
+  num_t angle;   //!< Angle of rotation, in radians, in the range [0, 2pi]
+};
+
 /**
  * @brief A simple quaternion class for rotations
  *
@@ -71,8 +101,7 @@ public:
    * @note A zero vector passed into vec will result in undefined behavior
    */
   Quaternion(const Vector3D &vec, const num_t ang) : m_w{cos(ang / 2)} {
-    const Vector3D norm = normalize(vec);
-    m_vec = normalize(vec) * sin(ang / 2);
+    m_vec = vec * (sin(ang / 2) / magn(vec));
   }
 
   /**
@@ -166,7 +195,157 @@ public:
     return Quaternion{newW, newVec};
   }
 
+  /**
+   * @brief Converts rotation quaternion to Euler angles
+   *
+   * The angles follow the yaw-pitch-roll (z-y'-x'') convention: the rotation
+   * is a yaw around the z axis, then a pitch around the new y axis, then a roll
+   * around the newest x axis.
+   *
+   * @note Quaternion must be a unit quaternion.
+   *
+   * @returns <roll, pitch, yaw>, in radians. Roll and yaw are in the range
+   * [-pi, pi], and pitch is in the range [-pi/2, pi/2].
+   */
+  Vector3D toEuler() const {
+    const num_t qx = x(m_vec);
+    const num_t qy = y(m_vec);
+    const num_t qz = z(m_vec);
+
+    const num_t roll =
+        atan2(2 * (m_w * qx + qy * qz), 1 - 2 * (qx * qx + qy * qy));
+    const num_t yaw =
+        atan2(2 * (m_w * qz + qx * qy), 1 - 2 * (qy * qy + qz * qz));
+
+    // rounding can push this slightly out of asin's domain near +-90 degrees
+    num_t sinPitch = 2 * (m_w * qy - qz * qx);
+    sinPitch = sinPitch > 1 ? 1 : sinPitch < -1 ? -1 : sinPitch;
+    const num_t pitch = asin(sinPitch);
+
+    return Vector3D{roll, pitch, yaw};
+  }
+
+  /**
+   * @brief Converts rotation quaternion to a rotation matrix
+   *
+   * Multiplying a vector by the matrix gives the same result as rotate().
+   *
+   * @note If the quaternion is zero, then results in undefined behavior.
+   *
+   * @returns Rotation matrix
+   */
+  RotationMatrix toMatrix() const {
+    const num_t qx = x(m_vec);
+    const num_t qy = y(m_vec);
+    const num_t qz = z(m_vec);
+
+    // dividing by the squared norm makes this correct for non-unit
+    // quaternions as well
+    const num_t s = 2 / (m_w * m_w + qx * qx + qy * qy + qz * qz);
+
+    RotationMatrix res;
+    res.m[0][0] = 1 - s * (qy * qy + qz * qz);
+    res.m[0][1] = s * (qx * qy - m_w * qz);
+    res.m[0][2] = s * (qx * qz + m_w * qy);
+    res.m[1][0] = s * (qx * qy + m_w * qz);
+    res.m[1][1] = 1 - s * (qx * qx + qz * qz);
+    res.m[1][2] = s * (qy * qz - m_w * qx);
+    res.m[2][0] = s * (qx * qz - m_w * qy);
+    res.m[2][1] = s * (qy * qz + m_w * qx);
+    res.m[2][2] = 1 - s * (qx * qx + qy * qy);
+
+    return res;
+  }
+
+  /**
+   * @brief Converts rotation quaternion to an axis and angle
+   *
+   * @note Quaternion must be a unit quaternion.
+   *
+   * @returns Axis and angle of rotation. If there is no rotation, the axis is
+   * <1, 0, 0> and the angle is 0.
+   */
+  AxisAngle toAxisAngle() const {
+    const num_t sinHalf = magn(m_vec);
+
+    AxisAngle res;
+    if (sinHalf == 0) {
+      res.axis = Vector3D{1, 0, 0};
+      res.angle = 0;
+    } else {
+      res.axis = m_vec / sinHalf;
+      res.angle = 2 * atan2(sinHalf, m_w);
+    }
+
+    return res;
+  }
+
+  /**
+   * @brief Creates rotation quaternion from Euler angles
+   *
+   * The angles follow the same convention as toEuler().
+   *
+   * @param roll Rotation around the x axis, in radians
+   * @param pitch Rotation around the y axis, in radians
+   * @param yaw Rotation around the z axis, in radians
+   *
+   * @returns Unit rotation quaternion
+   */
+  static Quaternion fromEuler(const num_t roll, const num_t pitch,
+                              const num_t yaw) {
+    const num_t cr = cos(roll / 2);
+    const num_t sr = sin(roll / 2);
+    const num_t cp = cos(pitch / 2);
+    const num_t sp = sin(pitch / 2);
+    const num_t cy = cos(yaw / 2);
+    const num_t sy = sin(yaw / 2);
+
+    return Quaternion{cr * cp * cy + sr * sp * sy,
+                      Vector3D{sr * cp * cy - cr * sp * sy,
+                               cr * sp * cy + sr * cp * sy,
+                               cr * cp * sy - sr * sp * cy}};
+  }
+
+  /**
+   * @brief Converts rotation quaternion to a rotation vector
+   *
+   * Of the two rotations that the quaternion can represent (q and -q), this
+   * gives the one with the smaller angle.
+   *
+   * @note Quaternion must be a unit quaternion.
+   *
+   * @returns Axis of rotation scaled by the angle of rotation, in the range
+   * [0, pi]
+   */
+  Vector3D toRotVec() const {
+    const num_t sinHalf = magn(m_vec);
+    if (sinHalf == 0) {
+      return Vector3D{};
+    }
+
+    const num_t halfAng = atan2(sinHalf, m_w < 0 ? -m_w : m_w);
+    const num_t scale = (m_w < 0 ? -2 : 2) * halfAng / sinHalf;
+    return m_vec * scale;
+  }
+
+  /**
+   * @brief Creates rotation quaternion from a rotation vector
+   *
+   * @param rotVec Axis of rotation scaled by the angle of rotation
+   *
+   * @returns Unit rotation quaternion, or [1, 0, 0, 0] if rotVec is zero
+   */
+  static Quaternion fromRotVec(const Vector3D &rotVec) {
+    const num_t ang = magn(rotVec);
+    if (ang == 0) {
+      return Quaternion{};
+    }
+
+    return Quaternion{rotVec, ang};
+  }
+
   // defined later, where operators are defined
+  friend Quaternion operator*(const Quaternion &lhs, const Quaternion &rhs);
   Quaternion &operator*=(const Quaternion &other);
   Vector3D rotate(const Vector3D &vec) const;
   static Vector3D rotate(const Vector3D &vec, const Vector3D &axis, num_t ang);
@@ -185,20 +364,22 @@ private:
  * @returns Product
  */
 inline Quaternion operator*(const Quaternion &lhs, const Quaternion &rhs) {
-#ifdef IMUNANO33_EMBED
-  using Vector3D =
-      svector::EmbVec3D; //!< Alias to vector type in embedded systems
-#else
-  using svector::Vector3D;
-#endif
-
-  const num_t wl = lhs.w();
-  const num_t wr = rhs.w();
-
-  const Vector3D vl = lhs.vec();
-  const Vector3D vr = rhs.vec();
-
-  return Quaternion{wl * wr - dot(vl, vr), vr * wl + vl * wr + cross(vl, vr)};
+  // reads the components directly, since vec() returns a copy
+  const num_t wl = lhs.m_w;
+  const num_t wr = rhs.m_w;
+  const num_t xl = x(lhs.m_vec);
+  const num_t yl = y(lhs.m_vec);
+  const num_t zl = z(lhs.m_vec);
+  const num_t xr = x(rhs.m_vec);
+  const num_t yr = y(rhs.m_vec);
+  const num_t zr = z(rhs.m_vec);
+
+  // wl * wr - dot(vl, vr) and vr * wl + vl * wr + cross(vl, vr), written out
+  // so no temporary vectors are built
+  return Quaternion{wl * wr - xl * xr - yl * yr - zl * zr,
+                    Vector3D{wl * xr + wr * xl + yl * zr - zl * yr,
+                             wl * yr + wr * yl + zl * xr - xl * zr,
+                             wl * zr + wr * zl + xl * yr - yl * xr}};
 }
 
 /**
@@ -236,11 +417,7 @@ inline bool operator!=(const Quaternion &lhs, const Quaternion &rhs) {
  */
 inline Vector3D Quaternion::rotate(const Vector3D &vec, const Vector3D &axis,
                                    const num_t ang) {
-  const Quaternion rotQ{normalize(axis), ang};
-  const Quaternion vecQ{0, vec};
-  const Quaternion res = rotQ * vecQ * rotQ.conj();
-
-  return res.vec();
+  return Quaternion{axis, ang}.rotate(vec);
 }
 
 /**
@@ -251,9 +428,7 @@ inline Vector3D Quaternion::rotate(const Vector3D &vec, const Vector3D &axis,
  * @returns Quaternion multiplied in place
  */
 inline Quaternion &Quaternion::operator*=(const Quaternion &other) {
-  const Quaternion res = (*this) * other;
-  m_w = res.w();
-  m_vec = res.vec();
+  *this = (*this) * other;
 
   return *this;
 }
@@ -266,10 +441,211 @@ inline Quaternion &Quaternion::operator*=(const Quaternion &other) {
  * @returns The rotated vector.
  */
 inline Vector3D Quaternion::rotate(const Vector3D &vec) const {
-  const Quaternion vecQ = {0, vec};
-  const Quaternion res = (*this) * vecQ * inv();
+  // expanding q * [0, v] * q^-1 gives
+  // ((w^2 - u.u) v + 2 (u.v) u + 2 w (u x v)) / |q|^2, which needs no
+  // intermediate quaternions
+  const num_t uu = dot(m_vec, m_vec);
+  const num_t invNormSq = 1 / (m_w * m_w + uu);
+  const num_t kv = (m_w * m_w - uu) * invNormSq;
+  const num_t ku = 2 * dot(m_vec, vec) * invNormSq;
+  const num_t kc = 2 * m_w * invNormSq;
+
+  return crossAdd(linComb(vec, kv, m_vec, ku), m_vec, vec, kc);
+}
+
+/**
+ * @brief Dot product of two quaternions as 4-dimensional vectors
+ *
+ * For unit quaternions, this is the cosine of half the angle between the two
+ * rotations.
+ *
+ * @param lhs Left hand argument
+ * @param rhs Right hand argument
+ *
+ * @returns Dot product
+ */
+inline num_t dot(const Quaternion &lhs, const Quaternion &rhs) {
+  return lhs.w() * rhs.w() + dot(lhs.vec(), rhs.vec());
+}
+
+/**
+ * @brief Normalized linear interpolation between two rotations
+ *
+ * This is much cheaper than slerp() and follows the same path, but does not
+ * move at a constant angular velocity. The error is small when the two
+ * rotations are close.
+ *
+ * @param from Rotation at t = 0
+ * @param to Rotation at t = 1
+ * @param t Interpolation parameter, in the range [0, 1]
+ *
+ * @note Both quaternions must be unit quaternions.
+ *
+ * @returns Unit rotation quaternion along the shortest path
+ */
+inline Quaternion nlerp(const Quaternion &from, const Quaternion &to,
+                        const num_t t) {
+  // q and -q are the same rotation, so pick the one in the same hemisphere as
+  // from to take the shortest path
+  const num_t toScale = dot(from, to) < 0 ? -t : t;
+  const num_t fromScale = 1 - t;
+
+  return Quaternion{from.w() * fromScale + to.w() * toScale,
+                    linComb(from.vec(), fromScale, to.vec(), toScale)}
+      .unit();
+}
+
+/**
+ * @brief Spherical linear interpolation between two rotations
+ *
+ * Rotates from one rotation to the other at a constant angular velocity,
+ * along the shortest path.
+ *
+ * @param from Rotation at t = 0
+ * @param to Rotation at t = 1
+ * @param t Interpolation parameter, in the range [0, 1]
+ *
+ * @note Both quaternions must be unit quaternions.
+ *
+ * @returns Unit rotation quaternion
+ */
+inline Quaternion slerp(const Quaternion &from, const Quaternion &to,
+                        const num_t t) {
+#ifndef IMUNANO33_EMBED
+  using std::acos;
+#endif
+
+  num_t cosAng = dot(from, to);
+  const num_t sign = cosAng < 0 ? -1 : 1;
+  cosAng *= sign;
+
+  // nearly the same rotation, where sin(ang) is too small to divide by and
+  // nlerp is just as accurate
+#ifdef IMUNANO33_FLOAT
+  if (cosAng > 0.9995F) {
+#else
+  if (cosAng > 0.9995) {
+#endif
+    return nlerp(from, to, t);
+  }
+
+  const num_t ang = acos(cosAng);
+  const num_t sinAng = sin(ang);
+  const num_t fromScale = sin((1 - t) * ang) / sinAng;
+  const num_t toScale = sign * sin(t * ang) / sinAng;
 
-  return res.vec();
+  return Quaternion{from.w() * fromScale + to.w() * toScale,
+                    linComb(from.vec(), fromScale, to.vec(), toScale)};
+}
+
+/**
+ * @brief Spherical cubic interpolation between two rotations
+ *
+ * Interpolating each pair of rotations in a sequence with squad(), using
+ * control points from squadControl(), gives a path that is smooth across the
+ * rotations in the sequence, unlike slerp().
+ *
+ * @param from Rotation at t = 0
+ * @param to Rotation at t = 1
+ * @param fromCtrl Control point for from, see squadControl()
+ * @param toCtrl Control point for to, see squadControl()
+ * @param t Interpolation parameter, in the range [0, 1]
+ *
+ * @note All quaternions must be unit quaternions.
+ *
+ * @returns Unit rotation quaternion
+ */
+inline Quaternion squad(const Quaternion &from, const Quaternion &to,
+                        const Quaternion &fromCtrl, const Quaternion &toCtrl,
+                        const num_t t) {
+  return slerp(slerp(from, to, t), slerp(fromCtrl, toCtrl, t), 2 * t * (1 - t));
+}
+
+/**
+ * @brief Control point of a rotation for squad()
+ *
+ * @param prev Rotation before cur in the sequence
+ * @param cur Rotation to find the control point of
+ * @param next Rotation after cur in the sequence
+ *
+ * @note All quaternions must be unit quaternions.
+ *
+ * @returns Unit control point quaternion
+ */
+inline Quaternion squadControl(const Quaternion &prev, const Quaternion &cur,
+                               const Quaternion &next) {
+  const Quaternion curInv = cur.conj();
+  const Vector3D toNext = (curInv * next).toRotVec();
+  const Vector3D toPrev = (curInv * prev).toRotVec();
+
+  return cur * Quaternion::fromRotVec((toNext + toPrev) / -4);
+}
+
+/**
+ * @brief Evenly spaced spherical linear interpolation between two rotations
+ *
+ * Writes slerp(from, to, start + i * step) to out[i], for i from 0 to count -
+ * 1. Slerp at evenly spaced parameters satisfies the recurrence p[i + 1] =
+ * 2cos(a)p[i] - p[i - 1], where a is the angle stepped per frame, so after the
+ * first two frames, each frame only needs a few multiplications and no
+ * trigonometry.
+ *
+ * @param from Rotation at t = 0
+ * @param to Rotation at t = 1
+ * @param start Interpolation parameter of the first frame
+ * @param step Change in interpolation parameter between frames
+ * @param out Array to write the frames to
+ * @param count Number of frames to write
+ *
+ * @note Both quaternions must be unit quaternions.
+ */
+inline void slerpFrames(const Quaternion &from, const Quaternion &to,
+                        const num_t start, const num_t step, Quaternion *out,
+                        const unsigned int count) {
+#ifndef IMUNANO33_EMBED
+  using std::acos;
+#endif
+
+  if (count == 0) {
+    return;
+  }
+
+  out[0] = slerp(from, to, start);
+  if (count == 1) {
+    return;
+  }
+  out[1] = slerp(from, to, start + step);
+
+  num_t cosAng = dot(from, to);
+  cosAng = cosAng < 0 ? -cosAng : cosAng;
+
+#ifdef IMUNANO33_FLOAT
+  if (cosAng > 0.9995F) {
+#else
+  if (cosAng > 0.9995) {
+#endif
+    for (unsigned int i = 2; i < count; i++) {
+      out[i] = nlerp(from, to, start + static_cast<num_t>(i) * step);
+    }
+    return;
+  }
+
+  const num_t twoCosStep = 2 * cos(acos(cosAng) * step);
+
+  num_t w0 = out[0].w();
+  num_t w1 = out[1].w();
+  Vector3D v0 = out[0].vec();
+  Vector3D v1 = out[1].vec();
+  for (unsigned int i = 2; i < count; i++) {
+    const num_t w2 = twoCosStep * w1 - w0;
+    const Vector3D v2 = linComb(v1, twoCosStep, v0, -1);
+    out[i] = Quaternion{w2, v2};
+
+    w0 = w1;
+    w1 = w2;
+    v0 = v1;
+    v1 = v2;
+  }
 }
 } // namespace imunano33
 
@@ -0,0 +1,321 @@
+/**
+ * @file
+ * @brief File containing the imunano33::RollingWindow and
+ * imunano33::WindowMoments classes
+ */
+
+#ifndef INCLUDE_IMUNANO33_ROLLING_HPP_
+#define INCLUDE_IMUNANO33_ROLLING_HPP_
+
+#include "imunano33/unit.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Mean and variance of a fixed window of values
+ *
+ * Only the statistics are held here; the values are kept by the caller, so one
+ * ring can hold several channels. While the window fills, each value is added
+ * with Welford's algorithm. Once the window is full, the oldest value is
+ * swapped for the newest with a sliding version of it, so every update is
+ * O(1).
+ *
+ * @tparam N Number of values in a full window.
+ */
+template <unsigned int N> class WindowMoments {
+public:
+  /**
+   * @brief Adds a value to a window that is still filling
+   *
+   * @param value Value to add
+   * @param count Number of values in the window, including value
+   */
+  void add(const num_t value, const unsigned int count) {
+    const num_t delta = value - m_mean;
+    m_mean += delta / static_cast<num_t>(count);
+    m_m2 += delta * (value - m_mean);
+  }
+
+  /**
+   * @brief Replaces the oldest value of a full window
+   *
+   * @param old Value dropped from the window
+   * @param value Value added to the window
+   */
+  void replace(const num_t old, const num_t value) {
+    const num_t newMean = m_mean + (value - old) / static_cast<num_t>(N);
+    m_m2 += (value - old) * (value - newMean + old - m_mean);
+    m_mean = newMean;
+  }
+
+  /**
+   * @brief Recomputes the statistics from a full window
+   *
+   * Sliding updates slowly accumulate rounding error, so callers do this once
+   * every N updates, which keeps the amortized cost O(1).
+   *
+   * @param values First value of the window
+   * @param stride Distance between consecutive values, so value i is at
+   * values[i * stride]
+   */
+  void resync(const num_t *values, const unsigned int stride) {
+    num_t sum = 0;
+    for (unsigned int i = 0; i < N; i++) {
+      sum += values[i * stride];
+    }
+    m_mean = sum / static_cast<num_t>(N);
+
+    num_t m2 = 0;
+    for (unsigned int i = 0; i < N; i++) {
+      const num_t delta = values[i * stride] - m_mean;
+      m2 += delta * delta;
+    }
+    m_m2 = m2;
+  }
+
+  /**
+   * @brief Gets mean of the window
+   *
+   * @returns Mean value
+   */
+  num_t getMean() const { return m_mean; }
+
+  /**
+   * @brief Gets sum of squared deviations from the mean
+   *
+   * @returns Sum of squared deviations, which may be slightly negative from
+   * rounding
+   */
+  num_t getM2() const { return m_m2; }
+
+  /**
+   * @brief Clears the statistics
+   */
+  void reset() {
+    m_mean = 0;
+    m_m2 = 0;
+  }
+
+private:
+  num_t m_mean = 0;
+  num_t m_m2 = 0;
+};
+
+/**
+ * @brief Fixed window of the most recent values with O(1) rolling statistics
+ *
+ * The window keeps the last N values in a ring. The mean and variance are
+ * maintained with WindowMoments, and the minimum and maximum with monotonic
+ * queues, so every push and every statistic is O(1)
+ * (amortized for push) and nothing is allocated.
+ *
+ * @tparam N Number of values in the window.
+ */
+template <unsigned int N> class RollingWindow {
+public:
+  static_assert(N > 0, "Window must hold at least one value");
+
+  /**
+   * @brief Default constructor
+   *
+   * Initializes an empty window.
+   */
+  RollingWindow() { reset(); }
+
+  /**
+   * @brief Adds a value to the window
+   *
+   * If the window is full, the oldest value is dropped.
+   *
+   * @param value Value to add
+   */
+  void push(const num_t value) {
+    // the oldest value is about to be overwritten, so it can no longer be the
+    // minimum or maximum
+    if (m_count == N) {
+      m_min.expire(m_head);
+      m_max.expire(m_head);
+    }
+
+    if (m_count < N) {
+      ++m_count;
+      m_moments.add(value, m_count);
+    } else {
+      m_moments.replace(m_values[m_head], value);
+    }
+
+    m_values[m_head] = value;
+    m_min.push(m_values, m_head);
+    m_max.push(m_values, m_head);
+
+    m_head = (m_head + 1) % N;
+    if (m_head == 0 && m_count == N) {
+      m_moments.resync(m_values, 1);
+    }
+  }
+
+  /**
+   * @brief Gets number of values in the window
+   *
+   * @returns Number of values, at most N
+   */
+  unsigned int size() const { return m_count; }
+
+  /**
+   * @brief Gets maximum number of values in the window
+   *
+   * @returns N
+   */
+  static unsigned int capacity() { return N; }
+
+  /**
+   * @brief Determines if the window is empty
+   *
+   * The statistics are 0 while the window is empty.
+   *
+   * @returns If no values have been added since construction or reset().
+   */
+  bool empty() const { return m_count == 0; }
+
+  /**
+   * @brief Determines if the window is full
+   *
+   * @returns If the window holds N values.
+   */
+  bool full() const { return m_count == N; }
+
+  /**
+   * @brief Gets value in the window
+   *
+   * @param i Index of the value, where 0 is the oldest value and size() - 1 is
+   * the newest.
+   *
+   * @note i must be less than size().
+   *
+   * @returns Value at the index
+   */
+  num_t at(const unsigned int i) const { return m_values[slot(i)]; }
+
+  /**
+   * @brief Gets newest value in the window
+   *
+   * @note The window must not be empty.
+   *
+   * @returns Newest value
+   */
+  num_t latest() const { return m_values[slot(m_count - 1)]; }
+
+  /**
+   * @brief Gets mean of the window
+   *
+   * @returns Mean value
+   */
+  num_t getMean() const { return m_moments.getMean(); }
+
+  /**
+   * @brief Gets variance of the window
+   *
+   * @returns Population variance of the values
+   */
+  num_t getVariance() const {
+    if (m_count < 2) {
+      return 0;
+    }
+
+    const num_t m2 = m_moments.getM2();
+    return m2 > 0 ? m2 / static_cast<num_t>(m_count) : 0;
+  }
+
+  /**
+   * @brief Gets minimum of the window
+   *
+   * @returns Smallest value
+   */
+  num_t getMin() const { return m_count == 0 ? 0 : m_min.front(m_values); }
+
+  /**
+   * @brief Gets maximum of the window
+   *
+   * @returns Largest value
+   */
+  num_t getMax() const { return m_count == 0 ? 0 : m_max.front(m_values); }
+
+  /**
+   * @brief Empties the window
+   */
+  void reset() {
+    m_count = 0;
+    m_head = 0;
+    m_moments.reset();
+    for (unsigned int i = 0; i < N; i++) {
+      m_values[i] = 0;
+    }
+    m_min.reset();
+    m_max.reset();
+  }
+
+private:
+  /**
+   * @brief Ring of slots whose values are monotonic from front to back
+   *
+   * For the minimum, each value is smaller than every value after it, so the
+   * front is always the minimum of the window. Values that can never be the
+   * minimum again, because a newer value is smaller, are dropped from the back.
+   *
+   * @tparam IsMin Whether this tracks the minimum rather than the maximum.
+   */
+  template <bool IsMin> class MonotonicQueue {
+  public:
+    void push(const num_t *values, const unsigned int slot) {
+      while (m_size > 0 && dominates(values[slot], values[back()])) {
+        --m_size;
+      }
+
+      m_slots[(m_front + m_size) % N] = slot;
+      ++m_size;
+    }
+
+    void expire(const unsigned int slot) {
+      if (m_size > 0 && m_slots[m_front] == slot) {
+        m_front = (m_front + 1) % N;
+        --m_size;
+      }
+    }
+
+    num_t front(const num_t *values) const { return values[m_slots[m_front]]; }
+
+    void reset() {
+      m_front = 0;
+      m_size = 0;
+      for (unsigned int i = 0; i < N; i++) {
+        m_slots[i] = 0;
+      }
+    }
+
+  private:
+    static bool dominates(const num_t newer, const num_t older) {
+      return IsMin ? newer <= older : newer >= older;
+    }
+
+    unsigned int back() const { return m_slots[(m_front + m_size - 1) % N]; }
+
+    unsigned int m_slots[N];
+    unsigned int m_front;
+    unsigned int m_size;
+  };
+
+  unsigned int slot(const unsigned int i) const {
+    // the oldest value is at the head once the window is full
+    return m_count < N ? i : (m_head + i) % N;
+  }
+
+  num_t m_values[N];
+  WindowMoments<N> m_moments;
+  unsigned int m_count;
+  unsigned int m_head;
+
+  MonotonicQueue<true> m_min;
+  MonotonicQueue<false> m_max;
+};
+} // namespace imunano33
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * @file
+ * @brief File containing the imunano33::SensorInput class and its scales
+ */
+
+#ifndef INCLUDE_IMUNANO33_SENSORINPUT_HPP_
+#define INCLUDE_IMUNANO33_SENSORINPUT_HPP_
+
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+namespace imunano33 {
+/**
+ * @brief An enumerator describing which sensor axis, and in which direction,
+ * an axis of the library reads from
+ */
+enum MountAxis {
+  POS_X, //!< Sensor x axis
+  NEG_X, //!< Sensor x axis, negated
+  POS_Y, //!< Sensor y axis
+  NEG_Y, //!< Sensor y axis, negated
+  POS_Z, //!< Sensor z axis
+  NEG_Z  //!< Sensor z axis, negated
+};
+
+/**
+ * @brief Scale given as a ratio of integers
+ *
+ * For example, a 16-bit accelerometer with a range of ±2 g reads 16384 LSB per
+ * g, so its scale from LSB to g is ScaleRatio<1, 16384>.
+ *
+ * @tparam Num Numerator.
+ * @tparam Den Denominator.
+ */
+template <long long Num, long long Den = 1> struct ScaleRatio {
+  /**
+   * @brief Gets the scale
+   *
+   * @returns Num / Den
+   */
+  static constexpr num_t value() {
+    return static_cast<num_t>(Num) / static_cast<num_t>(Den);
+  }
+};
+
+/**
+ * @brief Scale from degrees to radians, such as from dps to rad/s
+ */
+struct DegToRad {
+  /**
+   * @brief Gets the scale
+   *
+   * @returns pi / 180
+   */
+  static constexpr num_t value() {
+#ifdef IMUNANO33_FLOAT
+    return 0.0174532925199433F;
+#else
+    return 0.017453292519943295;
+#endif
+  }
+};
+
+/**
+ * @brief Product of two scales, such as from LSB to dps and then to rad/s
+ *
+ * @tparam A First scale.
+ * @tparam B Second scale.
+ */
+template <typename A, typename B> struct ScaleProduct {
+  /**
+   * @brief Gets the scale
+   *
+   * @returns A::value() * B::value()
+   */
+  static constexpr num_t value() { return A::value() * B::value(); }
+};
+
+/**
+ * @brief Converts raw sensor readings to the library's axes and units
+ *
+ * Sensors are mounted in all orientations, and report in their own units, so
+ * every reading has to be permuted, have some axes flipped, and be scaled
+ * before it reaches the filter (see IMUNano33 for its axes). The mounting and
+ * scale are template parameters, so each output axis is a single multiply of
+ * one raw axis by a constant folded at compile time.
+ *
+ * For example, the LSM9DS1 of the Arduino Nano 33 BLE Sense reports the
+ * accelerometer in g with y and z flipped, and the gyroscope in dps with x
+ * flipped:
+ *
+ * @code
+ * using AccelInput = SensorInput<POS_X, NEG_Y, NEG_Z>;
+ * using GyroInput = SensorInput<NEG_X, POS_Y, POS_Z, DegToRad>;
+ * @endcode
+ *
+ * @tparam X Sensor axis that the x axis reads from.
+ * @tparam Y Sensor axis that the y axis reads from.
+ * @tparam Z Sensor axis that the z axis reads from.
+ * @tparam Scale Scale from raw readings to the wanted units, a type with a
+ * static constexpr value() method like ScaleRatio.
+ */
+template <MountAxis X, MountAxis Y, MountAxis Z,
+          typename Scale = ScaleRatio<1>>
+class SensorInput {
+public:
+  /**
+   * @brief Converts a reading
+   *
+   * @param rawX Raw sensor x reading
+   * @param rawY Raw sensor y reading
+   * @param rawZ Raw sensor z reading
+   *
+   * @returns Reading in the library's axes and units
+   */
+  template <typename T>
+  static Vector3D apply(const T rawX, const T rawY, const T rawZ) {
+    const num_t raw[3] = {static_cast<num_t>(rawX), static_cast<num_t>(rawY),
+                          static_cast<num_t>(rawZ)};
+    return Vector3D{raw[index(X)] * coeff(X), raw[index(Y)] * coeff(Y),
+                    raw[index(Z)] * coeff(Z)};
+  }
+
+  /**
+   * @brief Converts a reading
+   *
+   * @param raw Raw sensor reading
+   *
+   * @returns Reading in the library's axes and units
+   */
+  static Vector3D apply(const Vector3D &raw) {
+    return apply(x(raw), y(raw), z(raw));
+  }
+
+  /**
+   * @brief Converts an array of readings
+   *
+   * @param raw Raw sensor readings, as consecutive x, y, z triples, such as
+   * read out of a sensor FIFO
+   * @param out Readings in the library's axes and units, as consecutive x, y,
+   * z triples. This can be raw itself if T is num_t.
+   * @param count Number of readings
+   */
+  template <typename T>
+  static void apply(const T *raw, num_t *out, const unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+      const num_t cur[3] = {static_cast<num_t>(raw[3 * i]),
+                            static_cast<num_t>(raw[3 * i + 1]),
+                            static_cast<num_t>(raw[3 * i + 2])};
+      out[3 * i] = cur[index(X)] * coeff(X);
+      out[3 * i + 1] = cur[index(Y)] * coeff(Y);
+      out[3 * i + 2] = cur[index(Z)] * coeff(Z);
+    }
+  }
+
+  /**
+   * @brief Gets the factor a raw axis is multiplied by
+   *
+   * @param axis Mounting of the axis
+   *
+   * @returns Sign of the axis times the scale
+   */
+  static constexpr num_t coeff(const MountAxis axis) {
+    return (axis == NEG_X || axis == NEG_Y || axis == NEG_Z ? -1 : 1) *
+           Scale::value();
+  }
+
+  /**
+   * @brief Gets which raw axis an axis reads from
+   *
+   * @param axis Mounting of the axis
+   *
+   * @returns 0, 1, or 2 for sensor x, y, or z
+   */
+  static constexpr unsigned int index(const MountAxis axis) {
+    return static_cast<unsigned int>(axis) / 2;
+  }
+
+  // a sensor axis is the enumerator divided by 2
+  static_assert(X / 2 != Y / 2 && Y / 2 != Z / 2 && X / 2 != Z / 2,
+                "each sensor axis must be used exactly once");
+};
+} // namespace imunano33
+
+#endif
@@ -0,0 +1,272 @@
+/**
+ * @file
+ * @brief File containing the imunano33::OrientationSeries class
+ */
+
+#ifndef INCLUDE_IMUNANO33_SERIES_HPP_
+#define INCLUDE_IMUNANO33_SERIES_HPP_
+
+// the series grows without bound, so it is only for hosts
+#ifndef IMUNANO33_EMBED
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "imunano33/packedquat.hpp"
+#include "imunano33/quaternion.hpp"
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Compressed in-memory series of orientations
+ *
+ * Each orientation is quantized with the smallest-three method: q and -q are
+ * the same rotation, so the sign is chosen to make the largest component
+ * positive, that component is dropped (it is recovered from the unit norm),
+ * and the other three, which lie in [-1/sqrt(2), 1/sqrt(2)], are stored as
+ * integers of the given number of bits. Consecutive orientations of a smooth
+ * motion differ little, so each is stored as the zigzag varint encoded
+ * difference from the previous one, and only a change of the dropped
+ * component stores the three integers in full.
+ *
+ * Orientations are grouped in blocks that start in full, and the byte offset
+ * of each block is kept, so any orientation is found by decoding at most one
+ * block.
+ *
+ * With the default 16 bits, each component is within about 2e-5 of the
+ * original, and the rotation within about 1e-4 rad.
+ */
+class OrientationSeries {
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param bits Bits per stored component, from 2 to 24
+   * @param blockSize Number of orientations per block. Larger blocks compress
+   * slightly better, but random access decodes up to a whole block.
+   */
+  explicit OrientationSeries(const unsigned int bits = 16,
+                             const unsigned int blockSize = 256)
+      : m_scale{static_cast<num_t>((1 << (bits - 1)) - 1) * SQRT2},
+        m_blockSize{blockSize} {}
+
+  /**
+   * @brief Adds an orientation to the end of the series
+   *
+   * @param q Orientation, which should be a unit quaternion (such as
+   * Filter::getRotQ())
+   */
+  void append(const Quaternion &q) {
+    const Vector3D vec = q.vec();
+    const num_t comps[4] = {q.w(), x(vec), y(vec), z(vec)};
+
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < 4; i++) {
+      if (std::fabs(comps[i]) > std::fabs(comps[largest])) {
+        largest = i;
+      }
+    }
+    const num_t sign = comps[largest] < 0 ? -1 : 1;
+
+    int32_t cur[3];
+    for (unsigned int i = 0, j = 0; i < 4; i++) {
+      if (i != largest) {
+        cur[j++] = static_cast<int32_t>(std::lround(comps[i] * sign * m_scale));
+      }
+    }
+
+    if (m_size % m_blockSize == 0) {
+      m_blocks.push_back(m_bytes.size());
+      m_largest = NO_LARGEST;
+    }
+
+    if (largest == m_largest) {
+      putVarint(zigzag(cur[0] - m_prev[0]) << 1);
+      putVarint(zigzag(cur[1] - m_prev[1]));
+      putVarint(zigzag(cur[2] - m_prev[2]));
+    } else {
+      putVarint((largest << 1) | 1);
+      putVarint(zigzag(cur[0]));
+      putVarint(zigzag(cur[1]));
+      putVarint(zigzag(cur[2]));
+      m_largest = largest;
+    }
+
+    for (unsigned int i = 0; i < 3; i++) {
+      m_prev[i] = cur[i];
+    }
+    ++m_size;
+  }
+
+  /**
+   * @brief Decodes a range of orientations
+   *
+   * @param start Index of the first orientation
+   * @param count Number of orientations
+   * @param out Decoded unit quaternions, which must have room for count
+   *
+   * @note start + count must be at most size().
+   */
+  void decode(const std::size_t start, const std::size_t count,
+              PackedQuaternion *out) const {
+    std::size_t block = start / m_blockSize;
+    std::size_t skip = start % m_blockSize;
+    std::size_t done = 0;
+
+    while (done < count) {
+      const std::size_t left = count - done;
+      const std::size_t inBlock =
+          m_blockSize - skip < left ? m_blockSize - skip : left;
+      decodeBlock(block, skip, inBlock, out + done);
+      done += inBlock;
+      skip = 0;
+      ++block;
+    }
+  }
+
+  /**
+   * @brief Gets an orientation
+   *
+   * @param i Index of the orientation
+   *
+   * @note i must be less than size().
+   *
+   * @returns Unit quaternion
+   */
+  Quaternion at(const std::size_t i) const {
+    PackedQuaternion q;
+    decode(i, 1, &q);
+    return q.toQuaternion();
+  }
+
+  /**
+   * @brief Gets number of orientations
+   *
+   * @returns Number of orientations
+   */
+  std::size_t size() const { return m_size; }
+
+  /**
+   * @brief Gets memory used by the encoded series
+   *
+   * @returns Bytes of encoded orientations and block offsets
+   */
+  std::size_t byteSize() const {
+    return m_bytes.size() + m_blocks.size() * sizeof(std::size_t);
+  }
+
+  /**
+   * @brief Releases memory reserved for future appends
+   */
+  void shrinkToFit() {
+    m_bytes.shrink_to_fit();
+    m_blocks.shrink_to_fit();
+  }
+
+  /**
+   * @brief Removes all orientations
+   */
+  void clear() {
+    m_bytes.clear();
+    m_blocks.clear();
+    m_size = 0;
+  }
+
+private:
+  static constexpr num_t SQRT2 = 1.41421356237309504880;
+  static constexpr unsigned int NO_LARGEST = 4;
+
+  num_t m_scale;
+  std::size_t m_blockSize;
+
+  std::vector<uint8_t> m_bytes;
+  std::vector<std::size_t> m_blocks;
+  std::size_t m_size = 0;
+
+  // state of the last append
+  unsigned int m_largest = NO_LARGEST;
+  int32_t m_prev[3] = {0, 0, 0};
+
+  static uint32_t zigzag(const int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^
+           static_cast<uint32_t>(value >> 31);
+  }
+
+  static int32_t unzigzag(const uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+  }
+
+  void putVarint(uint32_t value) {
+    while (value >= 0x80) {
+      m_bytes.push_back(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    m_bytes.push_back(static_cast<uint8_t>(value));
+  }
+
+  static uint32_t getVarint(const uint8_t *&pos) {
+    // most differences fit in one or two bytes
+    uint32_t value = *pos++;
+    if (value < 0x80) {
+      return value;
+    }
+
+    value &= 0x7f;
+    unsigned int shift = 7;
+    uint8_t byte;
+    do {
+      byte = *pos++;
+      value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte >= 0x80);
+    return value;
+  }
+
+  void decodeBlock(const std::size_t block, const std::size_t skip,
+                   const std::size_t count, PackedQuaternion *out) const {
+    const uint8_t *pos = m_bytes.data() + m_blocks[block];
+    const num_t invScale = 1 / m_scale;
+    unsigned int largest = 0;
+    int32_t cur[3] = {0, 0, 0};
+
+    for (std::size_t i = 0; i < skip + count; i++) {
+      const uint32_t head = getVarint(pos);
+      if ((head & 1) != 0) {
+        largest = head >> 1;
+        cur[0] = unzigzag(getVarint(pos));
+        cur[1] = unzigzag(getVarint(pos));
+        cur[2] = unzigzag(getVarint(pos));
+      } else {
+        cur[0] += unzigzag(head >> 1);
+        cur[1] += unzigzag(getVarint(pos));
+        cur[2] += unzigzag(getVarint(pos));
+      }
+
+      if (i < skip) {
+        continue;
+      }
+
+      const num_t a = static_cast<num_t>(cur[0]) * invScale;
+      const num_t b = static_cast<num_t>(cur[1]) * invScale;
+      const num_t c = static_cast<num_t>(cur[2]) * invScale;
+      const num_t restSq = 1 - a * a - b * b - c * c;
+      const num_t rest = restSq > 0 ? std::sqrt(restSq) : 0;
+
+      num_t comps[4];
+      comps[largest] = rest;
+      const unsigned int first = largest == 0 ? 1 : 0;
+      const unsigned int second = largest <= 1 ? 2 : 1;
+      const unsigned int third = largest <= 2 ? 3 : 2;
+      comps[first] = a;
+      comps[second] = b;
+      comps[third] = c;
+      out[i - skip] = PackedQuaternion{comps[0], comps[1], comps[2], comps[3]};
+    }
+  }
+};
+} // namespace imunano33
+#endif
+
+#endif
@@ -0,0 +1,429 @@
+/**
+ * @file
+ * @brief File containing the imunano33::ImuSimulator class
+ */
+
+#ifndef INCLUDE_IMUNANO33_SIMULATE_HPP_
+#define INCLUDE_IMUNANO33_SIMULATE_HPP_
+
+#ifdef IMUNANO33_EMBED
+#include <math.h>
+#include <stdint.h>
+#else
+#include <cmath>
+#include <cstdint>
+#endif
+
+#include "imunano33/mathutil.hpp"
+#include "imunano33/quaternion.hpp"
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+namespace imunano33 {
+#ifndef IMUNANO33_EMBED
+using std::cos;
+using std::sin;
+using std::sqrt;
+#endif
+
+/**
+ * @brief Generates IMU readings along with the true motion that produced them
+ *
+ * The orientation follows yaw-pitch-roll Euler angles (see
+ * Quaternion::toEuler()), each of which is an initial angle, plus a constant
+ * rate, plus a sinusoidal shake. The linear acceleration in the world frame is
+ * a sinusoid on each axis. Because the motion is in closed form, the true
+ * orientation, angular velocity, and linear acceleration are exact at every
+ * sample, with no integration error.
+ *
+ * The readings follow the same conventions as Filter: the gyroscope reads the
+ * angular velocity in the body frame, in rad/s, and the accelerometer reads
+ * (0, 0, -g) minus the linear acceleration, rotated into the body frame. The
+ * sensor model then adds a constant bias and Gaussian white noise to each
+ * reading, and drops readings at random, in which case the reading is zero
+ * (which the filter skips).
+ *
+ * The noise comes from a small pseudorandom generator seeded in the
+ * constructor, so the same seed always produces the same samples on the same
+ * platform. The shake and acceleration phases are stepped by rotation instead
+ * of calling sin() and cos() for each sample, which leaves the sin() and cos()
+ * of the three half Euler angles as the only ones per sample.
+ */
+class ImuSimulator {
+public:
+  /**
+   * @brief Parameters of the true motion
+   *
+   * Angles are <roll, pitch, yaw>, in rad. Every parameter is 0 by default,
+   * which is an IMU lying flat and still.
+   */
+  struct Motion {
+    Vector3D initialAngles;  //!< Euler angles at time 0, in rad
+    Vector3D angleRate;      //!< Constant rate of each Euler angle, in rad/s
+    Vector3D shakeAmplitude; //!< Amplitude of the shake of each angle, in rad
+    num_t shakeFreq = 0;     //!< Frequency of the shake, in Hz
+
+    /**
+     * @brief Amplitude of the linear acceleration on each world axis, in m/s^2
+     */
+    Vector3D accelAmplitude;
+    num_t accelFreq = 0; //!< Frequency of the linear acceleration, in Hz
+
+#ifdef IMUNANO33_FLOAT
+    num_t gravity = 9.80665F; //!< Magnitude of gravity, in m/s^2
+#else
+    num_t gravity = 9.80665; //!< Magnitude of gravity, in m/s^2
+#endif
+  };
+
+  /**
+   * @brief Parameters of the sensor errors
+   *
+   * Every parameter is 0 by default, which is a perfect sensor.
+   */
+  struct SensorModel {
+    Vector3D gyroBias;    //!< Gyroscope bias, in rad/s
+    Vector3D accelBias;   //!< Accelerometer bias, in m/s^2
+    num_t gyroNoise = 0;  //!< Standard deviation of gyroscope noise, in rad/s
+    num_t accelNoise = 0; //!< Standard deviation of accelerometer noise
+    num_t dropout = 0;    //!< Probability that each reading is dropped
+  };
+
+  /**
+   * @brief One generated sample
+   */
+  struct Sample {
+    num_t time;             //!< Time of the sample, in s
+    num_t deltaT;           //!< Time since the previous sample, in s
+    Vector3D gyro;          //!< Gyroscope reading, in rad/s
+    Vector3D accel;         //!< Accelerometer reading, in m/s^2
+    bool gyroDropped;       //!< If the gyroscope reading was dropped
+    bool accelDropped;      //!< If the accelerometer reading was dropped
+    Quaternion orientation; //!< True orientation, from body to world frame
+    Vector3D angularVel;    //!< True angular velocity in the body frame
+    Vector3D linearAccel;   //!< True linear acceleration in the world frame
+    Vector3D velocity;      //!< True velocity in the world frame, in m/s
+  };
+
+  /**
+   * @brief Constructor
+   *
+   * @param motion True motion
+   * @param sensor Sensor errors
+   * @param rate Sample rate, in Hz
+   * @param seed Seed of the noise and dropouts
+   */
+  ImuSimulator(const Motion &motion, const SensorModel &sensor,
+               const num_t rate, const uint64_t seed = 0)
+      : m_motion{motion}, m_sensor{sensor}, m_deltaT{1 / rate}, m_seed{seed} {
+    const num_t shakeStep = 2 * PI * m_motion.shakeFreq * m_deltaT;
+    const num_t accelStep = 2 * PI * m_motion.accelFreq * m_deltaT;
+    m_shakeStep[0] = sin(shakeStep);
+    m_shakeStep[1] = cos(shakeStep);
+    m_accelStep[0] = sin(accelStep);
+    m_accelStep[1] = cos(accelStep);
+
+    // the axes are a third of a turn out of phase, so the motion is not
+    // confined to a plane
+    for (unsigned int i = 0; i < 3; i++) {
+      const num_t phase = 2 * PI * static_cast<num_t>(i) / 3;
+      m_phase[i][0] = sin(phase);
+      m_phase[i][1] = cos(phase);
+    }
+
+    reset();
+  }
+
+  /**
+   * @brief Generates the next sample
+   *
+   * @returns Sample one period after the previous one
+   */
+  const Sample &next() {
+    ++m_step;
+
+    if (m_step % RESYNC_STEPS == 0) {
+      // stop rounding errors from building up in the stepped sinusoids
+      syncPhasors();
+    } else {
+      stepPhasor(m_shake, m_shakeStep);
+      stepPhasor(m_accel, m_accelStep);
+    }
+
+    evaluate();
+    sense();
+    return m_sample;
+  }
+
+  /**
+   * @brief Gets the latest sample
+   *
+   * Before the first call to next(), this is the noise-free sample at time 0,
+   * whose orientation can be used to initialize a filter.
+   *
+   * @returns Latest sample
+   */
+  const Sample &current() const { return m_sample; }
+
+  /**
+   * @brief Gets time between samples
+   *
+   * @returns Sample period, in s
+   */
+  num_t getDeltaT() const { return m_deltaT; }
+
+  /**
+   * @brief Restarts at time 0 with the original seed
+   *
+   * The samples afterwards are identical to the samples after construction.
+   */
+  void reset() {
+    m_step = 0;
+    m_rng.seed(m_seed);
+    m_hasSpare = false;
+    syncPhasors();
+    evaluate();
+    m_sample.gyro = m_sample.angularVel;
+    m_sample.accel = trueAccel();
+    m_sample.gyroDropped = false;
+    m_sample.accelDropped = false;
+  }
+
+private:
+  /**
+   * @brief xoshiro256+ generator, seeded with splitmix64
+   */
+  class Random {
+  public:
+    void seed(uint64_t seed) {
+      for (unsigned int i = 0; i < 4; i++) {
+        seed += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        m_state[i] = z ^ (z >> 31);
+      }
+    }
+
+    uint64_t next() {
+      const uint64_t result = m_state[0] + m_state[3];
+      const uint64_t t = m_state[1] << 17;
+      m_state[2] ^= m_state[0];
+      m_state[3] ^= m_state[1];
+      m_state[1] ^= m_state[2];
+      m_state[0] ^= m_state[3];
+      m_state[2] ^= t;
+      m_state[3] = (m_state[3] << 45) | (m_state[3] >> 19);
+      return result;
+    }
+
+    // uniform in (0, 1]
+    num_t uniform() {
+#ifdef IMUNANO33_FLOAT
+      return static_cast<num_t>((next() >> 40) + 1) * 5.9604644775390625e-8F;
+#else
+      return static_cast<num_t>((next() >> 11) + 1) * 1.1102230246251565e-16;
+#endif
+    }
+
+  private:
+    uint64_t m_state[4];
+  };
+
+#ifdef IMUNANO33_FLOAT
+  static constexpr num_t PI = 3.14159265358979F;
+#else
+  static constexpr num_t PI = 3.14159265358979323846;
+#endif
+  static constexpr unsigned long RESYNC_STEPS = 1024;
+
+  Motion m_motion;
+  SensorModel m_sensor;
+  num_t m_deltaT;
+  uint64_t m_seed;
+
+  Random m_rng;
+  bool m_hasSpare{false};
+  num_t m_spare{0};
+
+  unsigned long m_step{0};
+  num_t m_shakeStep[2]; // sin and cos of the shake phase step
+  num_t m_accelStep[2]; // sin and cos of the acceleration phase step
+  num_t m_phase[3][2];  // sin and cos of the phase offset of each axis
+  num_t m_shake[2];     // sin and cos of the current shake phase
+  num_t m_accel[2];     // sin and cos of the current acceleration phase
+
+  Sample m_sample;
+
+  static void stepPhasor(num_t phasor[2], const num_t step[2]) {
+    const num_t s = phasor[0] * step[1] + phasor[1] * step[0];
+    const num_t c = phasor[1] * step[1] - phasor[0] * step[0];
+    phasor[0] = s;
+    phasor[1] = c;
+  }
+
+  void syncPhasors() {
+    const num_t time = static_cast<num_t>(m_step) * m_deltaT;
+    const num_t shake = 2 * PI * m_motion.shakeFreq * time;
+    const num_t accel = 2 * PI * m_motion.accelFreq * time;
+    m_shake[0] = sin(shake);
+    m_shake[1] = cos(shake);
+    m_accel[0] = sin(accel);
+    m_accel[1] = cos(accel);
+  }
+
+  /**
+   * @brief Computes the true motion at the current step
+   */
+  void evaluate() {
+    const num_t time = static_cast<num_t>(m_step) * m_deltaT;
+    const num_t shakeOmega = 2 * PI * m_motion.shakeFreq;
+    const num_t accelOmega = 2 * PI * m_motion.accelFreq;
+
+    const num_t initial[3] = {x(m_motion.initialAngles),
+                              y(m_motion.initialAngles),
+                              z(m_motion.initialAngles)};
+    const num_t rate[3] = {x(m_motion.angleRate), y(m_motion.angleRate),
+                           z(m_motion.angleRate)};
+    const num_t shakeAmp[3] = {x(m_motion.shakeAmplitude),
+                               y(m_motion.shakeAmplitude),
+                               z(m_motion.shakeAmplitude)};
+    const num_t accelAmp[3] = {x(m_motion.accelAmplitude),
+                               y(m_motion.accelAmplitude),
+                               z(m_motion.accelAmplitude)};
+
+    num_t halfSin[3];
+    num_t halfCos[3];
+    num_t angleRate[3];
+    num_t linear[3];
+    num_t velocity[3];
+    for (unsigned int i = 0; i < 3; i++) {
+      // sin and cos of each axis's phase, by angle addition
+      const num_t shakeSin =
+          m_shake[0] * m_phase[i][1] + m_shake[1] * m_phase[i][0];
+      const num_t shakeCos =
+          m_shake[1] * m_phase[i][1] - m_shake[0] * m_phase[i][0];
+      const num_t accelSin =
+          m_accel[0] * m_phase[i][1] + m_accel[1] * m_phase[i][0];
+      const num_t accelCos =
+          m_accel[1] * m_phase[i][1] - m_accel[0] * m_phase[i][0];
+
+      const num_t angle = initial[i] + rate[i] * time + shakeAmp[i] * shakeSin;
+      halfSin[i] = sin(angle / 2);
+      halfCos[i] = cos(angle / 2);
+      angleRate[i] = rate[i] + shakeAmp[i] * shakeOmega * shakeCos;
+
+      linear[i] = accelAmp[i] * accelSin;
+      velocity[i] = accelOmega > 0
+                        ? accelAmp[i] / accelOmega * (m_phase[i][1] - accelCos)
+                        : 0;
+    }
+
+    // q = yaw * pitch * roll
+    const num_t sr = halfSin[0];
+    const num_t cr = halfCos[0];
+    const num_t sp = halfSin[1];
+    const num_t cp = halfCos[1];
+    const num_t sy = halfSin[2];
+    const num_t cy = halfCos[2];
+    m_sample.orientation = Quaternion{
+        cr * cp * cy + sr * sp * sy,
+        Vector3D{sr * cp * cy - cr * sp * sy, cr * sp * cy + sr * cp * sy,
+                 cr * cp * sy - sr * sp * cy}};
+
+    // body angular velocity from the Euler angle rates, with full angle sin
+    // and cos from the half angles
+    const num_t sinRoll = 2 * sr * cr;
+    const num_t cosRoll = cr * cr - sr * sr;
+    const num_t sinPitch = 2 * sp * cp;
+    const num_t cosPitch = cp * cp - sp * sp;
+    const num_t rollRate = angleRate[0];
+    const num_t pitchRate = angleRate[1];
+    const num_t yawRate = angleRate[2];
+    m_sample.angularVel =
+        Vector3D{rollRate - yawRate * sinPitch,
+                 pitchRate * cosRoll + yawRate * sinRoll * cosPitch,
+                 yawRate * cosRoll * cosPitch - pitchRate * sinRoll};
+
+    m_sample.time = time;
+    m_sample.deltaT = m_deltaT;
+    m_sample.linearAccel = Vector3D{linear[0], linear[1], linear[2]};
+    m_sample.velocity = Vector3D{velocity[0], velocity[1], velocity[2]};
+  }
+
+  /**
+   * @brief Gets the noise-free accelerometer reading of the current step
+   */
+  Vector3D trueAccel() const {
+    const Vector3D accelWorld =
+        Vector3D{0, 0, -m_motion.gravity} - m_sample.linearAccel;
+    return m_sample.orientation.conj().rotate(accelWorld);
+  }
+
+  /**
+   * @brief Computes the sensor readings of the current step
+   */
+  void sense() {
+    m_sample.gyro = m_sample.angularVel + m_sensor.gyroBias;
+    m_sample.accel = trueAccel() + m_sensor.accelBias;
+
+    if (m_sensor.gyroNoise > 0) {
+      m_sample.gyro += noise() * m_sensor.gyroNoise;
+    }
+    if (m_sensor.accelNoise > 0) {
+      m_sample.accel += noise() * m_sensor.accelNoise;
+    }
+
+    m_sample.gyroDropped = false;
+    m_sample.accelDropped = false;
+    if (m_sensor.dropout > 0) {
+      if (m_rng.uniform() <= m_sensor.dropout) {
+        m_sample.gyro = Vector3D{};
+        m_sample.gyroDropped = true;
+      }
+      if (m_rng.uniform() <= m_sensor.dropout) {
+        m_sample.accel = Vector3D{};
+        m_sample.accelDropped = true;
+      }
+    }
+  }
+
+  /**
+   * @brief Gets a vector of standard normal values
+   */
+  Vector3D noise() {
+    const num_t nx = gaussian();
+    const num_t ny = gaussian();
+    const num_t nz = gaussian();
+    return Vector3D{nx, ny, nz};
+  }
+
+  /**
+   * @brief Gets a standard normal value with Marsaglia's polar method
+   */
+  num_t gaussian() {
+    if (m_hasSpare) {
+      m_hasSpare = false;
+      return m_spare;
+    }
+
+    // uniform point in the unit circle, which avoids the sin() and cos() of
+    // the Box-Muller transform
+    num_t u;
+    num_t v;
+    num_t radiusSq;
+    do {
+      u = 2 * m_rng.uniform() - 1;
+      v = 2 * m_rng.uniform() - 1;
+      radiusSq = u * u + v * v;
+    } while (radiusSq >= 1 || radiusSq == 0);
+
+    const num_t scale = sqrt(-2 * MathUtil::fastLog(radiusSq) / radiusSq);
+    m_spare = v * scale;
+    m_hasSpare = true;
+    return u * scale;
+  }
+};
+} // namespace imunano33
+
+#endif
@@ -0,0 +1,251 @@
+/**
+ * @file
+ * @brief File containing the imunano33::StationaryDetector class
+ */
+
+#ifndef INCLUDE_IMUNANO33_STATIONARY_HPP_
+#define INCLUDE_IMUNANO33_STATIONARY_HPP_
+
+#include "imunano33/rolling.hpp"
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Detects whether an IMU is at rest from the spread of its recent
+ * gyroscope and accelerometer readings.
+ *
+ * The detector keeps the last N gyro readings and the last N accelerometer
+ * readings in two fixed rings, and maintains the mean and variance of each
+ * axis with WindowMoments, so every update is O(1) and nothing is allocated.
+ * The device is considered stationary when both windows are full, the total
+ * gyro variance and the relative accelerometer variance are below their
+ * thresholds, and the mean gyro reading is small enough to be a sensor bias
+ * rather than a slow, steady rotation.
+ *
+ * While stationary, the mean of the gyro window is an estimate of the gyro
+ * bias.
+ *
+ * @tparam N Number of samples in each window.
+ */
+template <unsigned int N> class StationaryDetector {
+public:
+  static_assert(N > 1, "Window must hold at least two samples");
+
+  /**
+   * @brief Default constructor
+   *
+   * Sets the gyro variance threshold to 0.0001 (rad/s)^2, the relative
+   * accelerometer variance threshold to 0.0001, and the maximum bias to 0.1
+   * rad/s.
+   */
+  StationaryDetector()
+#ifdef IMUNANO33_FLOAT
+      : m_gyroThreshold{0.0001F}, m_accelThreshold{0.0001F}, m_maxBias{0.1F}
+#else
+      : m_gyroThreshold{0.0001}, m_accelThreshold{0.0001}, m_maxBias{0.1}
+#endif
+  {
+  }
+
+  /**
+   * @brief Constructor
+   *
+   * @param gyroThreshold Largest total gyro variance, in (rad/s)^2, that is
+   * still counted as stationary.
+   * @param accelThreshold Largest accelerometer variance, relative to the
+   * squared magnitude of the mean acceleration, that is still counted as
+   * stationary. This makes the threshold independent of the accelerometer
+   * unit.
+   * @param maxBias Largest mean gyro magnitude, in rad/s, that is still
+   * counted as bias rather than rotation.
+   */
+  StationaryDetector(const num_t gyroThreshold, const num_t accelThreshold,
+                     const num_t maxBias)
+      : m_gyroThreshold{gyroThreshold}, m_accelThreshold{accelThreshold},
+        m_maxBias{maxBias} {}
+
+  /**
+   * @brief Adds a gyroscope reading to the gyro window
+   *
+   * @param gyro Gyroscope reading (in rad/s)
+   */
+  void updateGyro(const Vector3D &gyro) { m_gyro.push(gyro); }
+
+  /**
+   * @brief Adds an accelerometer reading to the accelerometer window
+   *
+   * @param accel Accelerometer reading, in any unit
+   */
+  void updateAccel(const Vector3D &accel) { m_accel.push(accel); }
+
+  /**
+   * @brief Determines if the device is currently at rest
+   *
+   * @returns If both windows are full and their readings are steady.
+   */
+  bool isStationary() const {
+    if (!m_gyro.full() || !m_accel.full()) {
+      return false;
+    }
+
+    const Vector3D gyroMean = m_gyro.mean();
+    if (dot(gyroMean, gyroMean) > m_maxBias * m_maxBias) {
+      return false;
+    }
+
+    return getGyroVariance() < m_gyroThreshold &&
+           getAccelVariance() < m_accelThreshold;
+  }
+
+  /**
+   * @brief Gets mean of the gyro window
+   *
+   * While isStationary() is true, this is the gyro bias.
+   *
+   * @returns Mean gyro reading, in rad/s
+   */
+  Vector3D getGyroMean() const { return m_gyro.mean(); }
+
+  /**
+   * @brief Gets mean of the accelerometer window
+   *
+   * While isStationary() is true, this is the gravity vector in the body frame.
+   *
+   * @returns Mean accelerometer reading
+   */
+  Vector3D getAccelMean() const { return m_accel.mean(); }
+
+  /**
+   * @brief Gets total variance of the gyro window
+   *
+   * @returns Sum of the per-axis variances, in (rad/s)^2
+   */
+  num_t getGyroVariance() const { return m_gyro.variance(); }
+
+  /**
+   * @brief Gets relative variance of the accelerometer window
+   *
+   * @returns Sum of the per-axis variances divided by the squared magnitude of
+   * the mean reading, or 0 if the mean is zero.
+   */
+  num_t getAccelVariance() const {
+    const Vector3D mean = m_accel.mean();
+    const num_t meanSq = dot(mean, mean);
+    return meanSq > 0 ? m_accel.variance() / meanSq : 0;
+  }
+
+  /**
+   * @brief Sets gyro variance threshold
+   *
+   * @param threshold Largest total gyro variance, in (rad/s)^2, that is still
+   * counted as stationary.
+   */
+  void setGyroThreshold(const num_t threshold) { m_gyroThreshold = threshold; }
+
+  /**
+   * @brief Sets accelerometer variance threshold
+   *
+   * @param threshold Largest relative accelerometer variance that is still
+   * counted as stationary.
+   */
+  void setAccelThreshold(const num_t threshold) {
+    m_accelThreshold = threshold;
+  }
+
+  /**
+   * @brief Sets largest gyro bias
+   *
+   * @param maxBias Largest mean gyro magnitude, in rad/s, that is still counted
+   * as bias rather than rotation.
+   */
+  void setMaxBias(const num_t maxBias) { m_maxBias = maxBias; }
+
+  /**
+   * @brief Clears both windows
+   *
+   * isStationary() will be false until both windows are full again.
+   */
+  void reset() {
+    m_gyro.reset();
+    m_accel.reset();
+  }
+
+private:
+  /**
+   * @brief Fixed ring of 3D samples with a sliding mean and variance
+   */
+  class Window {
+  public:
+    Window() { reset(); }
+
+    void push(const Vector3D &vec) {
+      const num_t sample[3] = {x(vec), y(vec), z(vec)};
+
+      if (m_count < N) {
+        ++m_count;
+        for (unsigned int i = 0; i < 3; i++) {
+          m_moments[i].add(sample[i], m_count);
+        }
+      } else {
+        for (unsigned int i = 0; i < 3; i++) {
+          m_moments[i].replace(m_samples[m_head][i], sample[i]);
+        }
+      }
+      for (unsigned int i = 0; i < 3; i++) {
+        m_samples[m_head][i] = sample[i];
+      }
+
+      m_head = (m_head + 1) % N;
+      if (m_head == 0 && m_count == N) {
+        for (unsigned int i = 0; i < 3; i++) {
+          m_moments[i].resync(&m_samples[0][i], 3);
+        }
+      }
+    }
+
+    bool full() const { return m_count == N; }
+
+    Vector3D mean() const {
+      return Vector3D{m_moments[0].getMean(), m_moments[1].getMean(),
+                      m_moments[2].getMean()};
+    }
+
+    num_t variance() const {
+      if (m_count < 2) {
+        return 0;
+      }
+
+      const num_t total =
+          m_moments[0].getM2() + m_moments[1].getM2() + m_moments[2].getM2();
+      return total > 0 ? total / static_cast<num_t>(m_count) : 0;
+    }
+
+    void reset() {
+      m_count = 0;
+      m_head = 0;
+      for (unsigned int i = 0; i < 3; i++) {
+        m_moments[i].reset();
+        for (unsigned int j = 0; j < N; j++) {
+          m_samples[j][i] = 0;
+        }
+      }
+    }
+
+  private:
+    num_t m_samples[N][3];
+    WindowMoments<N> m_moments[3];
+    unsigned int m_count;
+    unsigned int m_head;
+  };
+
+  num_t m_gyroThreshold;
+  num_t m_accelThreshold;
+  num_t m_maxBias;
+
+  Window m_gyro;
+  Window m_accel;
+};
+} // namespace imunano33
+
+#endif
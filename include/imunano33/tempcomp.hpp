@@ -0,0 +1,379 @@
+/**
+ * @file
+ * @brief File containing the imunano33::TempCompensation class
+ */
+
+#ifndef INCLUDE_IMUNANO33_TEMPCOMP_HPP_
+#define INCLUDE_IMUNANO33_TEMPCOMP_HPP_
+
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Corrects temperature-dependent bias and scale errors of a 3-axis
+ * sensor
+ *
+ * Each axis is corrected as raw * scale(T) - offset(T), where scale and offset
+ * are polynomials of degree D in the temperature difference T - T0 from a
+ * reference temperature T0. Both polynomials are evaluated once whenever the
+ * temperature changes (see setTemp()), so correcting a reading is only a
+ * multiply and a subtract per axis.
+ *
+ * The coefficients can be fit from recorded data with Calibrator.
+ *
+ * By default, the scale is 1 and the offset is 0 at every temperature, so
+ * readings are unchanged.
+ *
+ * @tparam D Degree of the polynomials.
+ */
+template <unsigned int D> class TempCompensation {
+public:
+  /**
+   * @brief Number of coefficients in each polynomial
+   */
+  static constexpr unsigned int NUM_COEFFS = D + 1;
+
+  /**
+   * @brief Default constructor
+   *
+   * Sets the reference temperature to 25 C, with no correction.
+   */
+  TempCompensation() {
+    for (unsigned int axis = 0; axis < 3; axis++) {
+      for (unsigned int i = 0; i < NUM_COEFFS; i++) {
+        m_scaleCoeffs[axis][i] = i == 0 ? 1 : 0;
+        m_offsetCoeffs[axis][i] = 0;
+      }
+    }
+    setTemp(m_refTemp);
+  }
+
+  /**
+   * @brief Sets the polynomials of an axis
+   *
+   * The current correction is recomputed at the latest temperature.
+   *
+   * @param axis Axis to set, 0 for x, 1 for y, and 2 for z
+   * @param scale Coefficients of the scale polynomial, from the constant term
+   * up
+   * @param offset Coefficients of the offset polynomial, from the constant term
+   * up, in the unit of the readings
+   */
+  void setCoefficients(const unsigned int axis,
+                       const num_t (&scale)[NUM_COEFFS],
+                       const num_t (&offset)[NUM_COEFFS]) {
+    for (unsigned int i = 0; i < NUM_COEFFS; i++) {
+      m_scaleCoeffs[axis][i] = scale[i];
+      m_offsetCoeffs[axis][i] = offset[i];
+    }
+    setTemp(m_temp);
+  }
+
+  /**
+   * @brief Gets a coefficient of the scale polynomial
+   *
+   * @param axis Axis, 0 for x, 1 for y, and 2 for z
+   * @param i Power of the term
+   *
+   * @returns Coefficient
+   */
+  num_t getScaleCoefficient(const unsigned int axis,
+                            const unsigned int i) const {
+    return m_scaleCoeffs[axis][i];
+  }
+
+  /**
+   * @brief Gets a coefficient of the offset polynomial
+   *
+   * @param axis Axis, 0 for x, 1 for y, and 2 for z
+   * @param i Power of the term
+   *
+   * @returns Coefficient
+   */
+  num_t getOffsetCoefficient(const unsigned int axis,
+                             const unsigned int i) const {
+    return m_offsetCoeffs[axis][i];
+  }
+
+  /**
+   * @brief Sets the reference temperature of the polynomials
+   *
+   * @param refTemp Reference temperature, in C
+   */
+  void setReferenceTemp(const num_t refTemp) {
+    m_refTemp = refTemp;
+    setTemp(m_temp);
+  }
+
+  /**
+   * @brief Gets the reference temperature of the polynomials
+   *
+   * @returns Reference temperature, in C
+   */
+  num_t getReferenceTemp() const { return m_refTemp; }
+
+  /**
+   * @brief Sets the current sensor temperature
+   *
+   * Evaluates the polynomials at the temperature, which are used by every
+   * apply() until the next call.
+   *
+   * @param temp Temperature, in C
+   */
+  void setTemp(const num_t temp) {
+    m_temp = temp;
+    const num_t dt = temp - m_refTemp;
+
+    for (unsigned int axis = 0; axis < 3; axis++) {
+      num_t scale = 0;
+      num_t offset = 0;
+      for (unsigned int i = NUM_COEFFS; i-- > 0;) {
+        scale = scale * dt + m_scaleCoeffs[axis][i];
+        offset = offset * dt + m_offsetCoeffs[axis][i];
+      }
+      m_scale[axis] = scale;
+      m_offset[axis] = offset;
+    }
+  }
+
+  /**
+   * @brief Gets the current sensor temperature
+   *
+   * @returns Temperature, in C
+   */
+  num_t getTemp() const { return m_temp; }
+
+  /**
+   * @brief Corrects a reading at the current temperature
+   *
+   * @param raw Reading from the sensor
+   *
+   * @returns Corrected reading
+   */
+  Vector3D apply(const Vector3D &raw) const {
+    return Vector3D{x(raw) * m_scale[0] - m_offset[0],
+                    y(raw) * m_scale[1] - m_offset[1],
+                    z(raw) * m_scale[2] - m_offset[2]};
+  }
+
+  /**
+   * @brief Fits the polynomials from recorded readings
+   *
+   * Each sample is a raw reading at a temperature, along with the reading that
+   * it should have been. For a gyroscope at rest, that is zero, and for an
+   * accelerometer at rest, that is gravity in the body frame.
+   *
+   * Samples are accumulated into the normal equations of the least squares
+   * problem, so memory use does not depend on the number of samples.
+   *
+   * If every reference reading on an axis is zero, the scale cannot be
+   * determined, so only fit the offset (see the constructor).
+   */
+  class Calibrator {
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param fitScale Whether to fit the scale polynomials. If false, the
+     * scale is 1 at every temperature and only the offset is fit.
+     * @param refTemp Reference temperature of the fitted polynomials, in C.
+     * This should be near the middle of the recorded temperatures.
+     */
+    explicit Calibrator(const bool fitScale = true,
+#ifdef IMUNANO33_FLOAT
+                        const num_t refTemp = 25.0F)
+#else
+                        const num_t refTemp = 25.0)
+#endif
+        : m_fitScale{fitScale}, m_refTemp{refTemp} {
+      reset();
+    }
+
+    /**
+     * @brief Adds a sample
+     *
+     * @param temp Temperature of the sensor, in C
+     * @param raw Reading from the sensor
+     * @param reference What the reading should have been
+     */
+    void addSample(const num_t temp, const Vector3D &raw,
+                   const Vector3D &reference) {
+      const num_t rawAxes[3] = {x(raw), y(raw), z(raw)};
+      const num_t refAxes[3] = {x(reference), y(reference), z(reference)};
+      const num_t dt = temp - m_refTemp;
+
+      for (unsigned int axis = 0; axis < 3; axis++) {
+        // reference = sum(s_i dt^i) * raw - sum(o_i dt^i), which is linear in
+        // the unknowns s_i and o_i
+        num_t features[2 * NUM_COEFFS];
+        num_t power = 1;
+        for (unsigned int i = 0; i < NUM_COEFFS; i++) {
+          features[i] = -power;
+          features[NUM_COEFFS + i] = power * rawAxes[axis];
+          power *= dt;
+        }
+
+        num_t target = refAxes[axis];
+        if (!m_fitScale) {
+          // scale is 1, so reference - raw = -sum(o_i dt^i)
+          target -= rawAxes[axis];
+        }
+
+        const unsigned int n = numUnknowns();
+        for (unsigned int i = 0; i < n; i++) {
+          for (unsigned int j = 0; j < n; j++) {
+            m_ata[axis][i][j] += features[i] * features[j];
+          }
+          m_atb[axis][i] += features[i] * target;
+        }
+      }
+
+      ++m_count;
+    }
+
+    /**
+     * @brief Gets number of samples added
+     *
+     * @returns Number of samples since construction or reset()
+     */
+    unsigned long getCount() const { return m_count; }
+
+    /**
+     * @brief Fits the polynomials to the samples
+     *
+     * @param comp Compensation to write the fitted polynomials and reference
+     * temperature to. It is only changed if the fit succeeds.
+     *
+     * @returns If the fit succeeded. This fails if the samples do not cover
+     * enough distinct temperatures (and readings, if fitting the scale) to
+     * determine every coefficient.
+     */
+    bool fit(TempCompensation &comp) const {
+      num_t solved[3][2 * NUM_COEFFS];
+      for (unsigned int axis = 0; axis < 3; axis++) {
+        if (!solve(axis, solved[axis])) {
+          return false;
+        }
+      }
+
+      comp.m_refTemp = m_refTemp;
+      for (unsigned int axis = 0; axis < 3; axis++) {
+        num_t scale[NUM_COEFFS];
+        num_t offset[NUM_COEFFS];
+        for (unsigned int i = 0; i < NUM_COEFFS; i++) {
+          offset[i] = solved[axis][i];
+          scale[i] = m_fitScale ? solved[axis][NUM_COEFFS + i] : i == 0 ? 1 : 0;
+        }
+        comp.setCoefficients(axis, scale, offset);
+      }
+
+      return true;
+    }
+
+    /**
+     * @brief Removes all samples
+     */
+    void reset() {
+      m_count = 0;
+      for (unsigned int axis = 0; axis < 3; axis++) {
+        for (unsigned int i = 0; i < 2 * NUM_COEFFS; i++) {
+          for (unsigned int j = 0; j < 2 * NUM_COEFFS; j++) {
+            m_ata[axis][i][j] = 0;
+          }
+          m_atb[axis][i] = 0;
+        }
+      }
+    }
+
+  private:
+    unsigned int numUnknowns() const {
+      return m_fitScale ? 2 * NUM_COEFFS : NUM_COEFFS;
+    }
+
+    /**
+     * @brief Solves the normal equations of an axis with Gaussian elimination
+     */
+    bool solve(const unsigned int axis, num_t *out) const {
+      const unsigned int n = numUnknowns();
+      num_t mat[2 * NUM_COEFFS][2 * NUM_COEFFS + 1];
+      num_t largest = 0;
+      for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = 0; j < n; j++) {
+          mat[i][j] = m_ata[axis][i][j];
+        }
+        mat[i][n] = m_atb[axis][i];
+        largest = mat[i][i] > largest ? mat[i][i] : largest;
+      }
+
+      for (unsigned int col = 0; col < n; col++) {
+        unsigned int pivot = col;
+        for (unsigned int row = col + 1; row < n; row++) {
+          if (abs(mat[row][col]) > abs(mat[pivot][col])) {
+            pivot = row;
+          }
+        }
+
+        // singular relative to the size of the matrix
+#ifdef IMUNANO33_FLOAT
+        if (abs(mat[pivot][col]) <= largest * 1e-6F) {
+#else
+        if (abs(mat[pivot][col]) <= largest * 1e-12) {
+#endif
+          return false;
+        }
+
+        for (unsigned int j = col; j <= n; j++) {
+          const num_t tmp = mat[col][j];
+          mat[col][j] = mat[pivot][j];
+          mat[pivot][j] = tmp;
+        }
+
+        for (unsigned int row = col + 1; row < n; row++) {
+          const num_t factor = mat[row][col] / mat[col][col];
+          for (unsigned int j = col; j <= n; j++) {
+            mat[row][j] -= factor * mat[col][j];
+          }
+        }
+      }
+
+      for (unsigned int i = n; i-- > 0;) {
+        num_t sum = mat[i][n];
+        for (unsigned int j = i + 1; j < n; j++) {
+          sum -= mat[i][j] * out[j];
+        }
+        out[i] = sum / mat[i][i];
+      }
+
+      return true;
+    }
+
+    static num_t abs(const num_t num) { return num < 0 ? -num : num; }
+
+    bool m_fitScale;
+    num_t m_refTemp;
+    unsigned long m_count;
+
+    num_t m_ata[3][2 * NUM_COEFFS][2 * NUM_COEFFS];
+    num_t m_atb[3][2 * NUM_COEFFS];
+  };
+
+private:
+#ifdef IMUNANO33_FLOAT
+  num_t m_refTemp = 25.0F;
+  num_t m_temp = 25.0F;
+#else
+  num_t m_refTemp = 25.0;
+  num_t m_temp = 25.0;
+#endif
+
+  num_t m_scaleCoeffs[3][NUM_COEFFS];
+  num_t m_offsetCoeffs[3][NUM_COEFFS];
+
+  // polynomials evaluated at m_temp
+  num_t m_scale[3];
+  num_t m_offset[3];
+};
+} // namespace imunano33
+
+#endif
@@ -0,0 +1,448 @@
+/**
+ * @file
+ * @brief File containing the optional tracing of filter internals
+ *
+ * Tracing is only compiled in if IMUNANO33_TRACE is defined before including
+ * the library. Otherwise, IMUNANO33_TRACE_GYRO() and IMUNANO33_TRACE_ACCEL()
+ * expand to nothing, so there is no cost at all. When compiled in, tracing
+ * costs a single pointer check per update until a sink is attached with
+ * imunano33::Trace::setSink().
+ *
+ * Every gyro and accelerometer update of every imunano33::Filter is written to
+ * the sink as a fixed-size imunano33::TraceRecord. imunano33::TraceRing keeps
+ * the latest records in a preallocated ring, and can stop recording a given
+ * number of records after a trigger, so it holds the records around the
+ * trigger. On hosts, the ring can then be written as Chrome trace JSON with
+ * imunano33::writeChromeTrace(), which can be opened in Perfetto
+ * (https://ui.perfetto.dev) or chrome://tracing.
+ *
+ * Timestamps are in nanoseconds, read with IMUNANO33_TRACE_NOW(). On hosts,
+ * this defaults to std::chrono::steady_clock, and in embedded systems, to
+ * Arduino's micros(). Define it before including the library to use another
+ * clock.
+ */
+
+#ifndef INCLUDE_IMUNANO33_TRACE_HPP_
+#define INCLUDE_IMUNANO33_TRACE_HPP_
+
+#ifdef IMUNANO33_TRACE
+
+#ifndef IMUNANO33_EMBED
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#endif
+
+#include "imunano33/quaternion.hpp"
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+#ifndef IMUNANO33_TRACE_NOW
+#ifdef IMUNANO33_EMBED
+/**
+ * @brief Current time in nanoseconds
+ */
+#define IMUNANO33_TRACE_NOW()                                                  \
+  (static_cast<unsigned long long>(micros()) * 1000ULL)
+#else
+/**
+ * @brief Current time in nanoseconds
+ */
+#define IMUNANO33_TRACE_NOW()                                                  \
+  static_cast<unsigned long long>(                                             \
+      std::chrono::duration_cast<std::chrono::nanoseconds>(                    \
+          std::chrono::steady_clock::now().time_since_epoch())                 \
+          .count())
+#endif
+#endif
+
+namespace imunano33 {
+/**
+ * @brief Traced updates
+ */
+enum TraceEvent {
+  GYRO_TRACE, //!< Filter::updateGyro()
+  ACCEL_TRACE //!< Filter::updateAccel()
+};
+
+/**
+ * @brief One traced update
+ *
+ * The meaning of values depends on the event:
+ *
+ * | Index | imunano33::GYRO_TRACE   | imunano33::ACCEL_TRACE    |
+ * |-------|-------------------------|---------------------------|
+ * | 0-3   | qGyroDelta w, x, y, z   | qAccelCur w, x, y, z      |
+ * | 4-6   | Bias-corrected gyro     | vecRotAxis x, y, z        |
+ * | 7     | Time step, in s         | rotAngle, in rad          |
+ *
+ * qGyroDelta is the rotation integrated from the reading, and qAccelCur is
+ * the gravity correction applied after it, which is the identity if the
+ * correction was skipped because vecRotAxis was zero.
+ */
+struct TraceRecord {
+  /**
+   * @brief Number of values
+   */
+  static constexpr unsigned int NUM_VALUES = 8;
+
+  unsigned long long timeNs; //!< Time of the update, in ns
+  TraceEvent event;          //!< Traced update
+  num_t values[NUM_VALUES];  //!< Intermediate values of the update
+};
+
+/**
+ * @brief Receives trace records
+ */
+class TraceSink {
+public:
+  /**
+   * @brief Destructor
+   */
+  virtual ~TraceSink() = default;
+
+  /**
+   * @brief Receives a record
+   *
+   * @param record Record of the latest update
+   */
+  virtual void record(const TraceRecord &record) = 0;
+};
+
+/**
+ * @brief Access to the trace sink
+ */
+class Trace {
+public:
+  /**
+   * @brief Sets where records are written
+   *
+   * @param sink Sink to write to, which must outlive its use, or nullptr to
+   * stop tracing
+   */
+  static void setSink(TraceSink *sink) { sinkRef() = sink; }
+
+  /**
+   * @brief Gets where records are written
+   *
+   * @returns Sink, or nullptr if tracing is stopped
+   */
+  static TraceSink *getSink() { return sinkRef(); }
+
+  /**
+   * @brief Traces a gyro update
+   *
+   * @param qGyroDelta Rotation integrated from the reading
+   * @param gyro Bias-corrected gyro reading, in rad/s
+   * @param time Time step, in s
+   */
+  static void gyro(const Quaternion &qGyroDelta, const Vector3D &gyro,
+                   const num_t time) {
+    TraceSink *const sink = sinkRef();
+    if (sink == nullptr) {
+      return;
+    }
+
+    sink->record(makeRecord(GYRO_TRACE, qGyroDelta, gyro, time));
+  }
+
+  /**
+   * @brief Traces an accelerometer update
+   *
+   * @param qAccelCur Gravity correction that was applied
+   * @param vecRotAxis Axis of the correction
+   * @param rotAngle Angle between the estimated and true gravity, in rad
+   */
+  static void accel(const Quaternion &qAccelCur, const Vector3D &vecRotAxis,
+                    const num_t rotAngle) {
+    TraceSink *const sink = sinkRef();
+    if (sink == nullptr) {
+      return;
+    }
+
+    sink->record(makeRecord(ACCEL_TRACE, qAccelCur, vecRotAxis, rotAngle));
+  }
+
+private:
+  static TraceSink *&sinkRef() {
+    static TraceSink *sink = nullptr;
+    return sink;
+  }
+
+  static TraceRecord makeRecord(const TraceEvent event, const Quaternion &q,
+                                const Vector3D &vec, const num_t scalar) {
+    TraceRecord record;
+    record.timeNs = IMUNANO33_TRACE_NOW();
+    record.event = event;
+    record.values[0] = q.w();
+    record.values[1] = x(q.vec());
+    record.values[2] = y(q.vec());
+    record.values[3] = z(q.vec());
+    record.values[4] = x(vec);
+    record.values[5] = y(vec);
+    record.values[6] = z(vec);
+    record.values[7] = scalar;
+    return record;
+  }
+};
+
+/**
+ * @brief Keeps the latest trace records in a preallocated ring
+ *
+ * Once full, every new record overwrites the oldest one. After trigger() is
+ * called, only the given number of records are added before the ring stops
+ * recording, so it ends up holding the records just before and after the
+ * trigger. Triggers can also fire automatically from a condition on each
+ * record (see setTriggerCondition()).
+ *
+ * @tparam N Number of records kept.
+ */
+template <unsigned int N> class TraceRing : public TraceSink {
+public:
+  static_assert(N > 0, "TraceRing needs a capacity of at least 1");
+
+  /**
+   * @brief Condition that fires a trigger
+   */
+  using Condition = bool (*)(const TraceRecord &record);
+
+  /**
+   * @brief Adds a record
+   *
+   * Does nothing if recording has stopped after a trigger.
+   *
+   * @param record Record to add
+   */
+  void record(const TraceRecord &record) override {
+    if (m_stopped) {
+      return;
+    }
+
+    m_records[m_next] = record;
+    m_next = m_next + 1 == N ? 0 : m_next + 1;
+    if (m_size < N) {
+      ++m_size;
+    }
+
+    if (m_triggered) {
+      if (--m_remaining == 0) {
+        m_stopped = true;
+      }
+    } else if (m_condition != nullptr && m_condition(record)) {
+      // the triggering record counts as the first record after the trigger
+      trigger(m_conditionAfter);
+      if (m_remaining > 0 && --m_remaining == 0) {
+        m_stopped = true;
+      }
+    }
+  }
+
+  /**
+   * @brief Fires the trigger
+   *
+   * Does nothing if the trigger already fired since construction or reset().
+   *
+   * @param after Number of records to add before recording stops. At most N,
+   * and 0 stops recording immediately.
+   */
+  void trigger(const unsigned int after = N / 2) {
+    if (m_triggered) {
+      return;
+    }
+
+    m_triggered = true;
+    m_triggerTimeNs = m_size > 0 ? at(m_size - 1).timeNs : 0;
+    m_remaining = after < N ? after : N;
+    m_stopped = m_remaining == 0;
+  }
+
+  /**
+   * @brief Fires the trigger automatically on a record
+   *
+   * The record the condition is true for is kept as the first record after
+   * the trigger.
+   *
+   * @param condition Condition checked on every record until the trigger
+   * fires, or nullptr to disable
+   * @param after See trigger().
+   */
+  void setTriggerCondition(const Condition condition,
+                           const unsigned int after = N / 2) {
+    m_condition = condition;
+    m_conditionAfter = after;
+  }
+
+  /**
+   * @brief Determines if the trigger fired
+   *
+   * @returns If the trigger fired since construction or reset()
+   */
+  bool triggered() const { return m_triggered; }
+
+  /**
+   * @brief Determines if recording stopped after the trigger
+   *
+   * @returns If the capture around the trigger is complete
+   */
+  bool stopped() const { return m_stopped; }
+
+  /**
+   * @brief Gets time of the trigger
+   *
+   * @returns Time of the latest record when the trigger fired, in ns
+   */
+  unsigned long long getTriggerTime() const { return m_triggerTimeNs; }
+
+  /**
+   * @brief Gets number of records kept
+   *
+   * @returns Number of records, at most N
+   */
+  unsigned int size() const { return m_size; }
+
+  /**
+   * @brief Gets capacity
+   *
+   * @returns N
+   */
+  static constexpr unsigned int capacity() { return N; }
+
+  /**
+   * @brief Gets a kept record
+   *
+   * @param i Index of the record, where 0 is the oldest. Must be less than
+   * size().
+   *
+   * @returns Record
+   */
+  const TraceRecord &at(const unsigned int i) const {
+    const unsigned int start = m_size < N ? 0 : m_next;
+    const unsigned int index = start + i;
+    return m_records[index < N ? index : index - N];
+  }
+
+  /**
+   * @brief Removes all records and rearms the trigger
+   *
+   * The trigger condition is kept.
+   */
+  void reset() {
+    m_next = 0;
+    m_size = 0;
+    m_triggered = false;
+    m_stopped = false;
+    m_remaining = 0;
+    m_triggerTimeNs = 0;
+  }
+
+private:
+  TraceRecord m_records[N];
+  unsigned int m_next{0};
+  unsigned int m_size{0};
+
+  bool m_triggered{false};
+  bool m_stopped{false};
+  unsigned int m_remaining{0};
+  unsigned long long m_triggerTimeNs{0};
+
+  Condition m_condition{nullptr};
+  unsigned int m_conditionAfter{N / 2};
+};
+
+#ifndef IMUNANO33_EMBED
+/**
+ * @brief Writes kept records in the Chrome trace event format
+ *
+ * Each record becomes a set of counter events, so every intermediate value
+ * is plotted as its own track. If the trigger fired, it is marked with an
+ * instant event. Times are relative to the oldest record.
+ *
+ * @param out Stream to write JSON to
+ * @param ring Ring of records
+ */
+template <unsigned int N>
+void writeChromeTrace(std::ostream &out, const TraceRing<N> &ring) {
+  const unsigned long long start = ring.size() > 0 ? ring.at(0).timeNs : 0;
+
+  // timestamps are in us, with ns as the fraction
+  const auto writeTime = [&out, start](const unsigned long long ns) {
+    const unsigned long long rel = ns > start ? ns - start : 0;
+    const unsigned long long frac = rel % 1000;
+    out << rel / 1000 << '.' << frac / 100 << frac / 10 % 10 << frac % 10;
+  };
+
+  // NaN and infinity are not valid JSON
+  const auto writeNum = [&out](const num_t num) {
+    if (std::isfinite(num)) {
+      out << num;
+    } else {
+      out << "null";
+    }
+  };
+
+  const auto writeCounter = [&](const TraceRecord &record, const char *name,
+                                const unsigned int first,
+                                const unsigned int count) {
+    static const char *const keys[] = {"w", "x", "y", "z"};
+    out << ",\n{\"name\":\"" << name << "\",\"ph\":\"C\",\"pid\":1,\"ts\":";
+    writeTime(record.timeNs);
+    out << ",\"args\":{";
+    for (unsigned int i = 0; i < count; i++) {
+      const char *const key = count == 1 ? "value" : keys[4 - count + i];
+      out << (i == 0 ? "\"" : ",\"") << key << "\":";
+      writeNum(record.values[first + i]);
+    }
+    out << "}}";
+  };
+
+  const std::streamsize precision = out.precision(9);
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+         "\"args\":{\"name\":\"imunano33::Filter\"}}";
+
+  for (unsigned int i = 0; i < ring.size(); i++) {
+    const TraceRecord &record = ring.at(i);
+    if (record.event == GYRO_TRACE) {
+      writeCounter(record, "qGyroDelta", 0, 4);
+      writeCounter(record, "gyro", 4, 3);
+      writeCounter(record, "deltaT", 7, 1);
+    } else {
+      writeCounter(record, "qAccelCur", 0, 4);
+      writeCounter(record, "vecRotAxis", 4, 3);
+      writeCounter(record, "rotAngle", 7, 1);
+    }
+  }
+
+  if (ring.triggered()) {
+    out << ",\n{\"name\":\"trigger\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,"
+           "\"ts\":";
+    writeTime(ring.getTriggerTime());
+    out << "}";
+  }
+
+  out << "\n]}\n";
+  out.precision(precision);
+}
+#endif
+} // namespace imunano33
+
+/**
+ * @brief Traces a gyro update, see imunano33::Trace::gyro()
+ */
+#define IMUNANO33_TRACE_GYRO(delta, reading, step)                             \
+  ::imunano33::Trace::gyro(delta, reading, step)
+
+/**
+ * @brief Traces an accelerometer update, see imunano33::Trace::accel()
+ */
+#define IMUNANO33_TRACE_ACCEL(correction, axis, angle)                         \
+  ::imunano33::Trace::accel(correction, axis, angle)
+
+#else
+
+#define IMUNANO33_TRACE_GYRO(delta, reading, step) static_cast<void>(0)
+#define IMUNANO33_TRACE_ACCEL(correction, axis, angle) static_cast<void>(0)
+
+#endif
+
+#endif
@@ -7,6 +7,18 @@
 #ifndef INCLUDE_IMUNANO33_UNIT_HPP_
 #define INCLUDE_IMUNANO33_UNIT_HPP_
 
+#if defined(IMUNANO33_EMBED) && !defined(IMUNANO33_FLOAT)
+/**
+ * @brief Defined if imunano33::num_t is float
+ *
+ * This is always defined with IMUNANO33_EMBED. Define it before including the
+ * library to compute in single precision on other systems as well. As
+ * svector::Vector3D only holds doubles, the library then uses the vectors of
+ * IMUNANO33_POD_VECTORS.
+ */
+#define IMUNANO33_FLOAT
+#endif
+
 namespace imunano33 {
 /**
  * @brief An enumerator describing units of temperature values
@@ -28,10 +40,10 @@ enum PressureUnit {
   PSI   //!< Converts pressure to pounds per square inch
 };
 
-#ifdef IMUNANO33_EMBED
-using num_t = float; //!< Alias to number type depending on embed
+#ifdef IMUNANO33_FLOAT
+using num_t = float; //!< Alias to number type depending on precision
 #else
-using num_t = double; //!< Alias to number type depending on embed
+using num_t = double; //!< Alias to number type depending on precision
 #endif
 } // namespace imunano33
 
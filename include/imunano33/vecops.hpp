@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief File containing fused vector operations
+ *
+ * Every arithmetic operator of the vector types returns a new vector, so an
+ * expression like a * ka + b * kb + cross(c, d) * kc builds a temporary vector
+ * for each operator. These functions compute common compound expressions in
+ * one pass over the components, building only the result.
+ */
+
+#ifndef INCLUDE_IMUNANO33_VECOPS_HPP_
+#define INCLUDE_IMUNANO33_VECOPS_HPP_
+
+#include "imunano33/unit.hpp"
+#include "imunano33/vector.hpp"
+
+namespace imunano33 {
+/**
+ * @brief Linear combination of two vectors
+ *
+ * @param a First vector
+ * @param ka Scale of a
+ * @param b Second vector
+ * @param kb Scale of b
+ *
+ * @returns a * ka + b * kb
+ */
+inline Vector3D linComb(const Vector3D &a, const num_t ka, const Vector3D &b,
+                        const num_t kb) {
+  return Vector3D{x(a) * ka + x(b) * kb, y(a) * ka + y(b) * kb,
+                  z(a) * ka + z(b) * kb};
+}
+
+/**
+ * @brief Linear combination of three vectors
+ *
+ * @param a First vector
+ * @param ka Scale of a
+ * @param b Second vector
+ * @param kb Scale of b
+ * @param c Third vector
+ * @param kc Scale of c
+ *
+ * @returns a * ka + b * kb + c * kc
+ */
+inline Vector3D linComb(const Vector3D &a, const num_t ka, const Vector3D &b,
+                        const num_t kb, const Vector3D &c, const num_t kc) {
+  return Vector3D{x(a) * ka + x(b) * kb + x(c) * kc,
+                  y(a) * ka + y(b) * kb + y(c) * kc,
+                  z(a) * ka + z(b) * kb + z(c) * kc};
+}
+
+/**
+ * @brief Adds a scaled cross product to a vector
+ *
+ * @param base Vector to add to
+ * @param a Left hand argument of the cross product
+ * @param b Right hand argument of the cross product
+ * @param k Scale of the cross product
+ *
+ * @returns base + cross(a, b) * k
+ */
+inline Vector3D crossAdd(const Vector3D &base, const Vector3D &a,
+                         const Vector3D &b, const num_t k) {
+  const num_t ax = x(a);
+  const num_t ay = y(a);
+  const num_t az = z(a);
+  const num_t bx = x(b);
+  const num_t by = y(b);
+  const num_t bz = z(b);
+
+  return Vector3D{x(base) + (ay * bz - az * by) * k,
+                  y(base) + (az * bx - ax * bz) * k,
+                  z(base) + (ax * by - ay * bx) * k};
+}
+
+/**
+ * @brief Adds a scaled vector in place
+ *
+ * @param acc Vector to add to
+ * @param v Vector to add
+ * @param k Scale of v
+ */
+inline void addScaled(Vector3D &acc, const Vector3D &v, const num_t k) {
+  x(acc, x(acc) + x(v) * k);
+  y(acc, y(acc) + y(v) * k);
+  z(acc, z(acc) + z(v) * k);
+}
+} // namespace imunano33
+
+#endif
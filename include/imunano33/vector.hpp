@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @brief File choosing the imunano33::Vector3D type
+ *
+ * The vector type and the precision of num_t are chosen separately:
+ *
+ * * IMUNANO33_EMBED uses svector::EmbVec3D, which is free of the STL.
+ * * IMUNANO33_POD_VECTORS uses PodVec3D, a plain struct in the precision of
+ *   num_t, with or without IMUNANO33_EMBED.
+ * * Otherwise, svector::Vector3D is used, which holds doubles.
+ *
+ * See IMUNANO33_FLOAT for the precision.
+ */
+
+#ifndef INCLUDE_IMUNANO33_VECTOR_HPP_
+#define INCLUDE_IMUNANO33_VECTOR_HPP_
+
+#include "imunano33/unit.hpp"
+
+#if defined(IMUNANO33_FLOAT) && !defined(IMUNANO33_EMBED) &&                   \
+    !defined(IMUNANO33_POD_VECTORS)
+/**
+ * @brief Defined if the library uses PodVec3D as its vector type
+ *
+ * Define this before including the library to use plain structs of num_t as
+ * vectors rather than svector::Vector3D, whose copies go through std::array and
+ * its iterators, or svector::EmbVec3D, which has a virtual destructor. It is
+ * defined with IMUNANO33_FLOAT outside IMUNANO33_EMBED, as svector::Vector3D
+ * only holds doubles.
+ */
+#define IMUNANO33_POD_VECTORS
+#endif
+
+#ifdef IMUNANO33_POD_VECTORS
+#include "imunano33/podvector.hpp"
+#elif defined(IMUNANO33_EMBED)
+#include "imunano33/sv_embed.hpp"
+#else
+#include "imunano33/simplevectors.hpp"
+#endif
+
+namespace imunano33 {
+#ifdef IMUNANO33_POD_VECTORS
+using Vector3D = PodVec3D; //!< Alias to vector type with plain vectors
+#elif defined(IMUNANO33_EMBED)
+using Vector3D =
+    svector::EmbVec3D; //!< Alias to vector type in embedded systems
+#else
+using svector::Vector3D;
+#endif
+} // namespace imunano33
+
+#endif
@@ -2,6 +2,10 @@
  * This file is solely for clang-tidy to analyze the imunano33 library.
  */
 
+#include <imunano33/constmath.hpp>
 #include <imunano33/imunano33.hpp>
+#include <imunano33/packedquat.hpp>
+#include <imunano33/series.hpp>
+#include <imunano33/simulate.hpp>
 
 int main() { return 0; }
@@ -0,0 +1,91 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <imunano33/altitude.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+double exactAltitude(double pressure, double seaLevel) {
+  return 44330.77 * (1 - std::pow(pressure / seaLevel, 0.190263));
+}
+
+// pressure at an altitude, inverse of exactAltitude()
+double pressureAt(double altitude, double seaLevel) {
+  return seaLevel * std::pow(1 - altitude / 44330.77, 1 / 0.190263);
+}
+
+// small deterministic jitter in [-amp, amp]
+double jitter(int i, double amp) { return amp * std::sin(i * 12.9898); }
+} // namespace
+
+TEST(AltitudeEstimator, PressureToAltitude) {
+  for (double p = 20; p <= 120; p += 0.01) {
+    EXPECT_NEAR(AltitudeEstimator::pressureToAltitude(p),
+                exactAltitude(p, 101.325), 0.06)
+        << "pressure: " << p;
+  }
+
+  EXPECT_NEAR(AltitudeEstimator::pressureToAltitude(101.325), 0, 0.06);
+  EXPECT_NEAR(AltitudeEstimator::pressureToAltitude(95, 95), 0, 0.06);
+
+  // outside the polynomial range
+  EXPECT_NEAR(AltitudeEstimator::pressureToAltitude(10),
+              exactAltitude(10, 101.325), numTol(0.0001, 0.001));
+}
+
+TEST(AltitudeEstimator, NoData) {
+  AltitudeEstimator est;
+  EXPECT_FALSE(est.dataExists());
+  est.updateAccel(1, 0.01);
+  EXPECT_EQ(est.getAltitude(), 0);
+  EXPECT_EQ(est.getVerticalSpeed(), 0);
+
+  est.updatePressure(pressureAt(100, 101.325));
+  EXPECT_TRUE(est.dataExists());
+  EXPECT_NEAR(est.getAltitude(), 100, 0.1);
+
+  est.reset();
+  EXPECT_FALSE(est.dataExists());
+}
+
+TEST(AltitudeEstimator, Climb) {
+  // climbing at 2 m/s, with noisy 25 Hz barometer and 100 Hz accelerometer
+  AltitudeEstimator est;
+  const double dt = 0.01;
+  for (int i = 0; i < 3000; i++) {
+    const double t = i * dt;
+    if (i % 4 == 0) {
+      est.updatePressure(pressureAt(2 * t + jitter(i, 0.5), 101.325));
+    }
+    est.updateAccel(jitter(i + 7, 0.05), dt);
+  }
+
+  EXPECT_NEAR(est.getAltitude(), 60, 0.3);
+  EXPECT_NEAR(est.getVerticalSpeed(), 2, 0.1);
+}
+
+TEST(AltitudeEstimator, AccelBias) {
+  // stationary, but accelerometer reads 0.2 m/s^2 up
+  AltitudeEstimator est{0.5, 101.325};
+  est.updatePressure(pressureAt(10, 101.325));
+  for (int i = 0; i < 2000; i++) {
+    est.updateAccel(0.2, 0.01);
+  }
+
+  EXPECT_NEAR(est.getAltitude(), 10, 0.05);
+  EXPECT_NEAR(est.getVerticalSpeed(), 0, 0.01);
+}
+
+TEST(AltitudeEstimator, Step) {
+  // sudden acceleration shows up in the speed before the barometer catches up
+  AltitudeEstimator est{2, 101.325};
+  est.updatePressure(101.325);
+  for (int i = 0; i < 10; i++) {
+    est.updateAccel(5, 0.01);
+  }
+  EXPECT_NEAR(est.getVerticalSpeed(), 0.5, 0.01);
+  EXPECT_GT(est.getAltitude(), 0.02);
+}
@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include <gtest/gtest.h>
 #include <imunano33/climate.hpp>
 
@@ -216,3 +218,127 @@ TEST(Climate, Humid) {
   res = c.getHumidity();
   EXPECT_NEAR(res, 46.5, 0.0001);
 }
+
+TEST(Climate, History) {
+  Climate c;
+  EXPECT_TRUE(c.getHistory().empty());
+
+  c.update(20, 40, 101, 0);
+  c.update(22, 50, 100, 1);
+  c.update(24, 45, 99, 2.5);
+
+  const Climate::History &h = c.getHistory();
+  EXPECT_EQ(h.size(), 3U);
+  EXPECT_NEAR(h.getTime(1), 1, 0.0001);
+  EXPECT_NEAR(h.getDuration(), 2.5, 0.0001);
+  EXPECT_NEAR(h.getTemp().getMean(), 22, 0.0001);
+  EXPECT_NEAR(h.getTemp().getVariance(), 8.0 / 3, 0.0001);
+  EXPECT_NEAR(h.getHumidity().getMax(), 50, 0.0001);
+  EXPECT_NEAR(h.getPressure().getMin(), 99, 0.0001);
+
+  c.reset();
+  EXPECT_TRUE(c.getHistory().empty());
+}
+
+TEST(Climate, HistoryFull) {
+  Climate c;
+  const unsigned int n = IMUNANO33_CLIMATE_HISTORY;
+  for (unsigned int i = 0; i < n + 5; i++) {
+    c.update(i, 50, 100, i);
+  }
+
+  const Climate::History &h = c.getHistory();
+  EXPECT_EQ(h.size(), n);
+  EXPECT_NEAR(h.getTime(0), 5, 0.0001);
+  EXPECT_NEAR(h.getTemp().getMin(), 5, 0.0001);
+  EXPECT_NEAR(h.getTemp().getMax(), n + 4, 0.0001);
+  EXPECT_NEAR(h.getDuration(), n - 1, 0.0001);
+}
+
+namespace {
+double refDewPoint(double t, double rh) {
+  const double gamma = std::log(rh / 100) + 17.62 * t / (243.12 + t);
+  return 243.12 * gamma / (17.62 - gamma);
+}
+
+double refAbsHumidity(double t, double rh) {
+  return 6.112 * std::exp(17.62 * t / (243.12 + t)) * rh * 2.1668 /
+         (t + 273.15);
+}
+} // namespace
+
+TEST(Climate, DewPoint) {
+  for (double t = -40; t <= 60; t += 0.5) {
+    for (double rh = 1; rh <= 100; rh += 1.5) {
+      EXPECT_NEAR(Climate::dewPoint(t, rh), refDewPoint(t, rh), 0.0001);
+    }
+  }
+
+  // saturated air is at its dew point
+  EXPECT_NEAR(Climate::dewPoint(25, 100), 25, 0.0001);
+
+  // known value
+  EXPECT_NEAR(Climate::dewPoint(30, 50), 18.4, 0.1);
+}
+
+TEST(Climate, AbsHumidity) {
+  for (double t = -40; t <= 60; t += 0.5) {
+    for (double rh = 1; rh <= 100; rh += 1.5) {
+      const double ref = refAbsHumidity(t, rh);
+      EXPECT_NEAR(Climate::absHumidity(t, rh) / ref, 1, 1e-6);
+    }
+  }
+
+  // known value, saturated air at 20 C holds about 17.3 g/m^3
+  EXPECT_NEAR(Climate::absHumidity(20, 100), 17.3, 0.1);
+}
+
+TEST(Climate, HeatIndex) {
+  // values from the National Weather Service heat index chart, in F
+  const double toC = 5.0 / 9;
+  EXPECT_NEAR(Climate::heatIndex((90 - 32) * toC, 70), (106 - 32) * toC, 0.6);
+  EXPECT_NEAR(Climate::heatIndex((100 - 32) * toC, 40), (109 - 32) * toC, 0.6);
+  EXPECT_NEAR(Climate::heatIndex((80 - 32) * toC, 40), (80 - 32) * toC, 0.6);
+
+  // below 80 F, the simple formula is used
+  const double simple = 0.5 * (68 + 61 + 50 * 0.094);
+  EXPECT_NEAR(Climate::heatIndex(20, 50), (simple - 32) * toC, 0.0001);
+
+  // low and high humidity adjustments
+  const double low = Climate::heatIndex((95 - 32) * toC, 5);
+  const double high = Climate::heatIndex((85 - 32) * toC, 95);
+  EXPECT_LT(low, (95 - 32) * toC);
+  EXPECT_GT(high, (85 - 32) * toC);
+}
+
+TEST(Climate, DerivedBatch) {
+  const num_t temps[] = {-10, 0, 15.5, 27, 35, 44};
+  const num_t humids[] = {80, 55, 30, 65, 90, 12};
+  num_t out[6];
+
+  Climate::dewPoint(temps, humids, out, 6);
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(out[i], Climate::dewPoint(temps[i], humids[i]));
+  }
+
+  Climate::heatIndex(temps, humids, out, 6);
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(out[i], Climate::heatIndex(temps[i], humids[i]));
+  }
+
+  Climate::absHumidity(temps, humids, out, 6);
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(out[i], Climate::absHumidity(temps[i], humids[i]));
+  }
+}
+
+TEST(Climate, DerivedGetters) {
+  Climate c;
+  c.update(30, 50, 101);
+  EXPECT_NEAR(c.getDewPoint<CELSIUS>(), refDewPoint(30, 50), 0.0001);
+  EXPECT_NEAR(c.getDewPoint<FAHRENHEIT>(), refDewPoint(30, 50) * 1.8 + 32,
+              0.0001);
+  EXPECT_NEAR(c.getHeatIndex<KELVIN>(), Climate::heatIndex(30, 50) + 273.15,
+              0.0001);
+  EXPECT_NEAR(c.getAbsHumidity(), refAbsHumidity(30, 50), 0.0001);
+}
@@ -0,0 +1,118 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <imunano33/constmath.hpp>
+#include <imunano33/mathutil.hpp>
+#include <imunano33/quaternion.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+// evaluated by the compiler, as a mounting rotation or table would be
+constexpr PackedQuaternion MOUNT =
+    ConstMath::rotation(ConstVector3D{0, 0, 1}, M_PI / 2);
+constexpr PackedQuaternion TABLE[] = {
+    ConstMath::rotation(ConstVector3D{1, 0, 0}, 0.1),
+    ConstMath::rotation(ConstVector3D{0, 1, 0}, -2.5),
+    ConstMath::product(MOUNT, ConstMath::conj(MOUNT))};
+constexpr ConstVector3D GRAVITY =
+    ConstMath::rotate(MOUNT, ConstVector3D{0, 0, -1});
+
+static_assert(ConstMath::sqrt(4) == 2, "sqrt is not exact");
+static_assert(ConstMath::sin(0) == 0, "sin is not exact");
+static_assert(ConstMath::cos(0) == 1, "cos is not exact");
+static_assert(ConstMath::dot(ConstVector3D{1, 2, 3}, ConstVector3D{4, 5, 6}) ==
+                  32,
+              "dot is wrong");
+static_assert(GRAVITY.z < -0.999, "rotation moved the z axis");
+static_assert(MathUtil::clamp(5, 0, 3) == 3, "clamp is not constexpr");
+
+// tolerance of the vector and quaternion operations, against the runtime ones
+const double TOL = numTol(1e-12, 1e-5);
+} // namespace
+
+TEST(ConstMath, Sqrt) {
+#ifdef IMUNANO33_FLOAT
+  const double nums[] = {0, 1e-30, 1e-20, 0.3, 1, 2, 1234.5, 1e20, 1e30};
+#else
+  const double nums[] = {0, 1e-300, 1e-20, 0.3, 1, 2, 1234.5, 1e20, 1e300};
+#endif
+  for (const double num : nums) {
+    EXPECT_NEAR(ConstMath::sqrt(num), std::sqrt(num),
+                std::sqrt(num) * numTol(1e-15, 2e-7))
+        << num;
+  }
+  EXPECT_EQ(ConstMath::sqrt(-1), 0);
+  EXPECT_EQ(ConstMath::sqrt(-HUGE_VAL), 0);
+  EXPECT_EQ(ConstMath::sqrt(HUGE_VAL), HUGE_VAL);
+  EXPECT_TRUE(std::isnan(ConstMath::sqrt(std::nan(""))));
+}
+
+TEST(ConstMath, Trig) {
+  for (double ang = -20; ang <= 20; ang += 0.37) {
+    EXPECT_NEAR(ConstMath::sin(ang), std::sin(ang), numTol(1e-13, 4e-6))
+        << ang;
+    EXPECT_NEAR(ConstMath::cos(ang), std::cos(ang), numTol(1e-13, 4e-6))
+        << ang;
+  }
+}
+
+TEST(ConstMath, Vector) {
+  constexpr ConstVector3D a{1, -2, 0.5};
+  constexpr ConstVector3D b{0.3, 4, -1};
+  const Vector3D va = a.toVector();
+  const Vector3D vb = b.toVector();
+
+  nearCheck((a + b).toVector(), va + vb);
+  nearCheck((a - b).toVector(), va - vb);
+  nearCheck((a * 3).toVector(), va * 3);
+  EXPECT_NEAR(ConstMath::dot(a, b), dot(va, vb), TOL);
+  nearCheck(ConstMath::cross(a, b).toVector(), cross(va, vb), TOL);
+  EXPECT_NEAR(ConstMath::magn(a), magn(va), TOL);
+  nearCheck(ConstMath::normalize(a).toVector(), normalize(va), TOL);
+}
+
+TEST(ConstMath, Quaternion) {
+  const Quaternion q{Vector3D{1, 2, 3}, 0.7};
+  const Quaternion r{Vector3D{-2, 1, 0.5}, 2.9};
+  constexpr PackedQuaternion cq =
+      ConstMath::rotation(ConstVector3D{1, 2, 3}, 0.7);
+  constexpr PackedQuaternion cr =
+      ConstMath::rotation(ConstVector3D{-2, 1, 0.5}, 2.9);
+
+  const Quaternion conv = cq.toQuaternion();
+  EXPECT_NEAR(conv.w(), q.w(), TOL);
+  nearCheck(conv.vec(), q.vec(), TOL);
+
+  const Quaternion prod = ConstMath::product(cq, cr).toQuaternion();
+  EXPECT_NEAR(prod.w(), (q * r).w(), TOL);
+  nearCheck(prod.vec(), (q * r).vec(), TOL);
+
+  const Quaternion conj = ConstMath::conj(cq).toQuaternion();
+  EXPECT_NEAR(conj.w(), q.conj().w(), TOL);
+  nearCheck(conj.vec(), q.conj().vec(), TOL);
+
+  constexpr PackedQuaternion scaled{3, 4.4, 1, 5.1};
+  const Quaternion runtime{3, {4.4, 1, 5.1}};
+  EXPECT_NEAR(ConstMath::norm(scaled), runtime.norm(), TOL);
+  const Quaternion unit = ConstMath::unit(scaled).toQuaternion();
+  EXPECT_NEAR(unit.w(), runtime.unit().w(), TOL);
+  nearCheck(unit.vec(), runtime.unit().vec(), TOL);
+
+  // rotate works for quaternions that are not normalized
+  constexpr ConstVector3D vec{0.3, -9.7, 1.1};
+  nearCheck(ConstMath::rotate(scaled, vec).toVector(),
+            runtime.rotate(vec.toVector()), TOL);
+}
+
+TEST(ConstMath, Table) {
+  nearCheck(GRAVITY.toVector(), Vector3D{0, 0, -1});
+  nearCheck(ConstMath::rotate(MOUNT, ConstVector3D{1, 0, 0}).toVector(),
+            Vector3D{0, 1, 0});
+
+  EXPECT_NEAR(TABLE[0].w(), std::cos(0.05), numTol(1e-15, 1e-7));
+  EXPECT_NEAR(TABLE[1][2], std::sin(-1.25), numTol(1e-15, 1e-7));
+  EXPECT_NEAR(TABLE[2].w(), 1, numTol(1e-15, 1e-7));
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <imunano33/climate.hpp>
+#include <imunano33/convert.hpp>
+
+using namespace imunano33;
+
+TEST(UnitConvert, TempScalar) {
+  EXPECT_NEAR((UnitConvert::temp<CELSIUS, FAHRENHEIT>(100)), 212, 0.0001);
+  EXPECT_NEAR((UnitConvert::temp<FAHRENHEIT, CELSIUS>(-40)), -40, 0.0001);
+  EXPECT_NEAR((UnitConvert::temp<KELVIN, CELSIUS>(0)), -273.15, 0.0001);
+  EXPECT_NEAR((UnitConvert::temp<FAHRENHEIT, KELVIN>(32)), 273.15, 0.0001);
+  EXPECT_NEAR((UnitConvert::temp<KELVIN, FAHRENHEIT>(373.15)), 212, 0.0001);
+  EXPECT_NEAR((UnitConvert::temp<CELSIUS, CELSIUS>(12.5)), 12.5, 0.0001);
+}
+
+TEST(UnitConvert, PressureScalar) {
+  EXPECT_NEAR((UnitConvert::pressure<KPA, ATM>(101.325)), 1, 0.0001);
+  EXPECT_NEAR((UnitConvert::pressure<ATM, MMHG>(1)), 760, 0.001);
+  EXPECT_NEAR((UnitConvert::pressure<PSI, KPA>(1)), 6.894757, 0.0001);
+  EXPECT_NEAR((UnitConvert::pressure<MMHG, PSI>(760)), 14.69595, 0.0001);
+}
+
+TEST(UnitConvert, CompileTime) {
+  // constants are folded at compile time
+  static_assert(UnitConvert::tempScale<CELSIUS, FAHRENHEIT>() > 1.79 &&
+                    UnitConvert::tempScale<CELSIUS, FAHRENHEIT>() < 1.81,
+                "");
+  static_assert(UnitConvert::tempOffset<CELSIUS, KELVIN>() > 273.1, "");
+  static_assert(UnitConvert::pressureScale<KPA, KPA>() == 1, "");
+  constexpr num_t boiling = UnitConvert::temp<CELSIUS, FAHRENHEIT>(100);
+  EXPECT_NEAR(boiling, 212, 0.0001);
+}
+
+TEST(UnitConvert, Batch) {
+  num_t temps[] = {-40, 0, 21.5, 37, 100};
+  UnitConvert::temp<CELSIUS, FAHRENHEIT>(temps, 5);
+  const num_t expectedF[] = {-40, 32, 70.7, 98.6, 212};
+  for (int i = 0; i < 5; i++) {
+    EXPECT_NEAR(temps[i], expectedF[i], 0.0001);
+  }
+
+  // and back
+  UnitConvert::temp<FAHRENHEIT, KELVIN>(temps, 5);
+  UnitConvert::temp<KELVIN, CELSIUS>(temps, 5);
+  const num_t expectedC[] = {-40, 0, 21.5, 37, 100};
+  for (int i = 0; i < 5; i++) {
+    EXPECT_NEAR(temps[i], expectedC[i], 0.0001);
+  }
+
+  num_t pressures[] = {101.325, 50, 0};
+  UnitConvert::pressure<KPA, ATM>(pressures, 3);
+  EXPECT_NEAR(pressures[0], 1, 0.0001);
+  EXPECT_NEAR(pressures[1], 0.4934616, 0.0001);
+  EXPECT_NEAR(pressures[2], 0, 0.0001);
+
+  // same unit does nothing
+  UnitConvert::pressure<ATM, ATM>(pressures, 3);
+  EXPECT_NEAR(pressures[0], 1, 0.0001);
+
+  // nothing to convert
+  UnitConvert::temp<CELSIUS, KELVIN>(nullptr, 0);
+}
+
+TEST(UnitConvert, MatchesClimate) {
+  Climate c;
+  c.update(23.4, 40, 98.7);
+
+  EXPECT_NEAR((UnitConvert::temp<CELSIUS, FAHRENHEIT>(23.4)),
+              c.getTemp<FAHRENHEIT>(), 0.000001);
+  EXPECT_NEAR((UnitConvert::temp<CELSIUS, KELVIN>(23.4)), c.getTemp<KELVIN>(),
+              0.000001);
+  EXPECT_NEAR((UnitConvert::pressure<KPA, MMHG>(98.7)), c.getPressure<MMHG>(),
+              0.000001);
+  EXPECT_NEAR((UnitConvert::pressure<KPA, PSI>(98.7)), c.getPressure<PSI>(),
+              0.000001);
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -11,7 +12,6 @@
 #include "testutil.hpp"
 
 using namespace imunano33;
-using namespace svector;
 
 TEST(Filter, DefaultConstructor) {
   Filter f;
@@ -397,7 +397,7 @@ TEST(Filter, UpdateGyroYNeg270) {
   Vector3D k{0, 0, 1};
 
   Filter f{1};
-  f.update({20}, {0, -3 * M_PI / 2, 0}, 1);
+  f.update({20, 0, 0}, {0, -3 * M_PI / 2, 0}, 1);
   Quaternion q = f.getRotQ();
 
   Vector3D iRes = q.rotate(i);
@@ -638,3 +638,317 @@ TEST(Filter, UpdateAccelPosY) {
   // std::cout << "three" << std::endl;
   nearCheck(kRes, {0, -1, 0}, 0.0001);
 }
+
+TEST(Filter, AutoCalibrateBias) {
+  Filter f{0.98};
+  f.setAutoCalibrate(true);
+  EXPECT_TRUE(f.getAutoCalibrate());
+
+  const Vector3D bias{0.01, -0.02, 0.015};
+
+  // at rest with a biased gyro
+  for (int i = 0; i < 200; i++) {
+    f.update({0, 0, -1}, bias, 0.01);
+  }
+
+  EXPECT_TRUE(f.isStationary());
+  nearCheck(f.getGyroBias(), bias, 0.0001);
+
+  // the orientation drifted before calibration but should not drift after
+  const Quaternion before = f.getRotQ();
+  for (int i = 0; i < 200; i++) {
+    f.update({0, 0, -1}, bias, 0.01);
+  }
+  const Quaternion after = f.getRotQ();
+  EXPECT_NEAR(after.w(), before.w(), 0.0001);
+  nearCheck(after.vec(), before.vec(), 0.0001);
+
+  // rotating again, bias is subtracted from readings
+  f.update({0, 0, -1}, {0.01, -0.02, M_PI / 2 + 0.015}, 1);
+  EXPECT_FALSE(f.isStationary());
+  Vector3D iRes = f.getRotQ().rotate({1, 0, 0});
+  Vector3D iBefore = before.rotate({1, 0, 0});
+  nearCheck(iRes, {-y(iBefore), x(iBefore), z(iBefore)}, 0.01);
+}
+
+TEST(Filter, AutoCalibrateZeroReadings) {
+  Filter f{1};
+  f.setAutoCalibrate(true);
+  const Vector3D bias{0.01, -0.02, 0.015};
+  for (int i = 0; i < 200; i++) {
+    f.update({0, 0, -1}, bias, 0.01);
+  }
+  ASSERT_TRUE(f.isStationary());
+
+  // dropped readings are neither rotated by -bias nor averaged into the bias
+  const Quaternion before = f.getRotQ();
+  for (int i = 0; i < 200; i++) {
+    f.update({0, 0, -1}, {0, 0, 0}, 0.01);
+  }
+  nearCheck(f.getGyroBias(), bias, numTol(1e-9, 1e-7));
+  const Quaternion after = f.getRotQ();
+  EXPECT_NEAR(after.w(), before.w(), 1e-12);
+  nearCheck(after.vec(), before.vec(), 1e-12);
+}
+
+TEST(Filter, AutoCalibrateDisabled) {
+  Filter f{1};
+  const Vector3D bias{0.01, -0.02, 0.015};
+  for (int i = 0; i < 200; i++) {
+    f.update({0, 0, -1}, bias, 0.01);
+  }
+
+  EXPECT_FALSE(f.isStationary());
+  nearCheck(f.getGyroBias(), {0, 0, 0});
+  EXPECT_LT(f.getRotQ().w(), 0.9999);
+}
+
+TEST(Filter, SetGyroBias) {
+  Filter f{1};
+  f.setGyroBias({0, 0, 0.5});
+  f.update({}, {0, 0, M_PI / 2 + 0.5}, 1);
+
+  Vector3D iRes = f.getRotQ().rotate({1, 0, 0});
+  nearCheck(iRes, {0, 1, 0}, 0.0001);
+  nearCheck(f.getGyroBias(), {0, 0, 0.5});
+}
+
+TEST(Filter, IntegratorDefault) {
+  Filter f;
+  EXPECT_EQ(f.getIntegrator(), FIRST_ORDER);
+  f.setIntegrator(RK4);
+  EXPECT_EQ(f.getIntegrator(), RK4);
+}
+
+TEST(Filter, IntegratorsConstantRate) {
+  // with a constant angular velocity, all integrators are exact
+  const GyroIntegrator integrators[] = {FIRST_ORDER, MIDPOINT, RK4, CONING};
+  for (const GyroIntegrator integrator : integrators) {
+    Filter f{1};
+    f.setIntegrator(integrator);
+    for (int i = 0; i < 10; i++) {
+      f.update({}, {0, 0, M_PI / 2}, 0.1);
+    }
+
+    Vector3D iRes = f.getRotQ().rotate({1, 0, 0});
+    nearCheck(iRes, {0, 1, 0}, 0.0001);
+  }
+}
+
+namespace {
+// coning motion: rotation axis tilted by alpha, spinning about z
+Quaternion coningQ(const double alpha, const double omega, const double t) {
+  return Quaternion(std::cos(alpha / 2),
+                    Vector3D(std::sin(alpha / 2) * std::cos(omega * t),
+                             std::sin(alpha / 2) * std::sin(omega * t), 0));
+}
+
+Vector3D coningRate(const double alpha, const double omega, const double t) {
+  const Quaternion qDot{0, Vector3D(-std::sin(alpha / 2) * omega *
+                                        std::sin(omega * t),
+                                    std::sin(alpha / 2) * omega *
+                                        std::cos(omega * t),
+                                    0)};
+  return (coningQ(alpha, omega, t).conj() * qDot).vec() * 2;
+}
+
+double coningError(const GyroIntegrator integrator, const double rate) {
+  const double alpha = 0.3;
+  const double omega = 2 * M_PI * 2;
+  const double dt = 1 / rate;
+  const int steps = static_cast<int>(rate * 2);
+
+  Filter f{1, coningQ(alpha, omega, 0)};
+  f.setIntegrator(integrator);
+  f.updateGyro(coningRate(alpha, omega, 0), 0);
+
+  // largest error over the whole trajectory
+  double maxErr = 0;
+  for (int i = 1; i <= steps; i++) {
+    f.updateGyro(coningRate(alpha, omega, i * dt), dt);
+
+    const Quaternion truth = coningQ(alpha, omega, i * dt);
+    const Quaternion est = f.getRotQ();
+    const double d =
+        std::fabs(truth.w() * est.w() + dot(truth.vec(), est.vec()));
+    maxErr = std::max(maxErr, 2 * std::acos(std::min(d, 1.0)));
+  }
+
+  return maxErr;
+}
+} // namespace
+
+TEST(Filter, IntegratorsConing) {
+  const double firstOrder = coningError(FIRST_ORDER, 100);
+  const double midpoint = coningError(MIDPOINT, 100);
+  const double rk4 = coningError(RK4, 100);
+  const double coning = coningError(CONING, 100);
+
+  EXPECT_LT(midpoint, firstOrder);
+  EXPECT_LT(rk4, midpoint);
+  EXPECT_LT(coning, midpoint);
+
+  // a quarter of the rate with a higher order integrator should still beat
+  // first order integration
+  EXPECT_LT(coningError(RK4, 25), firstOrder);
+  EXPECT_LT(coningError(CONING, 25), firstOrder);
+
+#ifndef IMUNANO33_FLOAT
+  // higher order integrators should converge faster as the rate increases,
+  // which float rounding hides once the RK4 error is this small
+  EXPECT_GT(coningError(RK4, 50) / rk4, coningError(MIDPOINT, 50) / midpoint);
+#endif
+}
+
+TEST(Filter, LinearAccelAtRest) {
+  Filter f{0.98};
+  f.update({0, 0, -9.80665}, {}, 0.01);
+  nearCheck(f.getLinearAccel(), {0, 0, 0}, 0.0001);
+  nearCheck(f.getVelocity(), {0, 0, 0});
+}
+
+TEST(Filter, LinearAccelRotated) {
+  // pitched 90 degrees so the body x axis points down, accelerating upwards
+  // by 1 g
+  Filter f{1, Quaternion{{0, 1, 0}, M_PI / 2}};
+  f.setGravity(1);
+  EXPECT_NEAR(f.getGravity(), 1, 0.0001);
+
+  f.updateAccel({2, 0, 0});
+  nearCheck(f.getLinearAccel(), {0, 0, 1}, 0.0001);
+
+  // sideways acceleration in the body y axis
+  f.updateAccel({1, 0.5, 0});
+  nearCheck(f.getLinearAccel(), {0, -0.5, 0}, 0.0001);
+}
+
+TEST(Filter, LinearAccelZero) {
+  Filter f;
+  f.updateAccel({0, 0, -5});
+  f.updateAccel({});
+  nearCheck(f.getLinearAccel(), {0, 0, 0});
+}
+
+TEST(Filter, VelocityTracking) {
+  Filter f{1};
+  f.setGravity(1);
+
+  // not tracked by default
+  f.update({1, 0, -1}, {}, 0.1);
+  EXPECT_FALSE(f.getVelocityTracking());
+  nearCheck(f.getVelocity(), {0, 0, 0});
+
+  f.setVelocityTracking(true);
+  EXPECT_TRUE(f.getVelocityTracking());
+  for (int i = 0; i < 10; i++) {
+    // accelerating in -x (world) at 0.5 g and up at 0.25 g
+    f.update({0.5, 0, -1.25}, {}, 0.1);
+  }
+  nearCheck(f.getVelocity(), {-0.5, 0, 0.25}, 0.0001);
+
+  // no time, no integration
+  f.updateAccel({0.5, 0, -1.25});
+  nearCheck(f.getVelocity(), {-0.5, 0, 0.25}, 0.0001);
+
+  f.resetVelocity();
+  nearCheck(f.getVelocity(), {0, 0, 0});
+
+  f.update({0.5, 0, -1}, {}, 0.1);
+  f.setVelocityTracking(false);
+  nearCheck(f.getVelocity(), {0, 0, 0});
+}
+
+TEST(Filter, VelocityLeak) {
+  Filter f{1};
+  f.setGravity(1);
+  f.setVelocityTracking(true);
+  f.update({-1, 0, -1}, {}, 1);
+  nearCheck(f.getVelocity(), {1, 0, 0}, 0.0001);
+
+  f.setVelocityLeak(10);
+  for (int i = 0; i < 100; i++) {
+    f.update({0, 0, -1}, {}, 0.1);
+  }
+  EXPECT_NEAR(x(f.getVelocity()), std::pow(0.99, 100), 0.0001);
+}
+
+TEST(Filter, VelocityZeroUpdate) {
+  Filter f{0.98};
+  f.setAutoCalibrate(true);
+  f.setVelocityTracking(true);
+
+  // moving, then stopped in a different unit of acceleration
+  for (int i = 0; i < 10; i++) {
+    f.update({-1, 0, -1}, {}, 0.1);
+  }
+  EXPECT_GT(magn(f.getVelocity()), 0.1);
+
+  // a zero gyro reading is a missing one, so the resting gyro has some bias
+  for (int i = 0; i < 100; i++) {
+    f.update({0, 0, -2}, {0.001, 0, 0}, 0.1);
+  }
+  EXPECT_TRUE(f.isStationary());
+  nearCheck(f.getVelocity(), {0, 0, 0});
+  EXPECT_NEAR(f.getGravity(), 2, 0.0001);
+}
+
+TEST(Filter, Version) {
+  Filter f{0.98};
+  const unsigned long start = f.getVersion();
+
+  f.update({}, {}, 0.1);
+  EXPECT_EQ(f.getVersion(), start);
+
+  f.update({}, {0, 0, 1}, 0.1);
+  EXPECT_GT(f.getVersion(), start);
+
+  const unsigned long rotated = f.getVersion();
+  f.updateAccel({0.2, 0, -1});
+  EXPECT_GT(f.getVersion(), rotated);
+
+  const unsigned long corrected = f.getVersion();
+  f.reset();
+  EXPECT_GT(f.getVersion(), corrected);
+}
+
+TEST(Filter, IntegratorsSkipZero) {
+  const GyroIntegrator integrators[] = {FIRST_ORDER, MIDPOINT, RK4, CONING};
+  for (const GyroIntegrator integrator : integrators) {
+    Filter f{1};
+    f.setIntegrator(integrator);
+    f.updateGyro({0, 0, 1}, 0.1);
+    f.updateGyro({0, 0, 1}, 0.1);
+    const Quaternion before = f.getRotQ();
+
+    // a dropped reading neither rotates nor becomes a previous reading
+    f.updateGyro({0, 0, 0}, 0.1);
+    const Quaternion after = f.getRotQ();
+    EXPECT_NEAR(after.w(), before.w(), 1e-12) << integrator;
+    nearCheck(after.vec(), before.vec(), 1e-12);
+
+    f.updateGyro({0, 0, 1}, 0.1);
+    const Vector3D iRes = f.getRotQ().rotate({1, 0, 0});
+    nearCheck(iRes, {std::cos(0.3), std::sin(0.3), 0}, 1e-6);
+  }
+}
+
+TEST(Filter, IntegratorsAfterRest) {
+  const GyroIntegrator integrators[] = {MIDPOINT, RK4, CONING};
+  const Vector3D bias{0.01, -0.02, 0.015};
+  for (const GyroIntegrator integrator : integrators) {
+    Filter f{1};
+    f.setAutoCalibrate(true);
+    f.setIntegrator(integrator);
+    for (int i = 0; i < 200; i++) {
+      f.update({0, 0, -1}, bias, 0.01);
+    }
+    ASSERT_TRUE(f.isStationary());
+
+    // readings from before the rest must not leak into the first step after
+    const Quaternion before = f.getRotQ();
+    f.updateGyro(bias + Vector3D{0, 0, 1}, 0.1);
+    const Quaternion delta = before.conj() * f.getRotQ();
+    const Vector3D iRes = delta.rotate({1, 0, 0});
+    nearCheck(iRes, {std::cos(0.1), std::sin(0.1), 0}, 1e-6);
+  }
+}
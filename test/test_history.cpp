@@ -0,0 +1,240 @@
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <imunano33/history.hpp>
+#include <imunano33/imunano33.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+void quatCheck(const Quaternion &actual, const Quaternion &expect,
+               const double tol = numTol(1e-9, 1e-6)) {
+  EXPECT_NEAR(actual.w(), expect.w(), tol);
+  nearCheck(actual.vec(), expect.vec(), tol);
+}
+
+// rotation about z by 1 rad/s, at time in us
+Quaternion yawAt(const double time) {
+  return Quaternion{{0, 0, 1}, static_cast<num_t>(time / 1e6)};
+}
+} // namespace
+
+TEST(OrientationHistory, Empty) {
+  OrientationHistory<8> history;
+  Quaternion q{0.5, {0.5, 0.5, 0.5}};
+  unsigned long oldest = 7;
+  unsigned long newest = 7;
+
+  EXPECT_EQ(history.size(), 0u);
+  EXPECT_EQ(history.capacity(), 8u);
+  EXPECT_FALSE(history.nlerpAt(0, q));
+  EXPECT_FALSE(history.getTimeRange(oldest, newest));
+  EXPECT_EQ(q.w(), 0.5);
+  EXPECT_EQ(oldest, 7u);
+}
+
+TEST(OrientationHistory, Lookup) {
+  OrientationHistory<8> history;
+  for (unsigned long i = 1; i <= 5; i++) {
+    history.push(100000 * i, yawAt(100000 * i));
+  }
+
+  Quaternion q;
+  // exact entries
+  for (unsigned long i = 1; i <= 5; i++) {
+    ASSERT_TRUE(history.slerpAt(100000 * i, q));
+    quatCheck(q, yawAt(100000 * i));
+  }
+
+  // slerp follows the constant rate rotation exactly, nlerp nearly
+  ASSERT_TRUE(history.slerpAt(230000, q));
+  quatCheck(q, yawAt(230000));
+  ASSERT_TRUE(history.nlerpAt(230000, q));
+  quatCheck(q, nlerp(yawAt(200000), yawAt(300000), 0.3));
+  quatCheck(q, yawAt(230000), 1e-4);
+
+  EXPECT_FALSE(history.nlerpAt(99999, q));
+  EXPECT_FALSE(history.nlerpAt(500001, q));
+}
+
+TEST(OrientationHistory, Wrap) {
+  OrientationHistory<4> history;
+  for (unsigned long i = 0; i < 10; i++) {
+    history.push(1000 * i, yawAt(100000 * i));
+  }
+
+  unsigned long oldest;
+  unsigned long newest;
+  EXPECT_EQ(history.size(), 4u);
+  ASSERT_TRUE(history.getTimeRange(oldest, newest));
+  EXPECT_EQ(oldest, 6000u);
+  EXPECT_EQ(newest, 9000u);
+
+  Quaternion q;
+  EXPECT_FALSE(history.slerpAt(5500, q));
+  ASSERT_TRUE(history.slerpAt(6500, q));
+  quatCheck(q, yawAt(650000));
+  ASSERT_TRUE(history.slerpAt(8750, q));
+  quatCheck(q, yawAt(875000));
+}
+
+TEST(OrientationHistory, TimeWrap) {
+  // timestamps that run past the largest unsigned long, as micros() does
+  OrientationHistory<8> history;
+  const unsigned long start = ULONG_MAX - 1500;
+  for (unsigned long i = 0; i < 4; i++) {
+    history.push(start + 1000 * i, yawAt(1000.0 * i));
+  }
+
+  unsigned long oldest;
+  unsigned long newest;
+  ASSERT_TRUE(history.getTimeRange(oldest, newest));
+  EXPECT_EQ(oldest, start);
+  EXPECT_EQ(newest, start + 3000);
+  EXPECT_LT(newest, oldest);
+
+  Quaternion q;
+  // between an entry before the wrap and one after it
+  ASSERT_TRUE(history.slerpAt(start + 1250, q));
+  quatCheck(q, yawAt(1250));
+  ASSERT_TRUE(history.slerpAt(start + 2600, q));
+  quatCheck(q, yawAt(2600));
+  EXPECT_FALSE(history.slerpAt(start - 1, q));
+  EXPECT_FALSE(history.slerpAt(start + 3001, q));
+
+  // a wrapped time is after the newest, not before it
+  history.push(start + 4000, yawAt(4000));
+  EXPECT_EQ(history.size(), 5u);
+}
+
+TEST(OrientationHistory, SameTime) {
+  OrientationHistory<4> history;
+  history.push(1000, yawAt(100000));
+  history.push(2000, yawAt(200000));
+  history.push(2000, yawAt(300000));
+  EXPECT_EQ(history.size(), 2u);
+
+  Quaternion q;
+  ASSERT_TRUE(history.nlerpAt(2000, q));
+  quatCheck(q, yawAt(300000));
+
+  // time going backwards starts over
+  history.push(500, yawAt(400000));
+  EXPECT_EQ(history.size(), 1u);
+  ASSERT_TRUE(history.nlerpAt(500, q));
+  quatCheck(q, yawAt(400000));
+
+  history.reset();
+  EXPECT_EQ(history.size(), 0u);
+  EXPECT_FALSE(history.nlerpAt(500, q));
+}
+
+TEST(OrientationHistory, Copy) {
+  OrientationHistory<4> history;
+  history.push(1000, yawAt(100000));
+  history.push(2000, yawAt(200000));
+
+  const OrientationHistory<4> copy{history};
+  history.reset();
+
+  Quaternion q;
+  ASSERT_TRUE(copy.slerpAt(1500, q));
+  quatCheck(q, yawAt(150000));
+}
+
+TEST(OrientationHistory, Concurrent) {
+  // one thread pushes a constant rate rotation while this one looks up past
+  // orientations, which must never come out torn
+  OrientationHistory<16> history;
+  std::atomic<bool> done{false};
+  const unsigned long step = 1000;
+
+  history.push(0, yawAt(0));
+  std::thread writer{[&]() {
+    for (unsigned long i = 1; i <= 200000; i++) {
+      history.push(step * i, yawAt(step * i));
+    }
+    done = true;
+  }};
+
+  while (!done) {
+    unsigned long oldest;
+    unsigned long newest;
+    if (!history.getTimeRange(oldest, newest)) {
+      continue;
+    }
+
+    const unsigned long time = oldest + (newest - oldest) / 2;
+    Quaternion q;
+    if (history.slerpAt(time, q)) {
+      quatCheck(q, yawAt(time), numTol(1e-6, 1e-5));
+    }
+  }
+  writer.join();
+}
+
+TEST(OrientationHistory, IMUNano33) {
+  IMUNano33 proc;
+  const Vector3D gyro{0, 0, 1};
+  const Vector3D accel{0, 0, -1};
+
+  proc.updateIMUGyro(gyro, 0.01);
+  const Quaternion first = proc.getRotQ();
+  proc.updateIMUGyro(gyro, 0.01);
+  proc.updateIMUAccel(accel);
+  proc.updateIMU(accel, gyro, 0.01);
+
+  // the accelerometer update added no entry
+  EXPECT_EQ(proc.getRotHistory().size(), 3u);
+
+  Quaternion q;
+  EXPECT_EQ(proc.getMicros(), 30000u);
+  ASSERT_TRUE(proc.getRotHistory().nlerpAt(10000, q));
+  quatCheck(q, first);
+  ASSERT_TRUE(proc.getRotHistory().nlerpAt(proc.getMicros(), q));
+  quatCheck(q, proc.getRotQ());
+  ASSERT_TRUE(proc.getRotHistory().slerpAt(15000, q));
+  quatCheck(q, yawAt(15000), numTol(1e-6, 1e-5));
+}
+
+TEST(OrientationHistory, IMUNano33Clock) {
+  // over an hour of updates at a rate that is not a whole number of us; a
+  // float sum of deltaT would be off by far more than a millisecond
+  IMUNano33 proc;
+  const auto deltaT = static_cast<num_t>(1.0 / 952);
+  const unsigned long steps = 3600 * 952;
+  for (unsigned long i = 0; i < steps; i++) {
+    proc.updateIMUGyro({}, deltaT);
+  }
+
+  EXPECT_NEAR(static_cast<double>(proc.getMicros()),
+              1e6 * static_cast<double>(deltaT) * steps, 1000);
+}
+
+TEST(OrientationHistory, IMUNano33Reset) {
+  IMUNano33 proc;
+  const Vector3D gyro{0, 0, 1};
+
+  proc.updateIMUGyro(gyro, 0.01);
+  proc.resetIMU();
+  EXPECT_EQ(proc.getRotHistory().size(), 0u);
+
+  proc.updateIMUGyro(gyro, 0.01);
+  proc.zeroIMU();
+  EXPECT_EQ(proc.getRotHistory().size(), 0u);
+
+  proc.updateIMUGyro(gyro, 0.01);
+  proc.setRotQ(Quaternion{1, {0, 0, 0}});
+  EXPECT_EQ(proc.getRotHistory().size(), 0u);
+
+  // entries recorded after a reset are in the new frame
+  proc.updateIMUGyro(gyro, 0.01);
+  Quaternion q;
+  ASSERT_TRUE(proc.getRotHistory().nlerpAt(proc.getMicros(), q));
+  quatCheck(q, proc.getRotQ());
+}
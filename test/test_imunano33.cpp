@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include <gtest/gtest.h>
 #include <imunano33/imunano33.hpp>
 
@@ -123,3 +125,118 @@ TEST(IMUNano33, TestResetClimate) {
 
   EXPECT_FALSE(proc.climateDataExists());
 }
+
+TEST(IMUNano33, AutoCalibrate) {
+  IMUNano33 proc;
+  proc.setAutoCalibrate(true);
+
+  for (int i = 0; i < 100; i++) {
+    proc.updateIMU({0, 0, -1}, {0.02, 0, 0}, 0.01);
+  }
+
+  EXPECT_TRUE(proc.isStationary());
+  nearCheck(proc.getGyroBias(), {0.02, 0, 0}, 0.0001);
+
+  proc.setGyroBias({});
+  nearCheck(proc.getGyroBias(), {0, 0, 0});
+}
+
+TEST(IMUNano33, LinearAccelVelocity) {
+  IMUNano33 proc;
+  proc.setGravity(1);
+  EXPECT_NEAR(proc.getGravity(), 1, 0.0001);
+
+  proc.setVelocityTracking(true);
+  proc.updateIMU({0, 0, -1.5}, {}, 0.5);
+  nearCheck(proc.getLinearAccel(), {0, 0, 0.5}, 0.0001);
+  nearCheck(proc.getVelocity(), {0, 0, 0.25}, 0.0001);
+
+  proc.updateIMUAccel({0, 0, -1.5}, 0.5);
+  nearCheck(proc.getVelocity(), {0, 0, 0.5}, 0.0001);
+
+  proc.setVelocityLeak(0.5);
+  proc.updateIMUAccel({0, 0, -1}, 0.5);
+  nearCheck(proc.getVelocity(), {0, 0, 0}, 0.0001);
+
+  proc.updateIMUAccel({0, 0, -1.5}, 0.25);
+  proc.resetVelocity();
+  nearCheck(proc.getVelocity(), {0, 0, 0});
+}
+
+TEST(IMUNano33, CachedRepresentations) {
+  IMUNano33 proc{1};
+  proc.updateIMU({}, {0, 0, 0.5}, 1);
+
+  nearCheck(proc.getEuler(), {0, 0, 0.5});
+  EXPECT_NEAR(proc.getAxisAngle().angle, 0.5, 0.0001);
+  nearCheck(proc.getRotMatrix().rotate({1, 0, 0}),
+            {std::cos(0.5), std::sin(0.5), 0});
+
+  // repeated reads return the same cached object
+  const Vector3D *euler = &proc.getEuler();
+  EXPECT_EQ(euler, &proc.getEuler());
+
+  // cache is invalidated by updates
+  proc.updateIMU({}, {0, 0, 0.5}, 1);
+  nearCheck(proc.getEuler(), {0, 0, 1});
+  EXPECT_NEAR(proc.getAxisAngle().angle, 1, 0.0001);
+  nearCheck(proc.getRotMatrix().rotate({1, 0, 0}),
+            {std::cos(1.0), std::sin(1.0), 0});
+
+  proc.zeroIMU();
+  nearCheck(proc.getEuler(), {0, 0, 0});
+  EXPECT_NEAR(proc.getAxisAngle().angle, 0, 0.0001);
+
+  proc.setRotQ(Quaternion::fromEuler(0.1, 0.2, 0.3));
+  nearCheck(proc.getEuler(), {0.1, 0.2, 0.3});
+}
+
+TEST(IMUNano33, ClimateHistory) {
+  IMUNano33 proc;
+  EXPECT_EQ(proc.getTime(), 0);
+
+  proc.update({0, 0, -9.8}, {0, 0, 0}, 0.5, 20, 30, 100);
+  proc.updateIMU({0, 0, -9.8}, {0, 0, 0}, 0.25);
+  proc.updateIMUGyro({0, 0, 0}, 0.25);
+  proc.updateClimate(22, 40, 101, 0.5);
+  EXPECT_NEAR(proc.getTime(), 1, 0.0001);
+  EXPECT_NEAR(proc.getClimateTime(), 1, 0.0001);
+
+  const Climate::History &h = proc.getClimateHistory();
+  EXPECT_EQ(h.size(), 2U);
+  EXPECT_NEAR(h.getTime(0), 0.5, 0.0001);
+  EXPECT_NEAR(h.getTime(1), 1, 0.0001);
+  EXPECT_NEAR(h.getTemp().getMean(), 21, 0.0001);
+  EXPECT_NEAR(h.getHumidity().getMin(), 30, 0.0001);
+  EXPECT_NEAR(h.getPressure().getMax(), 101, 0.0001);
+
+  proc.resetClimate();
+  EXPECT_TRUE(proc.getClimateHistory().empty());
+}
+
+TEST(IMUNano33, Altitude) {
+  IMUNano33 proc;
+  EXPECT_FALSE(proc.altitudeDataExists());
+
+  // at rest, 100 m up
+  const double pressure = 101.325 * std::pow(1 - 100 / 44330.77, 1 / 0.190263);
+  for (int i = 0; i < 500; i++) {
+    proc.update({0, 0, -9.80665}, {0, 0, 0}, 0.01, 20, 50, pressure);
+  }
+  EXPECT_TRUE(proc.altitudeDataExists());
+  EXPECT_NEAR(proc.getAltitude(), 100, 0.1);
+  EXPECT_NEAR(proc.getVerticalSpeed(), 0, 0.01);
+
+  // accelerating up with the accelerometer in g, before the barometer notices
+  IMUNano33 procG;
+  procG.setGravity(1);
+  procG.setSeaLevelPressure(pressure);
+  procG.updateClimate(20, 50, pressure, 1);
+  for (int i = 0; i < 10; i++) {
+    procG.updateIMU({0, 0, -1.5}, {0, 0, 0}, 0.01);
+  }
+  EXPECT_NEAR(procG.getVerticalSpeed(), 0.5 * 9.80665 * 0.1, 0.01);
+
+  procG.resetClimate();
+  EXPECT_FALSE(procG.altitudeDataExists());
+}
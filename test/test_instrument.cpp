@@ -0,0 +1,84 @@
+// built into its own executable with IMUNANO33_INSTRUMENT defined
+
+#include <gtest/gtest.h>
+#include <imunano33/imunano33.hpp>
+
+using namespace imunano33;
+
+TEST(Instrument, CallCounts) {
+  Instrument::reset();
+
+  IMUNano33 proc;
+  for (int i = 0; i < 10; i++) {
+    proc.updateIMU({0, 0, -9.8}, {0.1, 0, 0}, 0.01);
+  }
+  proc.updateClimate(20, 50, 100, 0.1);
+
+  const InstrumentStats &stats = Instrument::getStats();
+  EXPECT_EQ(stats.calls[IMU_UPDATE_CALL].count, 10ULL);
+  EXPECT_EQ(stats.calls[GYRO_UPDATE_CALL].count, 10ULL);
+  EXPECT_EQ(stats.calls[ACCEL_UPDATE_CALL].count, 10ULL);
+  EXPECT_EQ(stats.calls[CLIMATE_UPDATE_CALL].count, 1ULL);
+
+  // every call lands in exactly one bucket
+  for (const auto &hist : stats.calls) {
+    unsigned long long total = 0;
+    for (const auto bucket : hist.buckets) {
+      total += bucket;
+    }
+    EXPECT_EQ(total, hist.count);
+    EXPECT_GE(hist.totalNs, hist.maxNs);
+  }
+
+  // the outer call includes both inner calls
+  EXPECT_GE(stats.calls[IMU_UPDATE_CALL].totalNs,
+            stats.calls[GYRO_UPDATE_CALL].totalNs);
+}
+
+TEST(Instrument, Branches) {
+  Instrument::reset();
+
+  Filter filter;
+  filter.updateGyro({0, 0, 0}, 0.01);
+  filter.updateGyro({0, 0, 0}, 0.01);
+  filter.updateAccel({0, 0, 0});
+  filter.updateAccel({0, 0, -9.8});
+
+  const InstrumentStats &stats = Instrument::getStats();
+  EXPECT_EQ(stats.branches[GYRO_SKIPPED], 2ULL);
+  EXPECT_EQ(stats.branches[ACCEL_SKIPPED], 1ULL);
+  EXPECT_EQ(stats.branches[AXIS_DEGENERATE], 1ULL);
+  EXPECT_EQ(stats.branches[GYRO_STATIONARY], 0ULL);
+
+  Instrument::reset();
+  EXPECT_EQ(Instrument::getStats().branches[GYRO_SKIPPED], 0ULL);
+  EXPECT_EQ(Instrument::getStats().calls[GYRO_UPDATE_CALL].count, 0ULL);
+}
+
+TEST(Instrument, Stationary) {
+  Instrument::reset();
+
+  Filter filter;
+  filter.setAutoCalibrate(true);
+  for (int i = 0; i < 100; i++) {
+    filter.update({0, 0, -9.8}, {0.01, 0, 0}, 0.01);
+  }
+
+  EXPECT_GT(Instrument::getStats().branches[GYRO_STATIONARY], 0ULL);
+}
+
+TEST(Instrument, Histogram) {
+  LatencyHistogram hist{};
+  hist.record(0);
+  hist.record(1);
+  hist.record(3);
+  hist.record(1000);
+  hist.record(1ULL << 40);
+
+  EXPECT_EQ(hist.buckets[0], 2ULL);
+  EXPECT_EQ(hist.buckets[1], 1ULL);
+  EXPECT_EQ(hist.buckets[9], 1ULL);
+  EXPECT_EQ(hist.buckets[LatencyHistogram::NUM_BUCKETS - 1], 1ULL);
+  EXPECT_EQ(hist.count, 5ULL);
+  EXPECT_EQ(hist.maxNs, 1ULL << 40);
+}
@@ -3,8 +3,9 @@
 #include <gtest/gtest.h>
 #include <imunano33/mathutil.hpp>
 
+#include "testutil.hpp"
+
 using namespace imunano33;
-using namespace svector;
 
 TEST(MathUtil, NearZeroNum) {
   double num1 = std::sqrt(4.4105) - std::sqrt(4.4105);
@@ -68,3 +69,36 @@ TEST(MathUtil, ClampNorm) {
   EXPECT_NEAR(MathUtil::clamp(5.5, 3.0, 10.0), 5.5, 0.0001);
   EXPECT_NEAR(MathUtil::clamp(1.101, 1.1, 3.3), 1.101, 0.0001);
 }
+
+TEST(MathUtil, FastLog) {
+  const double tol = numTol(1e-9, 1e-6);
+  for (double x = 0.001; x < 1000; x *= 1.01) {
+    EXPECT_NEAR(MathUtil::fastLog(x), std::log(x), tol) << "x: " << x;
+  }
+
+  EXPECT_NEAR(MathUtil::fastLog(1), 0, 1e-12);
+#ifdef IMUNANO33_FLOAT
+  EXPECT_NEAR(MathUtil::fastLog(1e-30F), std::log(1e-30F), tol);
+  EXPECT_NEAR(MathUtil::fastLog(1e30F), std::log(1e30F), tol);
+#else
+  EXPECT_NEAR(MathUtil::fastLog(1e-300), std::log(1e-300), tol);
+  EXPECT_NEAR(MathUtil::fastLog(1e300), std::log(1e300), tol);
+#endif
+}
+
+TEST(MathUtil, FastExp) {
+  // float rounds x itself by a relative error that grows with |x|
+  const double tol = numTol(1e-12, 1e-5);
+  for (double x = -50; x < 50; x += 0.037) {
+    EXPECT_NEAR(MathUtil::fastExp(x) / std::exp(x), 1, tol) << "x: " << x;
+  }
+
+  EXPECT_NEAR(MathUtil::fastExp(0), 1, 1e-12);
+#ifdef IMUNANO33_FLOAT
+  EXPECT_NEAR(MathUtil::fastExp(-80) / std::exp(-80.0F), 1, tol);
+  EXPECT_NEAR(MathUtil::fastExp(80) / std::exp(80.0F), 1, tol);
+#else
+  EXPECT_NEAR(MathUtil::fastExp(-700) / std::exp(-700), 1, tol);
+  EXPECT_NEAR(MathUtil::fastExp(700) / std::exp(700), 1, tol);
+#endif
+}
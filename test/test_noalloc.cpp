@@ -0,0 +1,270 @@
+/**
+ * Replaces the global allocation functions to count heap allocations, and
+ * checks that the update paths never allocate.
+ *
+ * operator new is replaced everywhere. Where the linker supports --wrap,
+ * malloc, calloc, and realloc are wrapped as well, which catches direct calls
+ * from the library since it is compiled into this executable.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <imunano33/imunano33.hpp>
+#include <imunano33/packedquat.hpp>
+#include <imunano33/series.hpp>
+#include <imunano33/simulate.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+std::atomic<bool> g_counting{false};
+std::atomic<unsigned long> g_allocs{0};
+
+void count() {
+  if (g_counting) {
+    ++g_allocs;
+  }
+}
+} // namespace
+
+#ifdef IMUNANO33_WRAP_MALLOC
+extern "C" {
+void *__real_malloc(std::size_t size);
+void *__real_calloc(std::size_t num, std::size_t size);
+void *__real_realloc(void *ptr, std::size_t size);
+
+void *__wrap_malloc(std::size_t size) {
+  count();
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(std::size_t num, std::size_t size) {
+  count();
+  return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, std::size_t size) {
+  count();
+  return __real_realloc(ptr, size);
+}
+}
+
+namespace {
+void *rawAlloc(const std::size_t size) { return __real_malloc(size); }
+} // namespace
+#else
+namespace {
+void *rawAlloc(const std::size_t size) { return std::malloc(size); }
+} // namespace
+#endif
+
+namespace {
+void *countedAlloc(const std::size_t size) {
+  count();
+  return rawAlloc(size == 0 ? 1 : size);
+}
+} // namespace
+
+void *operator new(std::size_t size) {
+  void *ptr = countedAlloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc{};
+  }
+  return ptr;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+const int ITERATIONS = 20000;
+
+// counts allocations from construction until stop()
+class AllocCounter {
+public:
+  AllocCounter() {
+    g_allocs = 0;
+    g_counting = true;
+  }
+
+  ~AllocCounter() { g_counting = false; }
+
+  unsigned long stop() {
+    g_counting = false;
+    return g_allocs;
+  }
+};
+
+ImuSimulator::Motion tumble() {
+  ImuSimulator::Motion motion;
+  motion.angleRate = Vector3D{2, 0.5, -1.5};
+  motion.shakeAmplitude = Vector3D{0.5, 0.3, 0.5};
+  motion.shakeFreq = 2;
+  motion.accelAmplitude = Vector3D{1, 1, 0.5};
+  motion.accelFreq = 1;
+  return motion;
+}
+
+ImuSimulator::SensorModel noisy() {
+  ImuSimulator::SensorModel sensor;
+  sensor.gyroBias = Vector3D{0.01, -0.005, 0.002};
+  sensor.gyroNoise = 0.005;
+  sensor.accelNoise = 0.02;
+  sensor.dropout = 0.05;
+  return sensor;
+}
+} // namespace
+
+TEST(NoAlloc, Harness) {
+  // the counter itself must see allocations
+  AllocCounter counter;
+  std::vector<int> *values = new std::vector<int>(10);
+  delete values;
+#ifdef IMUNANO33_WRAP_MALLOC
+  std::free(std::malloc(16));
+  EXPECT_EQ(counter.stop(), 3u);
+#else
+  EXPECT_EQ(counter.stop(), 2u);
+#endif
+}
+
+TEST(NoAlloc, Filter) {
+  const GyroIntegrator integrators[] = {FIRST_ORDER, MIDPOINT, RK4, CONING};
+  for (const GyroIntegrator integrator : integrators) {
+    ImuSimulator sim{tumble(), noisy(), 200, 1};
+    Filter filter;
+    filter.setIntegrator(integrator);
+    filter.setAutoCalibrate(true);
+    filter.setVelocityTracking(true);
+
+    AllocCounter counter;
+    for (int i = 0; i < ITERATIONS; i++) {
+      const ImuSimulator::Sample &sample = sim.next();
+      if (sample.gyroDropped) {
+        filter.updateAccel(sample.accel, sample.deltaT);
+      } else if (sample.accelDropped) {
+        filter.updateGyro(sample.gyro, sample.deltaT);
+      } else {
+        filter.update(sample.accel, sample.gyro, sample.deltaT);
+      }
+    }
+    EXPECT_EQ(counter.stop(), 0u) << "integrator " << integrator;
+  }
+}
+
+TEST(NoAlloc, IMUNano33) {
+  using AccelInput = SensorInput<POS_X, NEG_Y, NEG_Z>;
+  using GyroInput = SensorInput<NEG_X, POS_Y, POS_Z, DegToRad>;
+
+  ImuSimulator sim{tumble(), noisy(), 200, 2};
+  IMUNano33 proc;
+  proc.setVelocityTracking(true);
+  proc.setAutoCalibrate(true);
+  const int16_t rawAccel[12] = {10, -20, 16384, 0, 5, 16000,
+                                -3, 4, 16500, 1, 1, 16384};
+  const int16_t rawGyro[12] = {1, 2, 3, -4, -5, -6, 7, 8, 9, 0, 0, 0};
+
+  AllocCounter counter;
+  for (int i = 0; i < ITERATIONS; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    switch (i % 5) {
+    case 0:
+      proc.updateIMU(sample.accel, sample.gyro, sample.deltaT);
+      break;
+    case 1:
+      proc.updateIMUGyro(sample.gyro, sample.deltaT);
+      proc.updateIMUAccel(sample.accel, sample.deltaT);
+      break;
+    case 2:
+      proc.update(sample.accel, sample.gyro, sample.deltaT, 22, 40, 101);
+      break;
+    case 3:
+      proc.updateIMURaw<AccelInput, GyroInput>(rawAccel, rawGyro, 4,
+                                               sample.deltaT / 4);
+      break;
+    default:
+      proc.updateIMUAccelRaw<AccelInput>(rawAccel[0], rawAccel[1],
+                                         rawAccel[2]);
+      proc.updateIMUGyroRaw<GyroInput>(rawGyro[0], rawGyro[1], rawGyro[2],
+                                       sample.deltaT);
+      break;
+    }
+
+    Quaternion past;
+    proc.getRotHistory().slerpAt(
+        proc.getMicros() - static_cast<unsigned long>(sample.deltaT * 500000),
+        past);
+    static_cast<void>(proc.getEuler());
+    static_cast<void>(proc.getRotMatrix());
+    static_cast<void>(proc.getAxisAngle());
+    static_cast<void>(proc.getAltitude());
+  }
+  EXPECT_EQ(counter.stop(), 0u);
+}
+
+TEST(NoAlloc, Quaternion) {
+  Quaternion q{{1, 2, 3}, 0.7};
+  const Quaternion delta{{-2, 1, 0.5}, 0.01};
+  Vector3D vec{0.3, -9.7, 1.1};
+  PackedQuaternion packed{q};
+  const PackedQuaternion packedDelta{delta};
+  Quaternion frames[8];
+
+  AllocCounter counter;
+  for (int i = 0; i < ITERATIONS; i++) {
+    const Quaternion prev = q;
+    q = (q * delta).unit();
+    vec = q.rotate(vec);
+    q = nlerp(q, slerp(prev, q.inv(), 0.3), 0.5);
+    q = squad(prev, q, squadControl(prev, q, delta),
+              squadControl(q, delta, prev), 0.25);
+    q = q * Quaternion::fromRotVec(q.toRotVec() * 0.001);
+    slerpFrames(prev, q, 0, 0.125, frames, 8);
+    packed = (packed * packedDelta.conj()).unit();
+  }
+  EXPECT_EQ(counter.stop(), 0u);
+}
+
+TEST(NoAlloc, Series) {
+  // appending grows the series, but reading it back must not allocate
+  OrientationSeries series;
+  Quaternion q;
+  const Quaternion delta{{-2, 1, 0.5}, 0.01};
+  for (int i = 0; i < 4096; i++) {
+    series.append(q);
+    q = (q * delta).unit();
+  }
+  PackedQuaternion out[64];
+
+  AllocCounter counter;
+  for (int i = 0; i < ITERATIONS / 100; i++) {
+    series.decode(static_cast<std::size_t>(i * 37) % 4000, 64, out);
+    static_cast<void>(series.at(static_cast<std::size_t>(i) % 4096));
+  }
+  EXPECT_EQ(counter.stop(), 0u);
+}
@@ -0,0 +1,88 @@
+#include <cstdint>
+
+#include <gtest/gtest.h>
+#include <imunano33/packedquat.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+void quatCheck(const PackedQuaternion &packed, const Quaternion &q,
+               const double tol = numTol(1e-12, 1e-6)) {
+  EXPECT_NEAR(packed.w(), q.w(), tol);
+  nearCheck(Vector3D{packed[1], packed[2], packed[3]}, q.vec(), tol);
+}
+} // namespace
+
+TEST(PackedQuaternion, Layout) {
+  EXPECT_EQ(alignof(PackedQuaternion) % 16, 0u);
+  EXPECT_EQ(sizeof(PackedQuaternion), 4 * sizeof(num_t));
+
+  const PackedQuaternion q{1, 2, 3, 4};
+  const num_t *data = q.data();
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(data) % 16, 0u);
+  for (unsigned int i = 0; i < 4; i++) {
+    EXPECT_EQ(data[i], static_cast<num_t>(i + 1));
+  }
+
+  const PackedQuaternion identity;
+  EXPECT_EQ(identity, (PackedQuaternion{1, 0, 0, 0}));
+  EXPECT_NE(identity, q);
+}
+
+TEST(PackedQuaternion, Convert) {
+  const Quaternion q{0.3, {-1.2, 4.5, 0.25}};
+  const PackedQuaternion packed{q};
+  quatCheck(packed, q, 0);
+
+  const Quaternion back = packed.toQuaternion();
+  EXPECT_EQ(back.w(), q.w());
+  nearCheck(back.vec(), q.vec(), 0);
+}
+
+TEST(PackedQuaternion, Product) {
+  const Quaternion quats[] = {Quaternion{{1, 2, 3}, 0.7},
+                               Quaternion{{-2, 1, 0.5}, 2.9},
+                               Quaternion{3, {4.4, 1, 5.1}},
+                               Quaternion{-0.5, {0, -1.5, 2}},
+                               Quaternion{{0, 0, 1}, -M_PI},
+                               Quaternion{}};
+
+  for (const Quaternion &lhs : quats) {
+    for (const Quaternion &rhs : quats) {
+      // some of the products are far from unit length
+      const double tol = numTol(1e-12, 1e-5);
+      quatCheck(PackedQuaternion{lhs} * PackedQuaternion{rhs}, lhs * rhs, tol);
+
+      PackedQuaternion acc{lhs};
+      acc *= PackedQuaternion{rhs};
+      quatCheck(acc, lhs * rhs, tol);
+    }
+  }
+}
+
+TEST(PackedQuaternion, ConjNormUnit) {
+  const Quaternion q{3, {4.4, -1, 5.1}};
+  const PackedQuaternion packed{q};
+
+  quatCheck(packed.conj(), q.conj());
+  EXPECT_NEAR(packed.norm(), q.norm(), numTol(1e-12, 1e-5));
+  quatCheck(packed.unit(), q.unit());
+  EXPECT_NEAR(packed.unit().norm(), 1, numTol(1e-12, 1e-6));
+}
+
+TEST(PackedQuaternion, Chain) {
+  // a long chain of small rotations stays in step with Quaternion
+  const Quaternion delta{{0.3, -0.2, 1}, 0.01};
+  const PackedQuaternion packedDelta{delta};
+  Quaternion q;
+  PackedQuaternion packed;
+
+  for (int i = 0; i < 1000; i++) {
+    q = (q * delta).unit();
+    packed = (packed * packedDelta).unit();
+  }
+
+  quatCheck(packed, q, numTol(1e-9, 1e-5));
+}
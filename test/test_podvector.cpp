@@ -0,0 +1,92 @@
+#include <cmath>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+#include <imunano33/podvector.hpp>
+
+using namespace imunano33;
+
+static_assert(std::is_trivially_copyable<PodVec3D>::value,
+              "PodVec3D must be trivially copyable");
+static_assert(std::is_standard_layout<PodVec3D>::value,
+              "PodVec3D must have standard layout");
+static_assert(sizeof(PodVec3D) == 3 * sizeof(num_t),
+              "PodVec3D must hold only its components");
+static_assert(dot(PodVec3D{1, 2, 3}, PodVec3D{4, 5, 6}) == 32,
+              "dot must be usable in constant expressions");
+
+namespace {
+void expectEq(const PodVec3D &actual, const num_t ex, const num_t ey,
+              const num_t ez) {
+  EXPECT_EQ(actual.x, ex);
+  EXPECT_EQ(actual.y, ey);
+  EXPECT_EQ(actual.z, ez);
+}
+} // namespace
+
+TEST(PodVectorTest, Construct) {
+  expectEq(PodVec3D{}, 0, 0, 0);
+  expectEq(PodVec3D{1, -2, 3}, 1, -2, 3);
+}
+
+TEST(PodVectorTest, Components) {
+  PodVec3D v{1, 2, 3};
+  EXPECT_EQ(x(v), 1);
+  EXPECT_EQ(y(v), 2);
+  EXPECT_EQ(z(v), 3);
+
+  x(v, 4);
+  y(v, 5);
+  z(v, 6);
+  expectEq(v, 4, 5, 6);
+}
+
+TEST(PodVectorTest, Arithmetic) {
+  const PodVec3D a{1, 2, 3};
+  const PodVec3D b{4, -5, 6};
+
+  expectEq(a + b, 5, -3, 9);
+  expectEq(a - b, -3, 7, -3);
+  expectEq(-a, -1, -2, -3);
+  expectEq(+a, 1, 2, 3);
+  expectEq(a * 2, 2, 4, 6);
+  expectEq(b / 2, 2, -2.5, 3);
+
+  PodVec3D c = a;
+  c += b;
+  expectEq(c, 5, -3, 9);
+  c -= b;
+  expectEq(c, 1, 2, 3);
+  c *= 4;
+  expectEq(c, 4, 8, 12);
+  c /= 2;
+  expectEq(c, 2, 4, 6);
+}
+
+TEST(PodVectorTest, Compare) {
+  EXPECT_TRUE((PodVec3D{1, 2, 3} == PodVec3D{1, 2, 3}));
+  EXPECT_FALSE((PodVec3D{1, 2, 3} == PodVec3D{1, 2, 4}));
+  EXPECT_TRUE((PodVec3D{1, 2, 3} != PodVec3D{0, 2, 3}));
+  EXPECT_TRUE(isZero(PodVec3D{}));
+  EXPECT_FALSE(isZero(PodVec3D{0, 0, 1e-30}));
+}
+
+TEST(PodVectorTest, Products) {
+  const PodVec3D a{1, 2, 3};
+  const PodVec3D b{4, 5, 6};
+
+  EXPECT_EQ(dot(a, b), 32);
+  expectEq(cross(a, b), -3, 6, -3);
+  expectEq(cross(PodVec3D{1, 0, 0}, PodVec3D{0, 1, 0}), 0, 0, 1);
+}
+
+TEST(PodVectorTest, Magnitude) {
+  const PodVec3D v{2, -3, 6};
+  EXPECT_NEAR(magn(v), 7, 1e-6);
+
+  const PodVec3D n = normalize(v);
+  EXPECT_NEAR(magn(n), 1, 1e-6);
+  EXPECT_NEAR(n.x, 2.0 / 7, 1e-6);
+  EXPECT_NEAR(n.y, -3.0 / 7, 1e-6);
+  EXPECT_NEAR(n.z, 6.0 / 7, 1e-6);
+}
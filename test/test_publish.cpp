@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <imunano33/imunano33.hpp>
+#include <imunano33/publish.hpp>
+
+using namespace imunano33;
+
+TEST(ClimatePublisher, Default) {
+  ClimatePublisher pub;
+  EXPECT_TRUE(pub.update(20, 50, 100, 0));
+  EXPECT_EQ(pub.getChangedChannels(),
+            TEMPERATURE_CHANNEL | HUMIDITY_CHANNEL | PRESSURE_CHANNEL);
+
+  // identical readings are not published
+  EXPECT_FALSE(pub.update(20, 50, 100, 1));
+  EXPECT_TRUE(pub.update(20, 50.1, 100, 2));
+  EXPECT_EQ(pub.getChangedChannels(),
+            static_cast<unsigned int>(HUMIDITY_CHANNEL));
+}
+
+TEST(ClimatePublisher, Deadband) {
+  ClimatePublisher pub{0.5, 2, 0.1};
+  EXPECT_TRUE(pub.update(20, 50, 100, 0));
+
+  EXPECT_FALSE(pub.update(20.4, 51, 100.05, 1));
+  EXPECT_FALSE(pub.update(19.6, 48.5, 99.95, 2));
+
+  EXPECT_TRUE(pub.update(20.6, 50, 100, 3));
+  EXPECT_EQ(pub.getChangedChannels(),
+            static_cast<unsigned int>(TEMPERATURE_CHANNEL));
+  EXPECT_NEAR(pub.getTemp(), 20.6, 0.0001);
+  EXPECT_NEAR(pub.getPublishTime(), 3, 0.0001);
+
+  // compared against the last published reading, so slow drift is caught
+  EXPECT_FALSE(pub.update(20.6, 50, 100.08, 4));
+  EXPECT_FALSE(pub.update(20.6, 50, 100.09, 5));
+  EXPECT_TRUE(pub.update(20.6, 50, 100.11, 6));
+  EXPECT_EQ(pub.getChangedChannels(),
+            static_cast<unsigned int>(PRESSURE_CHANNEL));
+}
+
+TEST(ClimatePublisher, Interval) {
+  ClimatePublisher pub{0.5, 2, 0.1};
+  pub.setInterval(10, 60);
+  EXPECT_TRUE(pub.update(20, 50, 100, 0));
+
+  // too soon, even though temperature changed
+  EXPECT_FALSE(pub.update(25, 50, 100, 5));
+  EXPECT_TRUE(pub.update(25, 50, 100, 10));
+
+  // nothing changes, but the maximum interval passes
+  EXPECT_FALSE(pub.update(25, 50, 100, 40));
+  EXPECT_TRUE(pub.update(25, 50, 100, 70));
+  EXPECT_EQ(pub.getChangedChannels(), 0U);
+}
+
+TEST(ClimatePublisher, Smoothing) {
+  ClimatePublisher pub{0.5, 100, 100};
+  pub.setSmoothing(0.25);
+  EXPECT_TRUE(pub.update(20, 50, 100, 0));
+
+  // a single spike is smoothed out
+  EXPECT_FALSE(pub.update(21.6, 50, 100, 1));
+  EXPECT_NEAR(pub.getTemp(), 20.4, 0.0001);
+  EXPECT_FALSE(pub.update(20, 50, 100, 2));
+
+  // but a lasting change gets through
+  bool published = false;
+  for (int i = 3; i < 20 && !published; i++) {
+    published = pub.update(22, 50, 100, i);
+  }
+  EXPECT_TRUE(published);
+  EXPECT_GT(pub.getTemp(), 20.5);
+}
+
+TEST(ClimatePublisher, Reset) {
+  ClimatePublisher pub;
+  EXPECT_TRUE(pub.update(20, 50, 100, 0));
+  EXPECT_FALSE(pub.update(20, 50, 100, 1));
+  pub.reset();
+  EXPECT_TRUE(pub.update(20, 50, 100, 2));
+}
+
+TEST(ClimatePublisher, IMUNano33) {
+  IMUNano33 proc;
+  proc.climatePublisher().setDeadband(0.5, 2, 0.1);
+  proc.climatePublisher().setInterval(0, 30);
+  EXPECT_FALSE(proc.climateChanged());
+
+  proc.updateClimate(20, 50, 100, 0);
+  EXPECT_TRUE(proc.climateChanged());
+  proc.updateIMUGyro({0, 0, 0}, 10);
+  proc.updateClimate(20.1, 50, 100, 10);
+  EXPECT_FALSE(proc.climateChanged());
+
+  // maximum interval uses the climate time
+  proc.updateIMUGyro({0, 0, 0}, 25);
+  proc.updateClimate(20.1, 50, 100, 25);
+  EXPECT_TRUE(proc.climateChanged());
+
+  proc.resetClimate();
+  EXPECT_FALSE(proc.climateChanged());
+  proc.updateClimate(20.1, 50, 100, 10);
+  EXPECT_TRUE(proc.climateChanged());
+}
+
+TEST(ClimatePublisher, IMUNano33ClimateOnly) {
+  // no IMU updates, so the intervals must follow the climate time
+  IMUNano33 proc;
+  proc.climatePublisher().setInterval(5, 30);
+
+  proc.updateClimate(20, 50, 100, 0);
+  EXPECT_TRUE(proc.climateChanged());
+
+  // minimum interval
+  proc.updateClimate(25, 50, 100, 1);
+  EXPECT_FALSE(proc.climateChanged());
+  proc.updateClimate(25, 50, 100, 5);
+  EXPECT_TRUE(proc.climateChanged());
+
+  // heartbeat after the maximum interval
+  for (int i = 0; i < 5; i++) {
+    proc.updateClimate(25, 50, 100, 5);
+    EXPECT_FALSE(proc.climateChanged());
+  }
+  proc.updateClimate(25, 50, 100, 5);
+  EXPECT_TRUE(proc.climateChanged());
+  EXPECT_NEAR(proc.getClimateTime(), 36, 0.0001);
+  EXPECT_EQ(proc.getTime(), 0);
+}
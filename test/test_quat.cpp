@@ -4,7 +4,6 @@
 #include "testutil.hpp"
 
 using namespace imunano33;
-using namespace svector;
 
 // if rotate works, then rotation constructor, w(), vec(), norm(), conj(),
 // inv() works
@@ -86,3 +85,172 @@ TEST(Quaternion, AssignTest) {
   EXPECT_NEAR(b.w(), 3, 0.0001);
   nearCheck(b.vec(), {1, 2, 4}, 0.0001);
 }
+
+TEST(Quaternion, ToEulerSingleAxis) {
+  Vector3D res = Quaternion{{1, 0, 0}, 0.5}.toEuler();
+  nearCheck(res, {0.5, 0, 0});
+
+  res = Quaternion{{0, 1, 0}, -0.7}.toEuler();
+  nearCheck(res, {0, -0.7, 0});
+
+  res = Quaternion{{0, 0, 1}, 2.5}.toEuler();
+  nearCheck(res, {0, 0, 2.5});
+}
+
+TEST(Quaternion, EulerRoundTrip) {
+  const double angles[][3] = {
+      {0.1, 0.2, 0.3}, {-1.2, 0.9, 2.8}, {3, -1.5, -3}, {0, 0, 0}};
+  for (const auto &a : angles) {
+    Quaternion q = Quaternion::fromEuler(a[0], a[1], a[2]);
+    EXPECT_NEAR(q.norm(), 1, 0.0001);
+    nearCheck(q.toEuler(), Vector3D(a[0], a[1], a[2]));
+  }
+}
+
+TEST(Quaternion, FromEulerOrder) {
+  // yaw first, then pitch around the new y axis, then roll
+  Quaternion expected = Quaternion{{0, 0, 1}, 0.3} *
+                        Quaternion{{0, 1, 0}, 0.2} *
+                        Quaternion{{1, 0, 0}, 0.1};
+  Quaternion q = Quaternion::fromEuler(0.1, 0.2, 0.3);
+  EXPECT_NEAR(q.w(), expected.w(), 0.0001);
+  nearCheck(q.vec(), expected.vec());
+}
+
+TEST(Quaternion, EulerGimbalLock) {
+  Quaternion q{{0, 1, 0}, M_PI / 2};
+  Vector3D res = q.toEuler();
+  // asin() is ill-conditioned at the lock, so float loses half its digits
+  EXPECT_NEAR(y(res), M_PI / 2, numTol(0.0001, 0.001));
+  EXPECT_FALSE(std::isnan(x(res)));
+  EXPECT_FALSE(std::isnan(z(res)));
+}
+
+TEST(Quaternion, ToMatrix) {
+  Quaternion q = Quaternion::fromEuler(0.4, -0.3, 1.1);
+  RotationMatrix mat = q.toMatrix();
+
+  const Vector3D vecs[] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, -2, 3.5}};
+  for (const auto &vec : vecs) {
+    nearCheck(mat.rotate(vec), q.rotate(vec));
+  }
+
+  // not a unit quaternion
+  Quaternion q2{2, {0, 0, 2}};
+  nearCheck(q2.toMatrix().rotate({1, 0, 0}), {0, 1, 0});
+}
+
+TEST(Quaternion, ToAxisAngle) {
+  Quaternion q{{1, 2, 2}, 1.3};
+  AxisAngle res = q.toAxisAngle();
+  nearCheck(res.axis, {1.0 / 3, 2.0 / 3, 2.0 / 3});
+  EXPECT_NEAR(res.angle, 1.3, 0.0001);
+
+  res = Quaternion{}.toAxisAngle();
+  nearCheck(res.axis, {1, 0, 0});
+  EXPECT_NEAR(res.angle, 0, 0.0001);
+}
+
+TEST(Quaternion, RotVec) {
+  Quaternion q{{0, 0, 1}, 0.5};
+  nearCheck(q.toRotVec(), {0, 0, 0.5});
+  nearCheck(Quaternion::fromRotVec({0, 0, 0.5}).vec(), q.vec());
+
+  // -q is the same rotation, so give the shorter one
+  Quaternion neg{-q.w(), -q.vec()};
+  nearCheck(neg.toRotVec(), {0, 0, 0.5});
+
+  nearCheck(Quaternion{}.toRotVec(), {0, 0, 0});
+  EXPECT_EQ(Quaternion::fromRotVec({0, 0, 0}), Quaternion{});
+}
+
+TEST(Quaternion, Slerp) {
+  Quaternion from{{0, 0, 1}, 0.2};
+  Quaternion to{{0, 0, 1}, 1.4};
+
+  EXPECT_NEAR(slerp(from, to, 0).toAxisAngle().angle, 0.2, 0.0001);
+  EXPECT_NEAR(slerp(from, to, 1).toAxisAngle().angle, 1.4, 0.0001);
+  EXPECT_NEAR(slerp(from, to, 0.25).toAxisAngle().angle, 0.5, 0.0001);
+
+  // other axes, constant angular velocity
+  from = Quaternion::fromEuler(0.3, -0.2, 0.1);
+  to = Quaternion::fromEuler(-1.1, 0.7, 2.0);
+  const num_t total = magn((from.conj() * to).toRotVec());
+  for (int i = 0; i <= 10; i++) {
+    const num_t t = i / 10.0;
+    const Quaternion q = slerp(from, to, t);
+    EXPECT_NEAR(q.norm(), 1, 0.0001);
+    EXPECT_NEAR(magn((from.conj() * q).toRotVec()), total * t, 0.0001);
+  }
+}
+
+TEST(Quaternion, SlerpShortestPath) {
+  // same rotations as before, but with one in the other hemisphere
+  Quaternion from{{1, 0, 0}, 0.2};
+  Quaternion to{{1, 0, 0}, 0.6};
+  Quaternion toNeg{-to.w(), -to.vec()};
+
+  const Quaternion res = slerp(from, toNeg, 0.5);
+  EXPECT_NEAR(magn(res.toRotVec()), 0.4, 0.0001);
+
+  const Quaternion resN = nlerp(from, toNeg, 0.5);
+  EXPECT_NEAR(magn(resN.toRotVec()), 0.4, 0.0001);
+  EXPECT_NEAR(resN.norm(), 1, 0.0001);
+
+  // nearly equal rotations fall back on nlerp
+  Quaternion close{{1, 0, 0}, 0.2001};
+  EXPECT_NEAR(magn(slerp(from, close, 0.5).toRotVec()), 0.20005, 0.00001);
+}
+
+TEST(Quaternion, Squad) {
+  const Quaternion keys[] = {
+      Quaternion::fromEuler(0, 0, 0), Quaternion::fromEuler(0.4, 0.1, 0.5),
+      Quaternion::fromEuler(0.5, 0.6, 1.2), Quaternion::fromEuler(0.2, 1.0, 2)};
+  const Quaternion s1 = squadControl(keys[0], keys[1], keys[2]);
+  const Quaternion s2 = squadControl(keys[1], keys[2], keys[3]);
+
+  Quaternion res = squad(keys[1], keys[2], s1, s2, 0);
+  EXPECT_NEAR(res.w(), keys[1].w(), 0.0001);
+  nearCheck(res.vec(), keys[1].vec());
+
+  res = squad(keys[1], keys[2], s1, s2, 1);
+  EXPECT_NEAR(res.w(), keys[2].w(), 0.0001);
+  nearCheck(res.vec(), keys[2].vec());
+
+  EXPECT_NEAR(squad(keys[1], keys[2], s1, s2, 0.5).norm(), 1, 0.0001);
+
+  // control points of evenly spaced rotations about one axis are the rotations
+  // themselves, so squad becomes slerp
+  const Quaternion a{{0, 1, 0}, 0.1};
+  const Quaternion b{{0, 1, 0}, 0.4};
+  const Quaternion c{{0, 1, 0}, 0.7};
+  const Quaternion ctrl = squadControl(a, b, c);
+  EXPECT_NEAR(ctrl.w(), b.w(), 0.0001);
+  nearCheck(ctrl.vec(), b.vec());
+}
+
+TEST(Quaternion, SlerpFrames) {
+  const Quaternion from = Quaternion::fromEuler(0.3, -0.2, 0.1);
+  const Quaternion to = Quaternion::fromEuler(-1.1, 0.7, 2.0);
+  Quaternion toNeg{-to.w(), -to.vec()};
+
+  Quaternion frames[21];
+  for (const auto &dest : {to, toNeg}) {
+    slerpFrames(from, dest, 0, 0.05, frames, 21);
+    for (int i = 0; i < 21; i++) {
+      const Quaternion expected = slerp(from, dest, i * 0.05);
+      EXPECT_NEAR(frames[i].w(), expected.w(), 0.0001);
+      nearCheck(frames[i].vec(), expected.vec());
+    }
+  }
+
+  // close rotations
+  const Quaternion close = from * Quaternion{{0, 1, 0}, 0.001};
+  slerpFrames(from, close, 0.1, 0.1, frames, 5);
+  const Quaternion expected = slerp(from, close, 0.5);
+  EXPECT_NEAR(frames[4].w(), expected.w(), 0.0001);
+  nearCheck(frames[4].vec(), expected.vec());
+
+  // should not touch anything
+  slerpFrames(from, to, 0, 0.1, nullptr, 0);
+}
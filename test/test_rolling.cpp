@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <imunano33/rolling.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+// deterministic pseudo-random values in [-amp, amp]
+double noise(int i, double amp) { return amp * std::sin(i * 12.9898); }
+
+template <unsigned int N>
+void bruteCheck(const RollingWindow<N> &w, const num_t *values, int end) {
+  const int start = std::max(0, end - static_cast<int>(N));
+  const int count = end - start;
+  ASSERT_EQ(w.size(), static_cast<unsigned int>(count));
+
+  double sum = 0;
+  num_t lo = values[start];
+  num_t hi = values[start];
+  for (int i = start; i < end; i++) {
+    sum += values[i];
+    lo = std::min(lo, values[i]);
+    hi = std::max(hi, values[i]);
+    EXPECT_EQ(w.at(i - start), values[i]);
+  }
+  const double mean = sum / count;
+
+  double var = 0;
+  for (int i = start; i < end; i++) {
+    var += (values[i] - mean) * (values[i] - mean);
+  }
+  var /= count;
+
+  EXPECT_NEAR(w.getMean(), mean, numTol(0.000001, 0.0001));
+  EXPECT_NEAR(w.getVariance(), var, numTol(0.000001, 0.0001));
+  EXPECT_EQ(w.getMin(), lo);
+  EXPECT_EQ(w.getMax(), hi);
+  EXPECT_EQ(w.latest(), values[end - 1]);
+}
+} // namespace
+
+TEST(RollingWindow, Empty) {
+  RollingWindow<4> w;
+  EXPECT_TRUE(w.empty());
+  EXPECT_FALSE(w.full());
+  EXPECT_EQ(w.size(), 0U);
+  EXPECT_EQ(w.capacity(), 4U);
+  EXPECT_EQ(w.getMean(), 0);
+  EXPECT_EQ(w.getVariance(), 0);
+  EXPECT_EQ(w.getMin(), 0);
+  EXPECT_EQ(w.getMax(), 0);
+}
+
+TEST(RollingWindow, MatchesBruteForce) {
+  num_t values[200];
+  for (int i = 0; i < 200; i++) {
+    values[i] = static_cast<num_t>(20 + noise(i, 5));
+  }
+
+  RollingWindow<7> w;
+  for (int i = 0; i < 200; i++) {
+    w.push(values[i]);
+    bruteCheck(w, values, i + 1);
+  }
+}
+
+TEST(RollingWindow, Monotonic) {
+  // increasing and decreasing runs keep the queues at their longest and
+  // shortest
+  num_t values[60];
+  for (int i = 0; i < 60; i++) {
+    values[i] = i < 30 ? i : 60 - i;
+  }
+
+  RollingWindow<8> w;
+  for (int i = 0; i < 60; i++) {
+    w.push(values[i]);
+    bruteCheck(w, values, i + 1);
+  }
+}
+
+TEST(RollingWindow, Repeated) {
+  RollingWindow<5> w;
+  for (int i = 0; i < 12; i++) {
+    w.push(3);
+  }
+  EXPECT_EQ(w.getMin(), 3);
+  EXPECT_EQ(w.getMax(), 3);
+  EXPECT_NEAR(w.getVariance(), 0, 0.000001);
+
+  w.push(1);
+  EXPECT_EQ(w.getMin(), 1);
+  EXPECT_EQ(w.getMax(), 3);
+}
+
+TEST(RollingWindow, Reset) {
+  RollingWindow<3> w;
+  w.push(1);
+  w.push(5);
+  w.push(9);
+  w.push(2);
+  w.reset();
+  EXPECT_TRUE(w.empty());
+
+  w.push(4);
+  EXPECT_EQ(w.getMin(), 4);
+  EXPECT_EQ(w.getMax(), 4);
+  EXPECT_EQ(w.getMean(), 4);
+  EXPECT_EQ(w.at(0), 4);
+}
+
+TEST(WindowMoments, Strided) {
+  // two interleaved channels, where only the second is tracked
+  num_t values[4][2] = {{0, 1}, {0, 2}, {0, 3}, {0, 4}};
+  WindowMoments<4> m;
+  for (unsigned int i = 0; i < 4; i++) {
+    m.add(values[i][1], i + 1);
+  }
+  EXPECT_NEAR(m.getMean(), 2.5, 0.000001);
+  EXPECT_NEAR(m.getM2(), 5, 0.000001);
+
+  m.replace(values[0][1], 9);
+  values[0][1] = 9;
+  EXPECT_NEAR(m.getMean(), 4.5, 0.000001);
+  EXPECT_NEAR(m.getM2(), 29, 0.000001);
+
+  m.resync(&values[0][1], 2);
+  EXPECT_NEAR(m.getMean(), 4.5, 0.000001);
+  EXPECT_NEAR(m.getM2(), 29, 0.000001);
+
+  m.reset();
+  EXPECT_EQ(m.getMean(), 0);
+  EXPECT_EQ(m.getM2(), 0);
+}
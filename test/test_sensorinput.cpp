@@ -0,0 +1,83 @@
+#include <cstdint>
+
+#include <gtest/gtest.h>
+#include <imunano33/imunano33.hpp>
+#include <imunano33/sensorinput.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+// the Nano 33 BLE Sense mounting from the example sketch
+using AccelInput = SensorInput<POS_X, NEG_Y, NEG_Z>;
+using GyroInput = SensorInput<NEG_X, POS_Y, POS_Z, DegToRad>;
+
+// a 16-bit gyro at 131 LSB per dps, mounted rotated about z
+using LsbGyroInput =
+    SensorInput<POS_Y, NEG_X, POS_Z,
+                ScaleProduct<ScaleRatio<1, 131>, DegToRad>>;
+} // namespace
+
+TEST(SensorInput, Mounting) {
+  nearCheck(AccelInput::apply(0.1, 0.2, 0.98), Vector3D{0.1, -0.2, -0.98});
+  nearCheck(GyroInput::apply(Vector3D{90, -180, 45}),
+            Vector3D{-M_PI / 2, -M_PI, M_PI / 4}, 1e-12);
+  nearCheck(LsbGyroInput::apply<int16_t>(131, -262, 655),
+            Vector3D{-M_PI / 90, -M_PI / 180, M_PI / 36}, 1e-12);
+}
+
+TEST(SensorInput, Coefficients) {
+  static_assert(AccelInput::coeff(NEG_Y) == -1, "sign is not constexpr");
+  static_assert(LsbGyroInput::index(POS_Y) == 1, "index is not constexpr");
+  EXPECT_NEAR(GyroInput::coeff(NEG_X), -M_PI / 180, numTol(1e-15, 1e-9));
+  EXPECT_NEAR(GyroInput::coeff(POS_Z), M_PI / 180, numTol(1e-15, 1e-9));
+}
+
+TEST(SensorInput, Batch) {
+  const int16_t raw[6] = {131, -262, 655, 0, 1310, -131};
+  num_t out[6];
+  LsbGyroInput::apply(raw, out, 2);
+
+  for (unsigned int i = 0; i < 2; i++) {
+    const Vector3D expect =
+        LsbGyroInput::apply(raw[3 * i], raw[3 * i + 1], raw[3 * i + 2]);
+    nearCheck(Vector3D{out[3 * i], out[3 * i + 1], out[3 * i + 2]}, expect,
+              0);
+  }
+
+  // in place
+  num_t values[3] = {0.1, 0.2, 0.98};
+  AccelInput::apply(values, values, 1);
+  nearCheck(Vector3D{values[0], values[1], values[2]},
+            Vector3D{0.1, -0.2, -0.98});
+}
+
+TEST(SensorInput, IMUNano33) {
+  // raw readings match converted readings through every update path
+  const num_t accel[6] = {0.1, 0.2, 0.98, -0.05, 0.1, 1.01};
+  const num_t gyro[6] = {10, -5, 20, 3, 4, -8};
+  const num_t deltaT = 0.01;
+
+  IMUNano33 expect;
+  IMUNano33 single;
+  IMUNano33 batch;
+  IMUNano33 separate;
+  for (unsigned int i = 0; i < 2; i++) {
+    const num_t *a = accel + 3 * i;
+    const num_t *g = gyro + 3 * i;
+    expect.updateIMU(Vector3D{a[0], -a[1], -a[2]},
+                     Vector3D{-g[0], g[1], g[2]} * (M_PI / 180), deltaT);
+    single.updateIMURaw<AccelInput, GyroInput>(a, g, deltaT);
+    separate.updateIMUGyroRaw<GyroInput>(g[0], g[1], g[2], deltaT);
+    separate.updateIMUAccelRaw<AccelInput>(a[0], a[1], a[2], deltaT);
+  }
+  batch.updateIMURaw<AccelInput, GyroInput>(accel, gyro, 2, deltaT);
+
+  const Quaternion q = expect.getRotQ();
+  for (const IMUNano33 *proc : {&single, &batch, &separate}) {
+    EXPECT_NEAR(proc->getRotQ().w(), q.w(), 1e-12);
+    nearCheck(proc->getRotQ().vec(), q.vec(), 1e-12);
+  }
+  EXPECT_NEAR(batch.getTime(), expect.getTime(), 1e-12);
+}
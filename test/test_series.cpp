@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <imunano33/filter.hpp>
+#include <imunano33/series.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+// angle between two rotations, from the rotation between them in double, as
+// the acos() of their dot product is too coarse near 0 in float
+double angleBetween(const Quaternion &a, const Quaternion &b) {
+  const double aw = a.w();
+  const double bw = b.w();
+  const double av[] = {x(a.vec()), y(a.vec()), z(a.vec())};
+  const double bv[] = {x(b.vec()), y(b.vec()), z(b.vec())};
+
+  // a * b.conj(), whose vector part has the same length with either sign of
+  // the cross product
+  double w = aw * bw;
+  double vecSq = 0;
+  for (int i = 0; i < 3; i++) {
+    const int j = (i + 1) % 3;
+    const int k = (i + 2) % 3;
+    w += av[i] * bv[i];
+    const double v = bw * av[i] - aw * bv[i] + av[j] * bv[k] - av[k] * bv[j];
+    vecSq += v * v;
+  }
+  return 2 * std::atan2(std::sqrt(vecSq), std::fabs(w));
+}
+
+// tumbles through every axis so the dropped component changes often
+std::vector<Quaternion> tumble(const unsigned int count) {
+  std::vector<Quaternion> quats;
+  Quaternion q;
+  const Quaternion delta{{1, 0.7, -0.4}, 0.03};
+  for (unsigned int i = 0; i < count; i++) {
+    quats.push_back(q);
+    q = (q * delta * Quaternion(Vector3D{0, 1, 0}, 0.002 * (i % 50))).unit();
+  }
+  return quats;
+}
+} // namespace
+
+TEST(OrientationSeries, RoundTrip) {
+  const std::vector<Quaternion> quats = tumble(2000);
+  OrientationSeries series;
+  for (const Quaternion &q : quats) {
+    series.append(q);
+  }
+  ASSERT_EQ(series.size(), quats.size());
+
+  std::vector<PackedQuaternion> decoded(quats.size());
+  series.decode(0, quats.size(), decoded.data());
+  for (std::size_t i = 0; i < quats.size(); i++) {
+    EXPECT_LT(angleBetween(decoded[i].toQuaternion(), quats[i]), 1e-4) << i;
+    EXPECT_NEAR(decoded[i].norm(), 1, 1e-4);
+  }
+
+  // far smaller than the quaternions themselves, even in float
+  EXPECT_LT(series.byteSize(), quats.size() * 4 * sizeof(float) / 2);
+}
+
+TEST(OrientationSeries, RandomAccess) {
+  const std::vector<Quaternion> quats = tumble(1000);
+  OrientationSeries series{16, 64};
+  for (const Quaternion &q : quats) {
+    series.append(q);
+  }
+
+  std::vector<PackedQuaternion> all(quats.size());
+  series.decode(0, quats.size(), all.data());
+
+  // ranges starting and ending inside blocks
+  const std::size_t ranges[][2] = {{0, 1}, {63, 2}, {100, 300}, {999, 1}};
+  for (const auto &range : ranges) {
+    std::vector<PackedQuaternion> part(range[1]);
+    series.decode(range[0], range[1], part.data());
+    for (std::size_t i = 0; i < range[1]; i++) {
+      EXPECT_EQ(part[i], all[range[0] + i]);
+    }
+  }
+
+  for (std::size_t i = 0; i < quats.size(); i += 37) {
+    EXPECT_EQ(PackedQuaternion{series.at(i)}, all[i]);
+  }
+}
+
+TEST(OrientationSeries, Sign) {
+  // q and -q are the same rotation and decode the same
+  OrientationSeries series;
+  const Quaternion q{{0.3, -1, 0.2}, 2.5};
+  series.append(q);
+  series.append(Quaternion{-q.w(), q.vec() * -1});
+
+  EXPECT_EQ(PackedQuaternion{series.at(0)}, PackedQuaternion{series.at(1)});
+  EXPECT_LT(angleBetween(series.at(0), q), 1e-4);
+}
+
+TEST(OrientationSeries, Bits) {
+  const std::vector<Quaternion> quats = tumble(500);
+  OrientationSeries coarse{10};
+  OrientationSeries fine{20};
+  for (const Quaternion &q : quats) {
+    coarse.append(q);
+    fine.append(q);
+  }
+
+  double coarseErr = 0;
+  double fineErr = 0;
+  for (std::size_t i = 0; i < quats.size(); i++) {
+    coarseErr = std::max(coarseErr, angleBetween(coarse.at(i), quats[i]));
+    fineErr = std::max(fineErr, angleBetween(fine.at(i), quats[i]));
+  }
+  EXPECT_LT(coarseErr, 0.01);
+  EXPECT_LT(fineErr, 1e-5);
+  EXPECT_LT(coarse.byteSize(), fine.byteSize());
+}
+
+TEST(OrientationSeries, Filter) {
+  Filter filter;
+  OrientationSeries series;
+  for (int i = 0; i < 300; i++) {
+    filter.update({0, 0.5, -9.8}, {0.3, -0.1, 0.2}, 0.01);
+    series.append(filter.getRotQ());
+  }
+
+  EXPECT_LT(angleBetween(series.at(299), filter.getRotQ()), 1e-4);
+
+  series.clear();
+  EXPECT_EQ(series.size(), 0u);
+  series.append(filter.getRotQ());
+  EXPECT_LT(angleBetween(series.at(0), filter.getRotQ()), 1e-4);
+}
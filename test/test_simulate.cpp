@@ -0,0 +1,206 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <imunano33/filter.hpp>
+#include <imunano33/simulate.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+ImuSimulator::Motion tumbling() {
+  ImuSimulator::Motion motion;
+  motion.initialAngles = Vector3D{0.2, -0.4, 1};
+  motion.angleRate = Vector3D{0.5, 0.1, -0.8};
+  motion.shakeAmplitude = Vector3D{0.3, 0.2, 0.1};
+  motion.shakeFreq = 2;
+  motion.accelAmplitude = Vector3D{1, 2, 0.5};
+  motion.accelFreq = 0.5;
+  return motion;
+}
+
+double angleBetween(const Quaternion &a, const Quaternion &b) {
+  const double d = std::fabs(a.w() * b.w() + dot(a.vec(), b.vec()));
+  return 2 * std::acos(std::min(d, 1.0));
+}
+} // namespace
+
+TEST(ImuSimulator, Still) {
+  ImuSimulator sim{ImuSimulator::Motion{}, ImuSimulator::SensorModel{}, 100};
+  EXPECT_NEAR(sim.getDeltaT(), 0.01, numTol(1e-12, 1e-9));
+
+  for (int i = 0; i < 10; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    EXPECT_NEAR(sample.time, (i + 1) * 0.01, numTol(1e-12, 1e-7));
+    nearCheck(sample.gyro, Vector3D{});
+    nearCheck(sample.accel, Vector3D{0, 0, -9.80665});
+    EXPECT_NEAR(sample.orientation.w(), 1, 1e-12);
+  }
+}
+
+TEST(ImuSimulator, Euler) {
+  ImuSimulator::Motion motion;
+  motion.initialAngles = Vector3D{0.3, -0.2, 1.5};
+  ImuSimulator sim{motion, ImuSimulator::SensorModel{}, 100};
+
+  nearCheck(sim.current().orientation.toEuler(), motion.initialAngles,
+            numTol(1e-9, 1e-5));
+
+  // tilted, so gravity is no longer straight down in the body frame
+  const Vector3D down =
+      sim.current().orientation.rotate(sim.current().accel);
+  nearCheck(down, Vector3D{0, 0, -9.80665}, numTol(1e-9, 1e-5));
+}
+
+TEST(ImuSimulator, Reproducible) {
+  ImuSimulator::SensorModel sensor;
+  sensor.gyroNoise = 0.01;
+  sensor.accelNoise = 0.1;
+  sensor.dropout = 0.1;
+
+  ImuSimulator a{tumbling(), sensor, 200, 42};
+  ImuSimulator b{tumbling(), sensor, 200, 42};
+  ImuSimulator c{tumbling(), sensor, 200, 43};
+
+  bool differs = false;
+  for (int i = 0; i < 1000; i++) {
+    const ImuSimulator::Sample sampleA = a.next();
+    const ImuSimulator::Sample &sampleB = b.next();
+    const ImuSimulator::Sample &sampleC = c.next();
+    EXPECT_EQ(sampleA.gyro, sampleB.gyro);
+    EXPECT_EQ(sampleA.accel, sampleB.accel);
+    differs = differs || sampleA.gyro != sampleC.gyro;
+  }
+  EXPECT_TRUE(differs);
+
+  const Vector3D first = a.next().gyro;
+  a.reset();
+  for (int i = 0; i < 1000; i++) {
+    a.next();
+  }
+  EXPECT_EQ(a.next().gyro, first);
+}
+
+TEST(ImuSimulator, AngularVelocity) {
+  ImuSimulator sim{tumbling(), ImuSimulator::SensorModel{}, 1000};
+
+  // the orientation changes by the angular velocity in the body frame, so
+  // compare at the middle of each step
+  Quaternion prev = sim.current().orientation;
+  Vector3D prevRate = sim.current().angularVel;
+  for (int i = 0; i < 3000; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    const Quaternion qDot{
+        (sample.orientation.w() - prev.w()) / sample.deltaT,
+        (sample.orientation.vec() - prev.vec()) / sample.deltaT};
+    const Quaternion mid{(sample.orientation.w() + prev.w()) / 2,
+                         (sample.orientation.vec() + prev.vec()) / 2};
+    const Vector3D rate = (mid.conj() * qDot).vec() * 2;
+    // the difference of orientations 1 ms apart keeps few digits in float
+    nearCheck(rate, (prevRate + sample.angularVel) / 2, numTol(0.001, 0.01));
+    prev = sample.orientation;
+    prevRate = sample.angularVel;
+  }
+}
+
+TEST(ImuSimulator, LinearAccel) {
+  ImuSimulator sim{tumbling(), ImuSimulator::SensorModel{}, 1000};
+
+  Vector3D velocity;
+  for (int i = 0; i < 5000; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+
+    // reading is gravity minus linear acceleration, in the body frame
+    const Vector3D world = sample.orientation.rotate(sample.accel);
+    nearCheck(Vector3D{0, 0, -9.80665} - world, sample.linearAccel,
+              numTol(1e-9, 1e-5));
+
+    velocity += sample.linearAccel * sample.deltaT;
+  }
+  nearCheck(velocity, sim.current().velocity, 0.01);
+}
+
+TEST(ImuSimulator, Noise) {
+  ImuSimulator::SensorModel sensor;
+  sensor.gyroBias = Vector3D{0.01, -0.02, 0.03};
+  sensor.gyroNoise = 0.05;
+  sensor.accelBias = Vector3D{0.1, 0, -0.1};
+  sensor.accelNoise = 0.2;
+  ImuSimulator sim{ImuSimulator::Motion{}, sensor, 100, 7};
+
+  const int count = 100000;
+  Vector3D gyroSum;
+  Vector3D accelSum;
+  double gyroSq = 0;
+  for (int i = 0; i < count; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    gyroSum += sample.gyro;
+    accelSum += sample.accel;
+    const double dev = x(sample.gyro) - x(sensor.gyroBias);
+    gyroSq += dev * dev;
+  }
+
+  nearCheck(gyroSum / count, sensor.gyroBias, 0.001);
+  nearCheck(accelSum / count, Vector3D{0.1, 0, -9.90665}, 0.005);
+  EXPECT_NEAR(std::sqrt(gyroSq / count), 0.05, 0.001);
+}
+
+TEST(ImuSimulator, Dropout) {
+  ImuSimulator::SensorModel sensor;
+  sensor.dropout = 0.25;
+  ImuSimulator sim{tumbling(), sensor, 100, 3};
+
+  const int count = 20000;
+  int gyroDropped = 0;
+  int accelDropped = 0;
+  for (int i = 0; i < count; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    if (sample.gyroDropped) {
+      ++gyroDropped;
+      EXPECT_EQ(sample.gyro, Vector3D{});
+    }
+    if (sample.accelDropped) {
+      ++accelDropped;
+      EXPECT_EQ(sample.accel, Vector3D{});
+    }
+  }
+
+  EXPECT_NEAR(gyroDropped / static_cast<double>(count), 0.25, 0.01);
+  EXPECT_NEAR(accelDropped / static_cast<double>(count), 0.25, 0.01);
+}
+
+TEST(ImuSimulator, Resync) {
+  // long enough for many resyncs, which should not make the motion jump
+  ImuSimulator sim{tumbling(), ImuSimulator::SensorModel{}, 1000};
+  Quaternion prev = sim.current().orientation;
+  for (int i = 0; i < 5000; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    EXPECT_LT(angleBetween(prev, sample.orientation), 0.01);
+    prev = sample.orientation;
+  }
+}
+
+TEST(ImuSimulator, FilterTracks) {
+  ImuSimulator::SensorModel sensor;
+  sensor.gyroNoise = 0.01;
+  sensor.accelNoise = 0.05;
+  ImuSimulator::Motion motion;
+  motion.angleRate = Vector3D{0, 0, 1};
+  motion.shakeAmplitude = Vector3D{0.3, 0.3, 0};
+  motion.shakeFreq = 0.5;
+  ImuSimulator sim{motion, sensor, 200, 1};
+
+  Filter filter{0.98, sim.current().orientation};
+  for (int i = 0; i < 2000; i++) {
+    const ImuSimulator::Sample &sample = sim.next();
+    filter.update(sample.accel, sample.gyro, sample.deltaT);
+  }
+
+  // gravity keeps roll and pitch close, and yaw drifts slowly with noise
+  const Vector3D err =
+      filter.getRotQ().toEuler() - sim.current().orientation.toEuler();
+  EXPECT_LT(std::fabs(x(err)), 0.05);
+  EXPECT_LT(std::fabs(y(err)), 0.05);
+  EXPECT_LT(angleBetween(filter.getRotQ(), sim.current().orientation), 0.1);
+}
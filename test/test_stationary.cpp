@@ -0,0 +1,137 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <imunano33/stationary.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+// small deterministic jitter in [-amp, amp]
+double jitter(int i, double amp) { return amp * std::sin(i * 12.9898); }
+} // namespace
+
+TEST(StationaryDetector, NotFull) {
+  StationaryDetector<8> d;
+  for (int i = 0; i < 7; i++) {
+    d.updateGyro({0.01, 0, 0});
+    d.updateAccel({0, 0, -1});
+  }
+  EXPECT_FALSE(d.isStationary());
+
+  d.updateGyro({0.01, 0, 0});
+  EXPECT_FALSE(d.isStationary());
+
+  d.updateAccel({0, 0, -1});
+  EXPECT_TRUE(d.isStationary());
+}
+
+TEST(StationaryDetector, RestWithNoise) {
+  StationaryDetector<16> d;
+  for (int i = 0; i < 100; i++) {
+    d.updateGyro(Vector3D(0.02 + jitter(i, 0.001), -0.01 + jitter(i + 1, 0.001),
+                          0.005 + jitter(i + 2, 0.001)));
+    d.updateAccel(Vector3D(jitter(i, 0.005), jitter(i + 3, 0.005), -1));
+  }
+
+  EXPECT_TRUE(d.isStationary());
+  nearCheck(d.getGyroMean(), {0.02, -0.01, 0.005}, 0.001);
+  nearCheck(d.getAccelMean(), {0, 0, -1}, 0.002);
+}
+
+TEST(StationaryDetector, Rotating) {
+  StationaryDetector<16> d;
+  for (int i = 0; i < 100; i++) {
+    d.updateGyro(Vector3D(std::sin(i * 0.3), 0, 0));
+    d.updateAccel({0, 0, -1});
+  }
+  EXPECT_FALSE(d.isStationary());
+}
+
+TEST(StationaryDetector, SteadyRotationIsNotBias) {
+  StationaryDetector<16> d;
+  for (int i = 0; i < 100; i++) {
+    d.updateGyro({0, 0, 1});
+    d.updateAccel({0, 0, -1});
+  }
+  EXPECT_FALSE(d.isStationary());
+}
+
+TEST(StationaryDetector, Shaking) {
+  StationaryDetector<16> d;
+  for (int i = 0; i < 100; i++) {
+    d.updateGyro({0, 0, 0});
+    d.updateAccel(Vector3D(0.5 * std::sin(i * 0.7), 0, -1));
+  }
+  EXPECT_FALSE(d.isStationary());
+}
+
+TEST(StationaryDetector, AccelThresholdUnitless) {
+  // same relative noise in g and m/s^2 should give the same relative variance
+  StationaryDetector<16> g;
+  StationaryDetector<16> si;
+  for (int i = 0; i < 50; i++) {
+    g.updateAccel(Vector3D(jitter(i, 0.01), 0, -1));
+    si.updateAccel(Vector3D(jitter(i, 0.01) * 9.81, 0, -9.81));
+  }
+  EXPECT_NEAR(g.getAccelVariance(), si.getAccelVariance(), 1e-9);
+}
+
+TEST(StationaryDetector, SlidingVarianceMatchesDirect) {
+  const int n = 16;
+  const int total = 1000;
+  StationaryDetector<n> d;
+  double samples[total];
+  for (int i = 0; i < total; i++) {
+    samples[i] = 3 * std::sin(i * 0.37) + jitter(i, 0.5);
+    d.updateGyro(Vector3D(samples[i], 2 * samples[i], 0));
+
+    if (i < n - 1) {
+      continue;
+    }
+
+    double mean = 0;
+    for (int j = i - n + 1; j <= i; j++) {
+      mean += samples[j];
+    }
+    mean /= n;
+
+    double var = 0;
+    for (int j = i - n + 1; j <= i; j++) {
+      var += (samples[j] - mean) * (samples[j] - mean);
+    }
+    var /= n;
+
+    EXPECT_NEAR(x(d.getGyroMean()), mean, numTol(1e-9, 1e-6));
+    EXPECT_NEAR(d.getGyroVariance(), 5 * var, numTol(1e-9, 2e-5));
+  }
+}
+
+TEST(StationaryDetector, Reset) {
+  StationaryDetector<4> d;
+  for (int i = 0; i < 10; i++) {
+    d.updateGyro({0, 0, 0});
+    d.updateAccel({0, 0, -1});
+  }
+  EXPECT_TRUE(d.isStationary());
+
+  d.reset();
+  EXPECT_FALSE(d.isStationary());
+  nearCheck(d.getGyroMean(), {0, 0, 0});
+}
+
+TEST(StationaryDetector, Thresholds) {
+  StationaryDetector<8> d;
+  for (int i = 0; i < 20; i++) {
+    d.updateGyro(Vector3D(0.05 + jitter(i, 0.02), 0, 0));
+    d.updateAccel({0, 0, -1});
+  }
+  EXPECT_FALSE(d.isStationary());
+
+  d.setGyroThreshold(0.01);
+  EXPECT_TRUE(d.isStationary());
+
+  d.setMaxBias(0.01);
+  EXPECT_FALSE(d.isStationary());
+}
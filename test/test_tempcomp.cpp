@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <imunano33/imunano33.hpp>
+#include <imunano33/tempcomp.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+// per-axis bias and scale errors, as polynomials in (T - 25)
+Vector3D biasAt(double temp) {
+  const double dt = temp - 25;
+  return Vector3D(0.01 + 0.002 * dt, -0.02 + 0.0001 * dt * dt,
+                  0.005 - 0.001 * dt);
+}
+
+Vector3D gainAt(double temp) {
+  const double dt = temp - 25;
+  return Vector3D(1.02 + 0.001 * dt, 0.98,
+                  1 - 0.0005 * dt + 0.00001 * dt * dt);
+}
+
+// what a sensor with these errors reads
+Vector3D sensorReading(const Vector3D &truth, double temp) {
+  const Vector3D gain = gainAt(temp);
+  const Vector3D bias = biasAt(temp);
+  return {x(truth) * x(gain) + x(bias), y(truth) * y(gain) + y(bias),
+          z(truth) * z(gain) + z(bias)};
+}
+} // namespace
+
+TEST(TempCompensation, Identity) {
+  TempCompensation<2> comp;
+  comp.setTemp(60);
+  nearCheck(comp.apply({1, -2, 3}), {1, -2, 3});
+  EXPECT_NEAR(comp.getReferenceTemp(), 25, 0.0001);
+}
+
+TEST(TempCompensation, Evaluate) {
+  TempCompensation<1> comp;
+  comp.setReferenceTemp(20);
+  comp.setCoefficients(0, {2, 0.1}, {1, 0.5});
+  comp.setCoefficients(2, {1, 0}, {0, -1});
+
+  // at the reference temperature
+  comp.setTemp(20);
+  nearCheck(comp.apply({1, 1, 1}), {1, 1, 1});
+
+  comp.setTemp(30);
+  // x: 1 * (2 + 1) - (1 + 5), z: 1 - (-10)
+  nearCheck(comp.apply({1, 1, 1}), {-3, 1, 11});
+  EXPECT_NEAR(comp.getScaleCoefficient(0, 1), 0.1, 0.0001);
+  EXPECT_NEAR(comp.getOffsetCoefficient(2, 1), -1, 0.0001);
+}
+
+TEST(TempCompensation, FitOffsetOnly) {
+  // gyro at rest, so the reading is only the bias
+  TempCompensation<2>::Calibrator cal{false};
+  for (double temp = 5; temp <= 45; temp += 0.5) {
+    cal.addSample(temp, biasAt(temp), {0, 0, 0});
+  }
+  EXPECT_EQ(cal.getCount(), 81UL);
+
+  TempCompensation<2> comp;
+  ASSERT_TRUE(cal.fit(comp));
+  for (double temp = 0; temp <= 50; temp += 5) {
+    comp.setTemp(temp);
+    nearCheck(comp.apply(biasAt(temp)), {0, 0, 0}, numTol(1e-9, 1e-6));
+    nearCheck(comp.apply(Vector3D{0.3, 0, 0} + biasAt(temp)), {0.3, 0, 0},
+              numTol(1e-9, 1e-6));
+  }
+}
+
+TEST(TempCompensation, FitScaleAndOffset) {
+  // accelerometer held in six orientations at each temperature
+  const Vector3D orientations[] = {{9.8, 0, 0}, {-9.8, 0, 0}, {0, 9.8, 0},
+                                   {0, -9.8, 0}, {0, 0, 9.8}, {0, 0, -9.8}};
+  TempCompensation<2>::Calibrator cal;
+  for (double temp = 0; temp <= 50; temp += 2) {
+    for (const auto &truth : orientations) {
+      cal.addSample(temp, sensorReading(truth, temp), truth);
+    }
+  }
+
+  TempCompensation<2> comp;
+  ASSERT_TRUE(cal.fit(comp));
+
+  // the errors are not exactly polynomials in this model, but close
+  for (double temp = 5; temp <= 45; temp += 5) {
+    comp.setTemp(temp);
+    const Vector3D truth{3, -4, 7.5};
+    nearCheck(comp.apply(sensorReading(truth, temp)), truth, 0.001);
+  }
+}
+
+TEST(TempCompensation, FitUnderdetermined) {
+  // one temperature can't determine a quadratic
+  TempCompensation<2>::Calibrator cal{false};
+  for (int i = 0; i < 10; i++) {
+    cal.addSample(25, {0.1, 0.2, 0.3}, {0, 0, 0});
+  }
+
+  TempCompensation<2> comp;
+  EXPECT_FALSE(cal.fit(comp));
+  comp.setTemp(30);
+  nearCheck(comp.apply({1, 1, 1}), {1, 1, 1});
+
+  // gyro at rest can't determine the scale
+  TempCompensation<2>::Calibrator calScale;
+  for (double temp = 5; temp <= 45; temp += 1) {
+    calScale.addSample(temp, biasAt(temp), {0, 0, 0});
+  }
+  EXPECT_FALSE(calScale.fit(comp));
+
+  cal.reset();
+  EXPECT_EQ(cal.getCount(), 0UL);
+}
+
+TEST(TempCompensation, IMUNano33) {
+  TempCompensation<2>::Calibrator cal{false};
+  for (double temp = 5; temp <= 45; temp += 1) {
+    cal.addSample(temp, biasAt(temp), {0, 0, 0});
+  }
+  IMUNano33::TempComp comp;
+  ASSERT_TRUE(cal.fit(comp));
+
+  IMUNano33 proc;
+  proc.setGyroTempComp(comp);
+  proc.updateClimate(40, 50, 101, 1);
+
+  // gyro bias at 40 C would otherwise rotate the IMU
+  for (int i = 0; i < 100; i++) {
+    proc.updateIMUGyro(biasAt(40), 0.1);
+  }
+  Quaternion q = proc.getRotQ();
+  EXPECT_NEAR(q.w(), 1, 1e-6);
+
+  EXPECT_NEAR(proc.getGyroTempComp().getTemp(), 40, 0.0001);
+  EXPECT_NEAR(proc.getAccelTempComp().getTemp(), 40, 0.0001);
+}
+
+TEST(TempCompensation, IMUNano33ZeroReadings) {
+  TempCompensation<2>::Calibrator cal{false};
+  for (double temp = 5; temp <= 45; temp += 1) {
+    cal.addSample(temp, biasAt(temp), {0, 0, 0});
+  }
+  IMUNano33::TempComp comp;
+  ASSERT_TRUE(cal.fit(comp));
+
+  IMUNano33 proc;
+  proc.setGyroTempComp(comp);
+  proc.setAccelTempComp(comp);
+  proc.updateClimate(40, 50, 101);
+
+  // zero readings are missing readings, so the offset must not turn them into
+  // a rotation or a gravity vector
+  for (int i = 0; i < 100; i++) {
+    proc.updateIMUGyro({0, 0, 0}, 0.1);
+    proc.updateIMUAccel({0, 0, 0});
+    proc.updateIMU({0, 0, 0}, {0, 0, 0}, 0.1);
+  }
+  Quaternion q = proc.getRotQ();
+  EXPECT_NEAR(q.w(), 1, 1e-6);
+}
@@ -0,0 +1,193 @@
+// built into its own executable with IMUNANO33_TRACE defined
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <imunano33/filter.hpp>
+
+#include "testutil.hpp"
+
+using namespace imunano33;
+
+namespace {
+// removes the global sink even if a test fails
+class TraceTest : public ::testing::Test {
+protected:
+  void TearDown() override { Trace::setSink(nullptr); }
+};
+
+TraceRecord makeRecord(const unsigned long long timeNs, const num_t value) {
+  TraceRecord record{};
+  record.timeNs = timeNs;
+  record.event = ACCEL_TRACE;
+  record.values[7] = value;
+  return record;
+}
+
+bool largeAngle(const TraceRecord &record) {
+  return record.event == ACCEL_TRACE && record.values[7] > 0.5;
+}
+} // namespace
+
+TEST_F(TraceTest, NoSink) {
+  Filter filter;
+  filter.update({0, 0, -9.8}, {0.1, 0, 0}, 0.01);
+  EXPECT_EQ(Trace::getSink(), nullptr);
+}
+
+TEST_F(TraceTest, GyroRecord) {
+  TraceRing<8> ring;
+  Trace::setSink(&ring);
+
+  Filter filter;
+  filter.updateGyro({1, 0, 0}, 0.1);
+  filter.updateGyro({0, 0, 0}, 0.1); // skipped, so not traced
+
+  ASSERT_EQ(ring.size(), 1U);
+  const TraceRecord &record = ring.at(0);
+  EXPECT_EQ(record.event, GYRO_TRACE);
+  EXPECT_NEAR(record.values[0], std::cos(0.05), 1e-9);
+  EXPECT_NEAR(record.values[1], std::sin(0.05), 1e-9);
+  EXPECT_NEAR(record.values[4], 1, 1e-9);
+  EXPECT_NEAR(record.values[7], 0.1, 1e-9);
+}
+
+TEST_F(TraceTest, GyroDeltaIntegrators) {
+  const GyroIntegrator integrators[] = {MIDPOINT, RK4, CONING};
+
+  for (const GyroIntegrator integrator : integrators) {
+    TraceRing<8> ring;
+    Trace::setSink(&ring);
+
+    Filter filter;
+    filter.setIntegrator(integrator);
+    const Quaternion before = filter.getRotQ();
+    filter.updateGyro({0, 0, 2}, 0.1);
+
+    // the delta takes the previous orientation to the new one
+    ASSERT_EQ(ring.size(), 1U) << integrator;
+    const TraceRecord &record = ring.at(0);
+    const Quaternion delta{record.values[0],
+                           {record.values[1], record.values[2],
+                            record.values[3]}};
+    const Quaternion after = before * delta;
+    EXPECT_NEAR(after.w(), filter.getRotQ().w(), 1e-9) << integrator;
+    nearCheck(after.vec(), filter.getRotQ().vec(), 1e-9);
+  }
+}
+
+TEST_F(TraceTest, AccelRecord) {
+  TraceRing<8> ring;
+  Trace::setSink(&ring);
+
+  Filter filter{0.5};
+  filter.updateAccel({0, 0, -9.8}); // already aligned
+  filter.updateAccel({0, -9.8, 0}); // 90 degrees off
+  filter.updateAccel({0, 0, 0});    // skipped, so not traced
+
+  ASSERT_EQ(ring.size(), 2U);
+  EXPECT_EQ(ring.at(0).event, ACCEL_TRACE);
+  EXPECT_NEAR(ring.at(0).values[0], 1, 1e-9);
+  EXPECT_NEAR(ring.at(0).values[7], 0, 1e-6);
+
+  EXPECT_EQ(ring.at(1).event, ACCEL_TRACE);
+  EXPECT_NEAR(ring.at(1).values[7], M_PI / 2, 1e-9);
+  EXPECT_NEAR(ring.at(1).values[0], std::cos(M_PI / 8), 1e-9);
+  EXPECT_GE(ring.at(1).timeNs, ring.at(0).timeNs);
+}
+
+TEST(TraceRing, Wrap) {
+  TraceRing<4> ring;
+  EXPECT_EQ(ring.capacity(), 4U);
+
+  for (int i = 0; i < 6; i++) {
+    ring.record(makeRecord(i, i));
+  }
+
+  ASSERT_EQ(ring.size(), 4U);
+  for (unsigned int i = 0; i < 4; i++) {
+    EXPECT_EQ(ring.at(i).timeNs, i + 2);
+  }
+
+  ring.reset();
+  EXPECT_EQ(ring.size(), 0U);
+}
+
+TEST(TraceRing, Trigger) {
+  TraceRing<6> ring;
+  for (int i = 0; i < 10; i++) {
+    ring.record(makeRecord(i, 0));
+  }
+
+  ring.trigger(2);
+  EXPECT_TRUE(ring.triggered());
+  EXPECT_FALSE(ring.stopped());
+  EXPECT_EQ(ring.getTriggerTime(), 9ULL);
+
+  for (int i = 10; i < 20; i++) {
+    ring.record(makeRecord(i, 0));
+  }
+
+  // 4 records before the trigger and 2 after
+  EXPECT_TRUE(ring.stopped());
+  ASSERT_EQ(ring.size(), 6U);
+  EXPECT_EQ(ring.at(0).timeNs, 6ULL);
+  EXPECT_EQ(ring.at(5).timeNs, 11ULL);
+
+  ring.reset();
+  EXPECT_FALSE(ring.triggered());
+  ring.record(makeRecord(30, 0));
+  EXPECT_EQ(ring.size(), 1U);
+}
+
+TEST(TraceRing, TriggerCondition) {
+  TraceRing<6> ring;
+  ring.setTriggerCondition(largeAngle, 3);
+
+  for (int i = 0; i < 20; i++) {
+    ring.record(makeRecord(i, i == 10 ? 1 : 0));
+  }
+
+  // the triggering record is the first of the 3 after the trigger
+  EXPECT_TRUE(ring.stopped());
+  EXPECT_EQ(ring.getTriggerTime(), 10ULL);
+  ASSERT_EQ(ring.size(), 6U);
+  EXPECT_EQ(ring.at(0).timeNs, 7ULL);
+  EXPECT_EQ(ring.at(5).timeNs, 12ULL);
+}
+
+TEST_F(TraceTest, ChromeTrace) {
+  TraceRing<16> ring;
+  Trace::setSink(&ring);
+
+  Filter filter{0.5};
+  filter.update({0, -9.8, 0}, {1, 0, 0}, 0.01);
+  ring.trigger(0);
+  filter.update({0, -9.8, 0}, {1, 0, 0}, 0.01);
+
+  std::ostringstream out;
+  writeChromeTrace(out, ring);
+  const std::string json = out.str();
+
+  EXPECT_EQ(json.front(), '{');
+  EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"qGyroDelta\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"vecRotAxis\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"rotAngle\",\"ph\":\"C\",\"pid\":1,"
+                      "\"ts\":"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"trigger\""), std::string::npos);
+  EXPECT_NE(json.find("\"ts\":0.000,"), std::string::npos);
+  EXPECT_EQ(json.find(":nan"), std::string::npos);
+
+  // 1 metadata event, 3 counters per record, and the trigger
+  std::size_t events = 0;
+  for (std::size_t pos = json.find("\"ph\""); pos != std::string::npos;
+       pos = json.find("\"ph\"", pos + 1)) {
+    ++events;
+  }
+  EXPECT_EQ(events, 1 + 3 * 2 + 1U);
+  EXPECT_EQ(out.precision(), 6);
+}
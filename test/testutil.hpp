@@ -5,19 +5,32 @@
 #include <vector>
 
 #include <gtest/gtest.h>
-#include <imunano33/simplevectors.hpp>
+#include <imunano33/vector.hpp>
 
 #ifndef M_PI
 #define M_PI 3.1415926535897932384626433
 #endif
 
-using namespace svector;
+using imunano33::Vector3D;
+
+// tolerance of a check, which is looser when num_t is float
+inline double numTol(const double forDouble, const double forFloat) {
+#ifdef IMUNANO33_FLOAT
+  static_cast<void>(forDouble);
+  return forFloat;
+#else
+  static_cast<void>(forFloat);
+  return forDouble;
+#endif
+}
 
 inline void nearCheck(Vector3D a, Vector3D b, double tol = 0.0001) {
   static const std::vector<std::string> comps{"x", "y", "z"};
+  const double aComps[] = {x(a), y(a), z(a)};
+  const double bComps[] = {x(b), y(b), z(b)};
 
   for (int i = 0; i < 3; i++) {
-    EXPECT_NEAR(a[i], b[i], tol) << "failed component: " << comps[i];
+    EXPECT_NEAR(aComps[i], bComps[i], tol) << "failed component: " << comps[i];
   }
 }
 